@@ -54,27 +54,319 @@ void* robin_table_put(robin_table_t* rt, const void* key, size_t klen, void* val
 void* robin_table_get(robin_table_t* rt, const void* key, size_t klen);
 void* robin_table_del(robin_table_t* rt, const void* key, size_t klen);
 
+uint64_t robin_table_hash(const robin_table_t* rt, const void* key, size_t klen);
+void* robin_table_put_hashed(robin_table_t* rt, const void* key, size_t klen,
+                             uint64_t hash, void* val);
+void* robin_table_get_hashed(robin_table_t* rt, const void* key, size_t klen,
+                             uint64_t hash);
+void* robin_table_del_hashed(robin_table_t* rt, const void* key, size_t klen,
+                             uint64_t hash);
+
+void robin_table_get_batch(robin_table_t* rt, const void* const* keys, const size_t* klens,
+                           size_t n, void** vals_out);
+
+/*
+ * A key given as a list of fragments, in order, e.g. the fields of a
+ * composite key (see robin_table_get_frags).
+ */
+typedef struct {
+    const void* data;
+    size_t len;
+} robin_table_frag_t;
+
+void* robin_table_get_frags(robin_table_t* rt, const robin_table_frag_t* frags, size_t nfrags);
+void* robin_table_del_frags(robin_table_t* rt, const robin_table_frag_t* frags, size_t nfrags);
+
+size_t robin_table_retain(robin_table_t* rt,
+                          bool (*pred)(const void* key, size_t klen, void* val, void* ctx),
+                          void* ctx);
 bool robin_table_clear(robin_table_t* rt, bool update_buckets);
+
+void robin_table_flood_guard(robin_table_t* rt, size_t max_psl,
+                             uint64_t (*keyed_hash)(const void*, size_t, uint64_t),
+                             void (*on_reseed)(robin_table_t* rt, size_t psl, void* ctx),
+                             void* ctx);
+
+void robin_table_swmr_enable(robin_table_t* rt);
+void* robin_table_get_swmr(const robin_table_t* rt, const void* key, size_t klen);
+void robin_table_swmr_reclaim(robin_table_t* rt);
+
 size_t robin_table_count(const robin_table_t* rt);
 double robin_table_load_factor(const robin_table_t* rt);
 
+/*
+ * Iterators may live on the stack (see robin_table_iter_init); the caller
+ * reads the key, klen and val members of the current entry. The cursor is
+ * private to the library.
+ */
 typedef struct {
     const void* key;
+    size_t klen;
     void* val;
+    struct {
+        const robin_table_t* rt;
+        robin_table_t* mut;         /* Set by robin_table_iter_init_mut */
+        size_t idx;
+        size_t start;
+        bool erased;
+    } priv;
 } robin_table_iter_t;
 
 robin_table_iter_t* robin_table_iter_create(const robin_table_t* rt);
+void robin_table_iter_init(robin_table_iter_t* iter, const robin_table_t* rt);
+void robin_table_iter_init_mut(robin_table_iter_t* iter, robin_table_t* rt);
 bool robin_table_iter_next(robin_table_iter_t* iter);
+void* robin_table_iter_erase(robin_table_iter_t* iter);
 void robin_table_iter_destroy(robin_table_iter_t* iter);
 
+bool robin_table_for_each(const robin_table_t* rt,
+                          bool (*fn)(const void* key, size_t klen, void* val, void* ctx),
+                          void* ctx);
+
+size_t robin_table_scan(const robin_table_t* rt, size_t cursor, size_t count,
+                        void (*fn)(const void* key, size_t klen, void* val, void* ctx),
+                        void* ctx);
+
+size_t robin_table_export(const robin_table_t* rt, const void** keys_out,
+                          size_t* klens_out, void** vals_out, size_t cap);
+bool robin_table_export_sorted(const robin_table_t* rt, const void** keys_out,
+                               size_t* klens_out, void** vals_out, size_t cap,
+                               int (*cmp)(const void* key1, size_t klen1,
+                                          const void* key2, size_t klen2),
+                               size_t* count);
+
+bool robin_table_save(const robin_table_t* rt,
+                      bool (*write_fn)(const void* buf, size_t len, void* ctx),
+                      const void* (*val_fn)(void* val, size_t* len, void* ctx),
+                      void* ctx);
+robin_table_t* robin_table_load(bool (*read_fn)(void* buf, size_t len, void* ctx),
+                                void* (*val_fn)(const void* buf, size_t len, void* ctx),
+                                void (*free_fn)(void* val, void* ctx),
+                                void* ctx,
+                                uint64_t (*hash_func)(const void*, size_t, uint64_t));
+
 uint64_t robin_table_rapidhash(const void* key, size_t klen, uint64_t seed);
 uint64_t robin_table_siphash(const void* key, size_t klen, uint64_t seed);
+uint64_t robin_table_siphash13(const void* key, size_t klen, uint64_t seed);
+uint64_t robin_table_siphash_key128(const void* key, size_t klen, const void* k);
+uint64_t robin_table_siphash13_key128(const void* key, size_t klen, const void* k);
 uint64_t robin_table_xxh64(const void* key, size_t klen, uint64_t seed);
+uint64_t robin_table_xxh3(const void* key, size_t klen, uint64_t seed);
+uint64_t robin_table_hash_u64(const void* key, size_t klen, uint64_t seed);
+uint64_t robin_table_hash_u32(const void* key, size_t klen, uint64_t seed);
+uint64_t robin_table_hash_crc32c(const void* key, size_t klen, uint64_t seed);
+uint64_t robin_table_hash_aes(const void* key, size_t klen, uint64_t seed);
+uint64_t robin_table_hash_auto(const void* key, size_t klen, uint64_t seed);
 
 size_t robin_table_psl_max(const robin_table_t* rt);
 double robin_table_psl_mean(const robin_table_t* rt);
 double robin_table_psl_variance(const robin_table_t* rt);
 
+typedef struct robin_table_snapshot_t robin_table_snapshot_t;
+
+robin_table_snapshot_t* robin_table_snapshot(robin_table_t* rt);
+void robin_table_snapshot_release(robin_table_snapshot_t* snap);
+void* robin_table_snapshot_get(const robin_table_snapshot_t* snap, const void* key,
+                               size_t klen);
+bool robin_table_snapshot_for_each(const robin_table_snapshot_t* snap,
+                                   bool (*fn)(const void* key, size_t klen, void* val,
+                                              void* ctx),
+                                   void* ctx);
+size_t robin_table_snapshot_count(const robin_table_snapshot_t* snap);
+
+typedef struct robin_table_mphf_t robin_table_mphf_t;
+
+robin_table_mphf_t* robin_table_freeze_mphf(const robin_table_t* rt);
+void robin_table_mphf_destroy(robin_table_mphf_t* mp);
+void* robin_table_mphf_get(const robin_table_mphf_t* mp, const void* key, size_t klen);
+size_t robin_table_mphf_count(const robin_table_mphf_t* mp);
+bool robin_table_mphf_save(const robin_table_mphf_t* mp,
+                           bool (*write_fn)(const void* buf, size_t len, void* ctx),
+                           const void* (*val_fn)(void* val, size_t* len, void* ctx),
+                           void* ctx);
+robin_table_mphf_t* robin_table_mphf_load(bool (*read_fn)(void* buf, size_t len, void* ctx),
+                                          void* (*val_fn)(const void* buf, size_t len,
+                                                          void* ctx),
+                                          void (*free_fn)(void* val, void* ctx),
+                                          void* ctx,
+                                          uint64_t (*hash_func)(const void*, size_t,
+                                                                uint64_t));
+
+typedef struct robin_table_image_t robin_table_image_t;
+
+bool robin_table_write_image(const robin_table_t* rt, const char* path,
+                             const void* (*val_fn)(void* val, size_t* len, void* ctx),
+                             void* ctx);
+robin_table_image_t* robin_table_open_mmap(const char* path,
+                                           uint64_t (*hash_func)(const void*, size_t,
+                                                                 uint64_t));
+void robin_table_image_close(robin_table_image_t* img);
+const void* robin_table_image_get(const robin_table_image_t* img, const void* key, size_t klen,
+                                  size_t* vlen);
+bool robin_table_image_for_each(const robin_table_image_t* img,
+                                bool (*fn)(const void* key, size_t klen, const void* val,
+                                           size_t vlen, void* ctx),
+                                void* ctx);
+size_t robin_table_image_count(const robin_table_image_t* img);
+
+typedef struct robin_table_kv_t robin_table_kv_t;
+
+robin_table_kv_t* robin_table_kv_open(const char* dir, size_t segment_size);
+void robin_table_kv_close(robin_table_kv_t* kv);
+bool robin_table_kv_put(robin_table_kv_t* kv, const void* key, size_t klen, const void* val,
+                        size_t vlen);
+bool robin_table_kv_get(robin_table_kv_t* kv, const void* key, size_t klen, void* buf,
+                        size_t cap, size_t* vlen);
+bool robin_table_kv_del(robin_table_kv_t* kv, const void* key, size_t klen);
+size_t robin_table_kv_count(robin_table_kv_t* kv);
+bool robin_table_kv_sync(robin_table_kv_t* kv);
+bool robin_table_kv_compact(robin_table_kv_t* kv);
+
+/*
+ * Built-in hash functions, identified by a value that is the same in every
+ * process (see robin_table_shm_create and robin_table_hash_batch).
+ */
+typedef enum {
+    RT_HASH_RAPIDHASH,
+    RT_HASH_SIPHASH,
+    RT_HASH_XXH64,
+    RT_HASH_U64,
+    RT_HASH_U32,
+    RT_HASH_CRC32C,
+    RT_HASH_AES,
+    RT_HASH_XXH3,
+    RT_HASH_SIPHASH13
+} robin_table_hash_id_t;
+
+uint64_t (*robin_table_hash_func(robin_table_hash_id_t hash_id))(const void*, size_t, uint64_t);
+bool robin_table_hash_batch(robin_table_hash_id_t hash_id, const void* const* keys,
+                            const size_t* klens, size_t n, uint64_t seed, uint64_t* out);
+void robin_table_hash_keys(uint64_t (*hash_func)(const void*, size_t, uint64_t),
+                           const void* const* keys, const size_t* klens, size_t n,
+                           uint64_t seed, uint64_t* out);
+bool robin_table_hash_frags(uint64_t (*hash_func)(const void*, size_t, uint64_t),
+                            const robin_table_frag_t* frags, size_t nfrags, uint64_t seed,
+                            uint64_t* hash);
+
+typedef struct robin_table_shm_t robin_table_shm_t;
+
+robin_table_shm_t* robin_table_shm_create(const char* name, size_t count, size_t data_bytes,
+                                          robin_table_hash_id_t hash_id, uint64_t seed);
+robin_table_shm_t* robin_table_shm_attach(const char* name);
+void robin_table_shm_detach(robin_table_shm_t* sh);
+bool robin_table_shm_unlink(const char* name);
+const void* robin_table_shm_put(robin_table_shm_t* sh, const void* key, size_t klen,
+                                const void* val, size_t vlen);
+const void* robin_table_shm_get(const robin_table_shm_t* sh, const void* key, size_t klen,
+                                size_t* vlen);
+bool robin_table_shm_del(robin_table_shm_t* sh, const void* key, size_t klen);
+size_t robin_table_shm_count(const robin_table_shm_t* sh);
+
+typedef struct robin_table_builder_t robin_table_builder_t;
+
+robin_table_builder_t* robin_table_builder_create(size_t count,
+                                                  uint64_t (*hash_func)(const void*, size_t,
+                                                                        uint64_t),
+                                                  uint64_t seed);
+void robin_table_builder_destroy(robin_table_builder_t* rb);
+void* robin_table_builder_put(robin_table_builder_t* rb, const void* key, size_t klen,
+                              void* val);
+robin_table_t* robin_table_freeze(robin_table_builder_t* rb);
+
+typedef struct robin_table_sharded_t robin_table_sharded_t;
+
+robin_table_sharded_t* robin_table_sharded_create(size_t shard_count, size_t count,
+                                                  uint64_t (*hash_func)(const void*, size_t,
+                                                                        uint64_t),
+                                                  uint64_t seed);
+void robin_table_sharded_destroy(robin_table_sharded_t* st);
+
+void* robin_table_sharded_put(robin_table_sharded_t* st, const void* key, size_t klen,
+                              void* val);
+void* robin_table_sharded_get(robin_table_sharded_t* st, const void* key, size_t klen);
+void* robin_table_sharded_del(robin_table_sharded_t* st, const void* key, size_t klen);
+
+bool robin_table_sharded_put_batch(robin_table_sharded_t* st, const void* const* keys,
+                                   const size_t* klens, void* const* vals, size_t n,
+                                   void** vals_out);
+bool robin_table_sharded_get_batch(robin_table_sharded_t* st, const void* const* keys,
+                                   const size_t* klens, size_t n, void** vals_out);
+bool robin_table_sharded_del_batch(robin_table_sharded_t* st, const void* const* keys,
+                                   const size_t* klens, size_t n, void** vals_out);
+
+size_t robin_table_sharded_count(robin_table_sharded_t* st);
+size_t robin_table_sharded_psl_max(robin_table_sharded_t* st);
+double robin_table_sharded_psl_mean(robin_table_sharded_t* st);
+double robin_table_sharded_psl_variance(robin_table_sharded_t* st);
+
+typedef struct robin_table_fc_t robin_table_fc_t;
+
+robin_table_fc_t* robin_table_fc_create(size_t count,
+                                        uint64_t (*hash_func)(const void*, size_t, uint64_t),
+                                        uint64_t seed);
+void robin_table_fc_destroy(robin_table_fc_t* fc);
+
+void* robin_table_fc_put(robin_table_fc_t* fc, const void* key, size_t klen, void* val);
+void* robin_table_fc_get(robin_table_fc_t* fc, const void* key, size_t klen);
+void* robin_table_fc_del(robin_table_fc_t* fc, const void* key, size_t klen);
+
+size_t robin_table_fc_count(robin_table_fc_t* fc);
+
+typedef struct robin_table_replicated_t robin_table_replicated_t;
+
+robin_table_replicated_t* robin_table_replicated_create(size_t replica_count, size_t count,
+                                                        uint64_t (*hash_func)(const void*,
+                                                                              size_t,
+                                                                              uint64_t),
+                                                        uint64_t seed);
+void robin_table_replicated_destroy(robin_table_replicated_t* rr);
+
+void* robin_table_replicated_put(robin_table_replicated_t* rr, size_t replica_id,
+                                 const void* key, size_t klen, void* val);
+void* robin_table_replicated_get(robin_table_replicated_t* rr, size_t replica_id,
+                                 const void* key, size_t klen);
+void* robin_table_replicated_del(robin_table_replicated_t* rr, size_t replica_id,
+                                 const void* key, size_t klen);
+
+size_t robin_table_replicated_count(robin_table_replicated_t* rr, size_t replica_id);
+
+typedef struct robin_table_pool_t robin_table_pool_t;
+
+robin_table_pool_t* robin_table_pool_create(size_t thread_count);
+void robin_table_pool_destroy(robin_table_pool_t* pool);
+
+void robin_table_get_batch_parallel(robin_table_pool_t* pool, robin_table_t* rt,
+                                    const void* const* keys, const size_t* klens, size_t n,
+                                    void** vals_out);
+bool robin_table_sharded_put_batch_parallel(robin_table_pool_t* pool,
+                                            robin_table_sharded_t* st,
+                                            const void* const* keys, const size_t* klens,
+                                            void* const* vals, size_t n, void** vals_out);
+bool robin_table_export_sorted_parallel(robin_table_pool_t* pool, const robin_table_t* rt,
+                                        const void** keys_out, size_t* klens_out,
+                                        void** vals_out, size_t cap,
+                                        int (*cmp)(const void* key1, size_t klen1,
+                                                   const void* key2, size_t klen2),
+                                        size_t* count);
+
+typedef struct robin_table_concurrent_t robin_table_concurrent_t;
+
+robin_table_concurrent_t* robin_table_concurrent_create(size_t count,
+                                                        uint64_t (*hash_func)(const void*,
+                                                                              size_t,
+                                                                              uint64_t),
+                                                        uint64_t seed);
+void robin_table_concurrent_destroy(robin_table_concurrent_t* ct);
+
+bool robin_table_concurrent_register(robin_table_concurrent_t* ct);
+
+void* robin_table_concurrent_put(robin_table_concurrent_t* ct, const void* key, size_t klen,
+                                 void* val);
+void* robin_table_concurrent_get(robin_table_concurrent_t* ct, const void* key, size_t klen);
+void* robin_table_concurrent_del(robin_table_concurrent_t* ct, const void* key, size_t klen);
+
+size_t robin_table_concurrent_count(robin_table_concurrent_t* ct);
+
 #if defined(__cplusplus)
 }
 #endif /* __cplusplus */
@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Header-only traversal of the hash table: the bucket array is exposed only
+ * so that hot traversal loops can be inlined into the caller. The bucket
+ * layout is NOT part of the stable API and may change between releases;
+ * prefer the functions in robin_table.h.
+ */
+
+#ifndef ROBIN_TABLE_INLINE_H
+#define ROBIN_TABLE_INLINE_H
+
+#include "robin_table.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/* A bucket holds an entry if key is not NULL */
+typedef struct {
+    void* key;
+    void* val;
+    size_t psl;
+    size_t klen;
+    uint64_t hash;
+} robin_table_bucket_t;
+
+const robin_table_bucket_t* robin_table_buckets(const robin_table_t* rt, size_t* bucket_count);
+
+/*
+ * Header-only variant of robin_table_for_each: when fn is known at the call
+ * site, the compiler can inline it into the scan loop.
+ *
+ * => Return false if fn stopped the traversal early; otherwise, true.
+ */
+static inline bool robin_table_for_each_inline(const robin_table_t* rt,
+                                               bool (*fn)(const void*, size_t, void*, void*),
+                                               void* ctx)
+{
+    size_t bucket_count;
+    const robin_table_bucket_t* bucket = robin_table_buckets(rt, &bucket_count);
+    const robin_table_bucket_t* end = bucket + bucket_count;
+
+    for (; bucket != end; ++bucket) {
+        if (bucket->key && !fn(bucket->key, bucket->klen, bucket->val, ctx)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* ROBIN_TABLE_INLINE_H */
@@ -0,0 +1,487 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define RT_HASHBATCH_X86
+#endif
+
+/*
+ * Batch hashing. Runs of keys of the same length are hashed by kernels that
+ * inline the hash function and keep several keys in flight, with the work
+ * that depends only on the seed and the length done once per run. The
+ * 64-bit lane kernels use AVX-512 or AVX2 when the CPU supports them
+ * (selected once, on the first call). Every kernel returns exactly the
+ * values of the corresponding scalar hash function.
+ */
+
+/* Shortest run of equal-length keys worth handing to a kernel */
+#define RT_BATCH_RUN_MIN    4U
+
+#define RT_XXH_PRIME64_1    0x9E3779B185EBCA87ULL
+#define RT_XXH_PRIME64_2    0xC2B2AE3D27D4EB4FULL
+#define RT_XXH_PRIME64_3    0x165667B19E3779F9ULL
+#define RT_XXH_PRIME64_4    0x85EBCA77C2B2AE63ULL
+#define RT_XXH_PRIME64_5    0x27D4EB2F165667C5ULL
+
+#define RT_INTHASH_MUL      0xd6e8feb86659fd93ULL
+
+static const uint64_t robin_rapid_secret[3] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+                                               0x4b33a62ed433d4a3ULL};
+
+typedef size_t (*robin_batch_fn_t)(const void* const* keys, size_t klen, size_t n,
+                                   uint64_t seed, uint64_t* out);
+
+static inline uint64_t robin_batch_read64(const void* p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t robin_batch_read32(const void* p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Word at off of a key, which is a 4-byte key or the 8-byte words of a longer one */
+static inline uint64_t robin_batch_read(const void* key, size_t klen, size_t off)
+{
+    const uint8_t* p = (const uint8_t*)key + off;
+
+    return klen == 4 ? robin_batch_read32(p) : robin_batch_read64(p);
+}
+
+static inline uint64_t robin_batch_rotl(uint64_t x, unsigned r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t robin_batch_mix128(uint64_t a, uint64_t b, uint64_t* hi)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+
+    *hi = (uint64_t)(r >> 64);
+    return (uint64_t)r;
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t lo = t + (rm1 << 32);
+
+    *hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+    return lo;
+#endif
+}
+
+static inline uint64_t robin_batch_rapid_mix(uint64_t a, uint64_t b)
+{
+    uint64_t hi;
+    uint64_t lo = robin_batch_mix128(a, b, &hi);
+
+    return lo ^ hi;
+}
+
+/*
+ * rapidhash of keys of 4 to 16 bytes. The seed mix depends only on the seed
+ * and the length, so a run pays for two 128-bit multiplies per key instead
+ * of three.
+ */
+static size_t robin_batch_rapidhash(const void* const* keys, size_t klen, size_t n,
+                                    uint64_t seed, uint64_t* out)
+{
+    const uint64_t* secret = robin_rapid_secret;
+    const size_t delta = (klen & 24) >> (klen >> 3);
+
+    seed ^= robin_batch_rapid_mix(seed ^ secret[0], secret[1]) ^ klen;
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t* p = keys[i];
+        const uint8_t* plast = p + klen - 4;
+        uint64_t a = (robin_batch_read32(p) << 32) | robin_batch_read32(plast);
+        uint64_t b = (robin_batch_read32(p + delta) << 32) | robin_batch_read32(plast - delta);
+        uint64_t hi;
+        uint64_t lo = robin_batch_mix128(a ^ secret[1], b ^ seed, &hi);
+
+        out[i] = robin_batch_rapid_mix(lo ^ secret[0] ^ klen, hi ^ secret[1]);
+    }
+    return n;
+}
+
+static inline uint64_t robin_batch_xxh64_round(uint64_t acc, uint64_t input)
+{
+    acc += input * RT_XXH_PRIME64_2;
+    acc = robin_batch_rotl(acc, 31);
+    return acc * RT_XXH_PRIME64_1;
+}
+
+/* xxh64 of keys of 8 or 16 bytes */
+static size_t robin_batch_xxh64_sw(const void* const* keys, size_t klen, size_t n,
+                                   uint64_t seed, uint64_t* out)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t* p = keys[i];
+        uint64_t h = seed + RT_XXH_PRIME64_5 + klen;
+
+        for (size_t off = 0; off < klen; off += 8) {
+            h ^= robin_batch_xxh64_round(0, robin_batch_read64(p + off));
+            h = robin_batch_rotl(h, 27) * RT_XXH_PRIME64_1 + RT_XXH_PRIME64_4;
+        }
+        h ^= h >> 33;
+        h *= RT_XXH_PRIME64_2;
+        h ^= h >> 29;
+        h *= RT_XXH_PRIME64_3;
+        out[i] = h ^ (h >> 32);
+    }
+    return n;
+}
+
+static inline uint64_t robin_batch_inthash(uint64_t x)
+{
+    x ^= x >> 32;
+    x *= RT_INTHASH_MUL;
+    x ^= x >> 32;
+    x *= RT_INTHASH_MUL;
+    return x ^ (x >> 32);
+}
+
+/* robin_table_hash_u64 and robin_table_hash_u32 of keys of their width */
+static size_t robin_batch_int_sw(const void* const* keys, size_t klen, size_t n,
+                                 uint64_t seed, uint64_t* out)
+{
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t k = robin_batch_read(keys[i], klen, 0);
+
+        out[i] = robin_batch_inthash(k ^ seed);
+    }
+    return n;
+}
+
+#ifdef RT_HASHBATCH_X86
+
+/*
+ * AVX2 has no 64-bit multiply, so its lanes multiply by a constant with
+ * three 32x32->64 multiplies. This pays off for the integer hash functions
+ * but not for xxh64, whose six dependent multiplies per key run as fast in
+ * scalar code; xxh64 needs the native 64-bit multiply of AVX-512.
+ */
+__attribute__((target("avx2"))) static inline __m256i robin_batch_mul64_avx2(__m256i a,
+                                                                             uint64_t b)
+{
+    const __m256i lo = _mm256_set1_epi64x((long long)(b & 0xFFFFFFFFU));
+    const __m256i hi = _mm256_set1_epi64x((long long)(b >> 32));
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), lo),
+                                     _mm256_mul_epu32(a, hi));
+
+    return _mm256_add_epi64(_mm256_mul_epu32(a, lo), _mm256_slli_epi64(cross, 32));
+}
+
+__attribute__((target("avx2"))) static inline __m256i robin_batch_xorshift_avx2(__m256i x,
+                                                                                int r)
+{
+    return _mm256_xor_si256(x, _mm256_srli_epi64(x, r));
+}
+
+__attribute__((target("avx2"))) static size_t robin_batch_int_avx2(const void* const* keys,
+                                                                   size_t klen, size_t n,
+                                                                   uint64_t seed, uint64_t* out)
+{
+    const __m256i vseed = _mm256_set1_epi64x((long long)seed);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_set_epi64x((long long)robin_batch_read(keys[i + 3], klen, 0),
+                                      (long long)robin_batch_read(keys[i + 2], klen, 0),
+                                      (long long)robin_batch_read(keys[i + 1], klen, 0),
+                                      (long long)robin_batch_read(keys[i], klen, 0));
+
+        x = _mm256_xor_si256(x, vseed);
+        x = robin_batch_xorshift_avx2(x, 32);
+        x = robin_batch_xorshift_avx2(robin_batch_mul64_avx2(x, RT_INTHASH_MUL), 32);
+        x = robin_batch_xorshift_avx2(robin_batch_mul64_avx2(x, RT_INTHASH_MUL), 32);
+        _mm256_storeu_si256((__m256i*)(out + i), x);
+    }
+    return i + robin_batch_int_sw(keys + i, klen, n - i, seed, out + i);
+}
+
+#define RT_AVX512 "avx512f,avx512dq"
+
+__attribute__((target(RT_AVX512))) static inline __m512i robin_batch_load8_avx512(
+    const void* const* keys, size_t klen, size_t off)
+{
+    return _mm512_set_epi64((long long)robin_batch_read(keys[7], klen, off),
+                            (long long)robin_batch_read(keys[6], klen, off),
+                            (long long)robin_batch_read(keys[5], klen, off),
+                            (long long)robin_batch_read(keys[4], klen, off),
+                            (long long)robin_batch_read(keys[3], klen, off),
+                            (long long)robin_batch_read(keys[2], klen, off),
+                            (long long)robin_batch_read(keys[1], klen, off),
+                            (long long)robin_batch_read(keys[0], klen, off));
+}
+
+__attribute__((target(RT_AVX512))) static inline __m512i robin_batch_xorshift_avx512(__m512i x,
+                                                                                     int r)
+{
+    return _mm512_xor_si512(x, _mm512_srli_epi64(x, (unsigned)r));
+}
+
+__attribute__((target(RT_AVX512))) static size_t robin_batch_xxh64_avx512(
+    const void* const* keys, size_t klen, size_t n, uint64_t seed, uint64_t* out)
+{
+    const __m512i prime1 = _mm512_set1_epi64((long long)RT_XXH_PRIME64_1);
+    const __m512i prime2 = _mm512_set1_epi64((long long)RT_XXH_PRIME64_2);
+    const __m512i prime3 = _mm512_set1_epi64((long long)RT_XXH_PRIME64_3);
+    const __m512i prime4 = _mm512_set1_epi64((long long)RT_XXH_PRIME64_4);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m512i h = _mm512_set1_epi64((long long)(seed + RT_XXH_PRIME64_5 + klen));
+
+        for (size_t off = 0; off < klen; off += 8) {
+            __m512i k = _mm512_mullo_epi64(robin_batch_load8_avx512(keys + i, klen, off), prime2);
+
+            k = _mm512_mullo_epi64(_mm512_rol_epi64(k, 31), prime1);
+            h = _mm512_rol_epi64(_mm512_xor_si512(h, k), 27);
+            h = _mm512_add_epi64(_mm512_mullo_epi64(h, prime1), prime4);
+        }
+        h = _mm512_mullo_epi64(robin_batch_xorshift_avx512(h, 33), prime2);
+        h = _mm512_mullo_epi64(robin_batch_xorshift_avx512(h, 29), prime3);
+        _mm512_storeu_si512(out + i, robin_batch_xorshift_avx512(h, 32));
+    }
+    return i + robin_batch_xxh64_sw(keys + i, klen, n - i, seed, out + i);
+}
+
+__attribute__((target(RT_AVX512))) static size_t robin_batch_int_avx512(const void* const* keys,
+                                                                        size_t klen, size_t n,
+                                                                        uint64_t seed,
+                                                                        uint64_t* out)
+{
+    const __m512i vseed = _mm512_set1_epi64((long long)seed);
+    const __m512i mul = _mm512_set1_epi64((long long)RT_INTHASH_MUL);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m512i x = _mm512_xor_si512(robin_batch_load8_avx512(keys + i, klen, 0), vseed);
+
+        x = robin_batch_xorshift_avx512(x, 32);
+        x = robin_batch_xorshift_avx512(_mm512_mullo_epi64(x, mul), 32);
+        x = robin_batch_xorshift_avx512(_mm512_mullo_epi64(x, mul), 32);
+        _mm512_storeu_si512(out + i, x);
+    }
+    return i + robin_batch_int_sw(keys + i, klen, n - i, seed, out + i);
+}
+
+static robin_batch_fn_t robin_resolve_batch_xxh64(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+        return robin_batch_xxh64_avx512;
+    }
+    return robin_batch_xxh64_sw;
+}
+
+static robin_batch_fn_t robin_resolve_batch_int(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+        return robin_batch_int_avx512;
+    }
+    return __builtin_cpu_supports("avx2") ? robin_batch_int_avx2 : robin_batch_int_sw;
+}
+
+/*
+ * Define the batch kernel name, which calls the kernel returned by resolve.
+ * The first call resolves it; racing calls store the same kernel.
+ */
+#define RT_BATCH_DISPATCH(name, resolve)                                                \
+    static size_t name##_first(const void* const* keys, size_t klen, size_t n,          \
+                               uint64_t seed, uint64_t* out);                           \
+    static robin_batch_fn_t name##_impl = name##_first;                                 \
+                                                                                        \
+    static size_t name##_first(const void* const* keys, size_t klen, size_t n,          \
+                               uint64_t seed, uint64_t* out)                            \
+    {                                                                                   \
+        robin_batch_fn_t fn = resolve();                                                \
+                                                                                        \
+        __atomic_store_n(&name##_impl, fn, __ATOMIC_RELAXED);                           \
+        return fn(keys, klen, n, seed, out);                                            \
+    }                                                                                   \
+                                                                                        \
+    static size_t name(const void* const* keys, size_t klen, size_t n, uint64_t seed,   \
+                       uint64_t* out)                                                   \
+    {                                                                                   \
+        return __atomic_load_n(&name##_impl, __ATOMIC_RELAXED)(keys, klen, n, seed, out); \
+    }
+
+RT_BATCH_DISPATCH(robin_batch_xxh64, robin_resolve_batch_xxh64)
+RT_BATCH_DISPATCH(robin_batch_int, robin_resolve_batch_int)
+
+#else
+
+#define robin_batch_xxh64 robin_batch_xxh64_sw
+#define robin_batch_int   robin_batch_int_sw
+
+#endif /* RT_HASHBATCH_X86 */
+
+/*
+ * Return the kernel hashing keys of length klen with the given hash
+ * function, or NULL if there is none.
+ */
+static robin_batch_fn_t robin_batch_kernel(robin_table_hash_id_t hash_id, size_t klen)
+{
+    switch (hash_id) {
+    case RT_HASH_RAPIDHASH:
+        return klen >= 4 && klen <= 16 ? robin_batch_rapidhash : NULL;
+    case RT_HASH_XXH64:
+        return klen == 8 || klen == 16 ? robin_batch_xxh64 : NULL;
+    case RT_HASH_U64:
+        return klen == 8 ? robin_batch_int : NULL;
+    case RT_HASH_U32:
+        return klen == 4 ? robin_batch_int : NULL;
+    default:
+        return NULL;
+    }
+}
+
+/*
+ * Return the hash function identified by hash_id, or NULL if there is none.
+ */
+uint64_t (*robin_table_hash_func(robin_table_hash_id_t hash_id))(const void*, size_t, uint64_t)
+{
+    switch (hash_id) {
+    case RT_HASH_RAPIDHASH:
+        return robin_table_rapidhash;
+    case RT_HASH_SIPHASH:
+        return robin_table_siphash;
+    case RT_HASH_XXH64:
+        return robin_table_xxh64;
+    case RT_HASH_U64:
+        return robin_table_hash_u64;
+    case RT_HASH_U32:
+        return robin_table_hash_u32;
+    case RT_HASH_CRC32C:
+        return robin_table_hash_crc32c;
+    case RT_HASH_AES:
+        return robin_table_hash_aes;
+    case RT_HASH_XXH3:
+        return robin_table_xxh3;
+    case RT_HASH_SIPHASH13:
+        return robin_table_siphash13;
+    default:
+        return NULL;
+    }
+}
+
+/*
+ * Hash n keys with hash_func, the built-in hash function identified by
+ * hash_id if there is one.
+ */
+static void robin_batch_hash(robin_table_hash_id_t hash_id, bool builtin,
+                             uint64_t (*hash_func)(const void*, size_t, uint64_t),
+                             const void* const* keys, const size_t* klens, size_t n,
+                             uint64_t seed, uint64_t* out)
+{
+    size_t i = 0;
+
+    while (i < n) {
+        robin_batch_fn_t kernel = NULL;
+        size_t end = i + 1;
+
+        while (end < n && klens[end] == klens[i]) {
+            ++end;
+        }
+
+        if (builtin && end - i >= RT_BATCH_RUN_MIN) {
+            kernel = robin_batch_kernel(hash_id, klens[i]);
+        }
+        if (kernel) {
+            kernel(keys + i, klens[i], end - i, seed, out + i);
+        } else {
+            for (size_t k = i; k < end; ++k) {
+                out[k] = hash_func(keys[k], klens[k], seed);
+            }
+        }
+        i = end;
+    }
+}
+
+/*
+ * Hash n keys with the hash function identified by hash_id into out; the
+ * values are those of the hash function itself.
+ *
+ * => Runs of at least RT_BATCH_RUN_MIN keys of the same length are hashed
+ *    by a batch kernel when there is one for the function and the length:
+ *    rapidhash of 4 to 16 bytes, xxh64 of 8 or 16 bytes and the integer
+ *    hash functions of their width. Other keys are hashed one at a time.
+ * => Returns false if hash_id is not a built-in hash function.
+ */
+bool robin_table_hash_batch(robin_table_hash_id_t hash_id, const void* const* keys,
+                            const size_t* klens, size_t n, uint64_t seed, uint64_t* out)
+{
+    uint64_t (*hash_func)(const void*, size_t, uint64_t);
+
+    RT_ASSERT(keys != NULL && klens != NULL && out != NULL);
+
+    hash_func = robin_table_hash_func(hash_id);
+    if (!hash_func) {
+        return false;
+    }
+    robin_batch_hash(hash_id, true, hash_func, keys, klens, n, seed, out);
+    return true;
+}
+
+/*
+ * Hash n keys with any hash function into out, as robin_table_hash_batch
+ * does when hash_func is a built-in hash function.
+ */
+void robin_table_hash_keys(uint64_t (*hash_func)(const void*, size_t, uint64_t),
+                           const void* const* keys, const size_t* klens, size_t n,
+                           uint64_t seed, uint64_t* out)
+{
+    uint64_t (*builtin)(const void*, size_t, uint64_t);
+    int hash_id = RT_HASH_RAPIDHASH;
+
+    RT_ASSERT(hash_func != NULL);
+    RT_ASSERT(keys != NULL && klens != NULL && out != NULL);
+
+    while ((builtin = robin_table_hash_func((robin_table_hash_id_t)hash_id)) &&
+           builtin != hash_func) {
+        ++hash_id;
+    }
+    robin_batch_hash((robin_table_hash_id_t)hash_id, builtin != NULL, hash_func, keys, klens, n,
+                     seed, out);
+}
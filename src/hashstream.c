@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+#include "hashstream.h"
+
+typedef uint64_t (*robin_frags_fn_t)(const robin_table_frag_t*, size_t, size_t, uint64_t);
+
+static const struct {
+    uint64_t (*hash_func)(const void*, size_t, uint64_t);
+    robin_frags_fn_t frags_func;
+} robin_frags_funcs[] = {
+    {robin_table_rapidhash, robin_rapidhash_frags},
+    {robin_table_siphash, robin_siphash_frags},
+    {robin_table_siphash13, robin_siphash13_frags},
+    {robin_table_xxh64, robin_xxh64_frags},
+    {robin_table_xxh3, robin_xxh3_frags},
+    /* Keys longer than their integer width are hashed with rapidhash */
+    {robin_table_hash_u64, robin_rapidhash_frags},
+    {robin_table_hash_u32, robin_rapidhash_frags},
+    {robin_table_hash_crc32c, robin_hash_crc32c_frags},
+    {robin_table_hash_aes, robin_hash_aes_frags},
+    {robin_table_hash_auto, robin_hash_auto_frags},
+};
+
+/*
+ * Hash a key given as fragments into *hash, with the value hash_func
+ * returns for the concatenation of the fragments.
+ *
+ * => A key in one fragment is hashed in place, and a key of at most
+ *    RT_FRAGS_GATHER_MAX bytes is gathered on the stack.
+ * => Longer keys are streamed through the built-in hash functions, which
+ *    read whole blocks from the fragments in place and gather only the few
+ *    bytes their block reads take across fragment boundaries.
+ * => Longer keys of other hash functions are gathered into an allocated
+ *    buffer; return false if the allocation fails.
+ */
+bool robin_table_hash_frags(uint64_t (*hash_func)(const void*, size_t, uint64_t),
+                            const robin_table_frag_t* frags, size_t nfrags, uint64_t seed,
+                            uint64_t* hash)
+{
+    uint8_t buf[RT_FRAGS_GATHER_MAX];
+    uint8_t* key;
+    size_t len;
+
+    RT_ASSERT(hash_func != NULL);
+    RT_ASSERT(frags != NULL || nfrags == 0);
+    RT_ASSERT(hash != NULL);
+
+    len = robin_frags_len(frags, nfrags);
+    if (nfrags <= 1 || len == 0) {
+        *hash = hash_func(len ? frags[0].data : "", len, seed);
+        return true;
+    }
+    if (len <= sizeof(buf)) {
+        robin_frags_gather(frags, nfrags, buf);
+        *hash = hash_func(buf, len, seed);
+        return true;
+    }
+
+    for (size_t i = 0; i < sizeof(robin_frags_funcs) / sizeof(robin_frags_funcs[0]); ++i) {
+        if (robin_frags_funcs[i].hash_func == hash_func) {
+            *hash = robin_frags_funcs[i].frags_func(frags, nfrags, len, seed);
+            return true;
+        }
+    }
+
+    if (!(key = malloc(len))) {
+        return false;
+    }
+    robin_frags_gather(frags, nfrags, key);
+    *hash = hash_func(key, len, seed);
+    free(key);
+    return true;
+}
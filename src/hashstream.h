@@ -0,0 +1,182 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Streaming hash functions over keys made of fragments (robin_table_frag_t).
+ * Every one returns the value its hash function returns for the
+ * concatenation of the fragments, and is only called for keys longer than
+ * RT_FRAGS_GATHER_MAX. Internal to the library.
+ */
+
+#ifndef ROBIN_HASHSTREAM_H
+#define ROBIN_HASHSTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/*
+ * Keys in several fragments up to this length are gathered on the stack and
+ * hashed in one call: the copy costs less than streaming them block by
+ * block, which only pays off for longer keys.
+ */
+#define RT_FRAGS_GATHER_MAX    2048U
+
+static inline size_t robin_frags_len(const robin_table_frag_t* frags, size_t nfrags)
+{
+    size_t len = 0;
+
+    for (size_t i = 0; i < nfrags; ++i) {
+        len += frags[i].len;
+    }
+    return len;
+}
+
+/* Copy the fragments of a key, in order, into buf */
+static inline void robin_frags_gather(const robin_table_frag_t* frags, size_t nfrags,
+                                      uint8_t* buf)
+{
+    for (size_t i = 0; i < nfrags; buf += frags[i++].len) {
+        if (frags[i].len) {
+            memcpy(buf, frags[i].data, frags[i].len);
+        }
+    }
+}
+
+/*
+ * Cursor over the fragments of a key, handing out fixed-size blocks.
+ */
+typedef struct {
+    const robin_table_frag_t* frag;
+    const robin_table_frag_t* end;
+    size_t off;                         /* Offset in the current fragment */
+} robin_frag_cursor_t;
+
+static inline void robin_frag_init(robin_frag_cursor_t* cur, const robin_table_frag_t* frags,
+                                   size_t nfrags)
+{
+    cur->frag = frags;
+    cur->end = frags + nfrags;
+    cur->off = 0;
+}
+
+/*
+ * Return the next blocks of size bytes, at most *n of them and at least one.
+ *
+ * => Whole blocks inside the current fragment are returned in place, and *n
+ *    is set to their number; a block spanning fragments is copied into buf
+ *    (size bytes) and *n is set to 1.
+ * => The caller never asks for more bytes than the fragments have left.
+ */
+static inline const uint8_t* robin_frag_next(robin_frag_cursor_t* cur, size_t size, size_t* n,
+                                             uint8_t* buf)
+{
+    size_t copied = 0;
+
+    while (cur->off == cur->frag->len) {
+        ++cur->frag;
+        cur->off = 0;
+    }
+
+    if (cur->frag->len - cur->off >= size) {
+        const uint8_t* p = (const uint8_t*)cur->frag->data + cur->off;
+        size_t avail = (cur->frag->len - cur->off) / size;
+
+        *n = avail < *n ? avail : *n;
+        cur->off += *n * size;
+        return p;
+    }
+
+    while (copied < size) {
+        size_t len = cur->frag->len - cur->off;
+
+        if (len > size - copied) {
+            len = size - copied;
+        }
+        if (len) {
+            memcpy(buf + copied, (const uint8_t*)cur->frag->data + cur->off, len);
+        }
+        copied += len;
+        cur->off += len;
+        if (cur->off == cur->frag->len && cur->frag + 1 < cur->end) {
+            ++cur->frag;
+            cur->off = 0;
+        }
+    }
+    *n = 1;
+    return buf;
+}
+
+/*
+ * Return the last tail bytes of a key, in place if they lie in
+ * one fragment and otherwise copied into buf (tail bytes).
+ */
+static inline const uint8_t* robin_frag_tail(const robin_table_frag_t* frags, size_t nfrags,
+                                             size_t tail, uint8_t* buf)
+{
+    size_t left = tail;
+
+    while (nfrags && !frags[nfrags - 1].len) {
+        --nfrags;
+    }
+    if (!tail) {
+        return buf;
+    }
+    if (frags[nfrags - 1].len >= tail) {
+        return (const uint8_t*)frags[nfrags - 1].data + frags[nfrags - 1].len - tail;
+    }
+
+    while (left) {
+        const robin_table_frag_t* frag = &frags[--nfrags];
+        size_t n = frag->len < left ? frag->len : left;
+
+        if (n) {
+            left -= n;
+            memcpy(buf + left, (const uint8_t*)frag->data + frag->len - n, n);
+        }
+    }
+    return buf;
+}
+
+RT_INTERNAL uint64_t robin_rapidhash_frags(const robin_table_frag_t* frags, size_t nfrags,
+                                           size_t len, uint64_t seed);
+RT_INTERNAL uint64_t robin_siphash_frags(const robin_table_frag_t* frags, size_t nfrags,
+                                         size_t len, uint64_t seed);
+RT_INTERNAL uint64_t robin_siphash13_frags(const robin_table_frag_t* frags, size_t nfrags,
+                                           size_t len, uint64_t seed);
+RT_INTERNAL uint64_t robin_xxh64_frags(const robin_table_frag_t* frags, size_t nfrags,
+                                       size_t len, uint64_t seed);
+RT_INTERNAL uint64_t robin_xxh3_frags(const robin_table_frag_t* frags, size_t nfrags,
+                                      size_t len, uint64_t seed);
+RT_INTERNAL uint64_t robin_hash_crc32c_frags(const robin_table_frag_t* frags, size_t nfrags,
+                                             size_t len, uint64_t seed);
+RT_INTERNAL uint64_t robin_hash_aes_frags(const robin_table_frag_t* frags, size_t nfrags,
+                                          size_t len, uint64_t seed);
+RT_INTERNAL uint64_t robin_hash_auto_frags(const robin_table_frag_t* frags, size_t nfrags,
+                                           size_t len, uint64_t seed);
+
+#endif /* ROBIN_HASHSTREAM_H */
@@ -0,0 +1,582 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hashstream.h"
+#include "robin_table_internal.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define RT_HWHASH_X86
+#endif
+
+uint64_t robin_table_rapidhash(const void* key, size_t klen, uint64_t seed);
+
+typedef uint64_t (*robin_hash_fn_t)(const void*, size_t, uint64_t);
+typedef uint64_t (*robin_frags_fn_t)(const robin_table_frag_t*, size_t, size_t, uint64_t);
+
+/*
+ * Hash functions built on CRC32C and AES round instructions. Each one has a
+ * portable implementation returning the same values, and the best one for
+ * the CPU is selected once, on the first call (on x86-64).
+ * robin_table_hash_auto picks the fastest function the CPU
+ * accelerates, so its values depend on the CPU.
+ */
+
+/* Round keys and initial state of the AES hash (digits of pi) */
+static const uint64_t robin_aes_k0[2] = {0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL};
+static const uint64_t robin_aes_k1[2] = {0xa4093822299f31d0ULL, 0x082efa98ec4e6c89ULL};
+static const uint64_t robin_aes_k2[2] = {0x452821e638d01377ULL, 0xbe5466cf34e90c6cULL};
+static const uint64_t robin_aes_k3[2] = {0xc0ac29b7c97c50ddULL, 0x3f84d5b5b5470917ULL};
+
+static const uint8_t robin_aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
+    0xfe, 0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+    0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0, 0xb7, 0xfd, 0x93, 0x26,
+    0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2,
+    0xeb, 0x27, 0xb2, 0x75, 0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+    0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84, 0x53, 0xd1, 0x00, 0xed,
+    0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f,
+    0x50, 0x3c, 0x9f, 0xa8, 0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+    0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2, 0xcd, 0x0c, 0x13, 0xec,
+    0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14,
+    0xde, 0x5e, 0x0b, 0xdb, 0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+    0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79, 0xe7, 0xc8, 0x37, 0x6d,
+    0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f,
+    0x4b, 0xbd, 0x8b, 0x8a, 0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+    0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e, 0xe1, 0xf8, 0x98, 0x11,
+    0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f,
+    0xb0, 0x54, 0xbb, 0x16
+};
+
+/* CRC32C (Castagnoli) table, reflected polynomial 0x82f63b78 */
+static const uint32_t robin_crc32c_table[256] = {
+    0x00000000U, 0xf26b8303U, 0xe13b70f7U, 0x1350f3f4U, 0xc79a971fU, 0x35f1141cU,
+    0x26a1e7e8U, 0xd4ca64ebU, 0x8ad958cfU, 0x78b2dbccU, 0x6be22838U, 0x9989ab3bU,
+    0x4d43cfd0U, 0xbf284cd3U, 0xac78bf27U, 0x5e133c24U, 0x105ec76fU, 0xe235446cU,
+    0xf165b798U, 0x030e349bU, 0xd7c45070U, 0x25afd373U, 0x36ff2087U, 0xc494a384U,
+    0x9a879fa0U, 0x68ec1ca3U, 0x7bbcef57U, 0x89d76c54U, 0x5d1d08bfU, 0xaf768bbcU,
+    0xbc267848U, 0x4e4dfb4bU, 0x20bd8edeU, 0xd2d60dddU, 0xc186fe29U, 0x33ed7d2aU,
+    0xe72719c1U, 0x154c9ac2U, 0x061c6936U, 0xf477ea35U, 0xaa64d611U, 0x580f5512U,
+    0x4b5fa6e6U, 0xb93425e5U, 0x6dfe410eU, 0x9f95c20dU, 0x8cc531f9U, 0x7eaeb2faU,
+    0x30e349b1U, 0xc288cab2U, 0xd1d83946U, 0x23b3ba45U, 0xf779deaeU, 0x05125dadU,
+    0x1642ae59U, 0xe4292d5aU, 0xba3a117eU, 0x4851927dU, 0x5b016189U, 0xa96ae28aU,
+    0x7da08661U, 0x8fcb0562U, 0x9c9bf696U, 0x6ef07595U, 0x417b1dbcU, 0xb3109ebfU,
+    0xa0406d4bU, 0x522bee48U, 0x86e18aa3U, 0x748a09a0U, 0x67dafa54U, 0x95b17957U,
+    0xcba24573U, 0x39c9c670U, 0x2a993584U, 0xd8f2b687U, 0x0c38d26cU, 0xfe53516fU,
+    0xed03a29bU, 0x1f682198U, 0x5125dad3U, 0xa34e59d0U, 0xb01eaa24U, 0x42752927U,
+    0x96bf4dccU, 0x64d4cecfU, 0x77843d3bU, 0x85efbe38U, 0xdbfc821cU, 0x2997011fU,
+    0x3ac7f2ebU, 0xc8ac71e8U, 0x1c661503U, 0xee0d9600U, 0xfd5d65f4U, 0x0f36e6f7U,
+    0x61c69362U, 0x93ad1061U, 0x80fde395U, 0x72966096U, 0xa65c047dU, 0x5437877eU,
+    0x4767748aU, 0xb50cf789U, 0xeb1fcbadU, 0x197448aeU, 0x0a24bb5aU, 0xf84f3859U,
+    0x2c855cb2U, 0xdeeedfb1U, 0xcdbe2c45U, 0x3fd5af46U, 0x7198540dU, 0x83f3d70eU,
+    0x90a324faU, 0x62c8a7f9U, 0xb602c312U, 0x44694011U, 0x5739b3e5U, 0xa55230e6U,
+    0xfb410cc2U, 0x092a8fc1U, 0x1a7a7c35U, 0xe811ff36U, 0x3cdb9bddU, 0xceb018deU,
+    0xdde0eb2aU, 0x2f8b6829U, 0x82f63b78U, 0x709db87bU, 0x63cd4b8fU, 0x91a6c88cU,
+    0x456cac67U, 0xb7072f64U, 0xa457dc90U, 0x563c5f93U, 0x082f63b7U, 0xfa44e0b4U,
+    0xe9141340U, 0x1b7f9043U, 0xcfb5f4a8U, 0x3dde77abU, 0x2e8e845fU, 0xdce5075cU,
+    0x92a8fc17U, 0x60c37f14U, 0x73938ce0U, 0x81f80fe3U, 0x55326b08U, 0xa759e80bU,
+    0xb4091bffU, 0x466298fcU, 0x1871a4d8U, 0xea1a27dbU, 0xf94ad42fU, 0x0b21572cU,
+    0xdfeb33c7U, 0x2d80b0c4U, 0x3ed04330U, 0xccbbc033U, 0xa24bb5a6U, 0x502036a5U,
+    0x4370c551U, 0xb11b4652U, 0x65d122b9U, 0x97baa1baU, 0x84ea524eU, 0x7681d14dU,
+    0x2892ed69U, 0xdaf96e6aU, 0xc9a99d9eU, 0x3bc21e9dU, 0xef087a76U, 0x1d63f975U,
+    0x0e330a81U, 0xfc588982U, 0xb21572c9U, 0x407ef1caU, 0x532e023eU, 0xa145813dU,
+    0x758fe5d6U, 0x87e466d5U, 0x94b49521U, 0x66df1622U, 0x38cc2a06U, 0xcaa7a905U,
+    0xd9f75af1U, 0x2b9cd9f2U, 0xff56bd19U, 0x0d3d3e1aU, 0x1e6dcdeeU, 0xec064eedU,
+    0xc38d26c4U, 0x31e6a5c7U, 0x22b65633U, 0xd0ddd530U, 0x0417b1dbU, 0xf67c32d8U,
+    0xe52cc12cU, 0x1747422fU, 0x49547e0bU, 0xbb3ffd08U, 0xa86f0efcU, 0x5a048dffU,
+    0x8ecee914U, 0x7ca56a17U, 0x6ff599e3U, 0x9d9e1ae0U, 0xd3d3e1abU, 0x21b862a8U,
+    0x32e8915cU, 0xc083125fU, 0x144976b4U, 0xe622f5b7U, 0xf5720643U, 0x07198540U,
+    0x590ab964U, 0xab613a67U, 0xb831c993U, 0x4a5a4a90U, 0x9e902e7bU, 0x6cfbad78U,
+    0x7fab5e8cU, 0x8dc0dd8fU, 0xe330a81aU, 0x115b2b19U, 0x020bd8edU, 0xf0605beeU,
+    0x24aa3f05U, 0xd6c1bc06U, 0xc5914ff2U, 0x37faccf1U, 0x69e9f0d5U, 0x9b8273d6U,
+    0x88d28022U, 0x7ab90321U, 0xae7367caU, 0x5c18e4c9U, 0x4f48173dU, 0xbd23943eU,
+    0xf36e6f75U, 0x0105ec76U, 0x12551f82U, 0xe03e9c81U, 0x34f4f86aU, 0xc69f7b69U,
+    0xd5cf889dU, 0x27a40b9eU, 0x79b737baU, 0x8bdcb4b9U, 0x988c474dU, 0x6ae7c44eU,
+    0xbe2da0a5U, 0x4c4623a6U, 0x5f16d052U, 0xad7d5351U
+};
+
+static inline uint64_t robin_hw_read64(const uint8_t* p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t robin_hw_rotl(uint64_t x, unsigned r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t robin_hw_fmix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline uint8_t robin_aes_xtime(uint8_t x)
+{
+    return (uint8_t)((x << 1) ^ ((x >> 7) * 0x1b));
+}
+
+/*
+ * One AES encryption round (SubBytes, ShiftRows, MixColumns, AddRoundKey)
+ * on a state held as two 64-bit halves, as _mm_aesenc_si128 computes it.
+ */
+static void robin_aesenc_sw(uint64_t s[2], const uint64_t k[2])
+{
+    uint8_t in[16], t[16], out[16];
+
+    memcpy(in, s, sizeof(in));
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            t[r + 4 * c] = robin_aes_sbox[in[r + 4 * ((c + r) % 4)]];
+        }
+    }
+    for (int c = 0; c < 4; ++c) {
+        const uint8_t a0 = t[4 * c], a1 = t[4 * c + 1], a2 = t[4 * c + 2], a3 = t[4 * c + 3];
+        const uint8_t x = a0 ^ a1 ^ a2 ^ a3;
+
+        out[4 * c] = a0 ^ x ^ robin_aes_xtime(a0 ^ a1);
+        out[4 * c + 1] = a1 ^ x ^ robin_aes_xtime(a1 ^ a2);
+        out[4 * c + 2] = a2 ^ x ^ robin_aes_xtime(a2 ^ a3);
+        out[4 * c + 3] = a3 ^ x ^ robin_aes_xtime(a3 ^ a0);
+    }
+    memcpy(s, out, sizeof(out));
+    s[0] ^= k[0];
+    s[1] ^= k[1];
+}
+
+static inline uint32_t robin_hw_read32(const uint8_t* p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*
+ * AES hash over a 128-bit state type T with the given operations: every
+ * 16-byte block is XORed into the state, followed by one AES round. Keys
+ * up to 16 bytes are one block, read with overlapping loads; longer keys
+ * run two independent lanes over 32-byte chunks, with the last chunk
+ * overlapping the previous one, and the second lane is then used as the
+ * round key of the first. Two final rounds give every output bit a
+ * dependency on every input bit.
+ */
+#define RT_AES_HASH(name, T, load2, loadu, xor, enc, fold)                              \
+    static uint64_t name(const void* key, size_t klen, uint64_t seed)                  \
+    {                                                                                   \
+        const uint8_t* p = key;                                                         \
+        const T k1 = load2(robin_aes_k1[0], robin_aes_k1[1]);                           \
+        const T k2 = load2(robin_aes_k2[0], robin_aes_k2[1]);                           \
+        const T k3 = load2(robin_aes_k3[0], robin_aes_k3[1]);                           \
+        T s = load2(robin_aes_k0[0] ^ seed,                                             \
+                    robin_aes_k0[1] ^ robin_hw_rotl(seed, 32) ^ klen);                  \
+                                                                                        \
+        if (klen <= 16) {                                                               \
+            uint64_t lo = 0, hi = 0;                                                    \
+                                                                                        \
+            if (klen >= 8) {                                                            \
+                lo = robin_hw_read64(p);                                                \
+                hi = robin_hw_read64(p + klen - 8);                                     \
+            } else if (klen >= 4) {                                                     \
+                lo = robin_hw_read32(p) | ((uint64_t)robin_hw_read32(p + klen - 4) << 32); \
+            } else if (klen) {                                                          \
+                lo = p[0] | ((uint64_t)p[klen / 2] << 8) | ((uint64_t)p[klen - 1] << 16); \
+            }                                                                           \
+            s = enc(xor(s, load2(lo, hi)), k1);                                         \
+        } else {                                                                        \
+            T t = xor(s, k2);                                                           \
+            size_t i = 0;                                                               \
+                                                                                        \
+            for (; klen - i > 32; i += 32) {                                            \
+                s = enc(xor(s, loadu(p + i)), k1);                                      \
+                t = enc(xor(t, loadu(p + i + 16)), k1);                                 \
+            }                                                                           \
+            s = enc(xor(s, loadu(klen - i > 16 ? p + i : p + klen - 32)), k1);          \
+            t = enc(xor(t, loadu(p + klen - 16)), k1);                                  \
+            s = enc(s, t);                                                              \
+        }                                                                               \
+                                                                                        \
+        s = enc(s, k2);                                                                 \
+        s = enc(s, k3);                                                                 \
+        return fold(s);                                                                 \
+    }
+
+/*
+ * The AES hash over fragments of a key longer than 32 bytes: the 32-byte
+ * chunks are read in place and the last 32 bytes, which the final loads
+ * overlap, are gathered if they span fragments.
+ */
+#define RT_AES_FRAGS(name, T, load2, loadu, xor, enc, fold)                             \
+    static uint64_t name(const robin_table_frag_t* frags, size_t nfrags, size_t klen,   \
+                         uint64_t seed)                                                 \
+    {                                                                                   \
+        uint8_t buf[32];                                                                \
+        robin_frag_cursor_t cur;                                                        \
+        size_t nchunks = (klen - 1) / 32;                                               \
+        const uint8_t* p;                                                               \
+        const T k1 = load2(robin_aes_k1[0], robin_aes_k1[1]);                           \
+        const T k2 = load2(robin_aes_k2[0], robin_aes_k2[1]);                           \
+        const T k3 = load2(robin_aes_k3[0], robin_aes_k3[1]);                           \
+        T s = load2(robin_aes_k0[0] ^ seed,                                             \
+                    robin_aes_k0[1] ^ robin_hw_rotl(seed, 32) ^ klen);                  \
+        T t = xor(s, k2);                                                               \
+        const size_t rest = klen - 32 * nchunks;                                        \
+                                                                                        \
+        robin_frag_init(&cur, frags, nfrags);                                           \
+        while (nchunks) {                                                               \
+            size_t n = nchunks;                                                         \
+                                                                                        \
+            p = robin_frag_next(&cur, 32, &n, buf);                                     \
+            for (nchunks -= n; n; --n, p += 32) {                                       \
+                s = enc(xor(s, loadu(p)), k1);                                          \
+                t = enc(xor(t, loadu(p + 16)), k1);                                     \
+            }                                                                           \
+        }                                                                               \
+        p = robin_frag_tail(frags, nfrags, 32, buf);                                    \
+        s = enc(xor(s, loadu(rest > 16 ? p + 32 - rest : p)), k1);                      \
+        t = enc(xor(t, loadu(p + 16)), k1);                                             \
+        s = enc(s, t);                                                                  \
+        s = enc(s, k2);                                                                 \
+        s = enc(s, k3);                                                                 \
+        return fold(s);                                                                 \
+    }
+
+typedef struct {
+    uint64_t v[2];
+} robin_aes_block_t;
+
+static inline robin_aes_block_t robin_aes_load2_sw(uint64_t lo, uint64_t hi)
+{
+    robin_aes_block_t b = {{lo, hi}};
+
+    return b;
+}
+
+static inline robin_aes_block_t robin_aes_loadu_sw(const uint8_t* p)
+{
+    return robin_aes_load2_sw(robin_hw_read64(p), robin_hw_read64(p + 8));
+}
+
+static inline robin_aes_block_t robin_aes_xor_sw(robin_aes_block_t a, robin_aes_block_t b)
+{
+    a.v[0] ^= b.v[0];
+    a.v[1] ^= b.v[1];
+    return a;
+}
+
+static inline robin_aes_block_t robin_aes_enc_sw(robin_aes_block_t s, robin_aes_block_t k)
+{
+    robin_aesenc_sw(s.v, k.v);
+    return s;
+}
+
+static inline uint64_t robin_aes_fold_sw(robin_aes_block_t s)
+{
+    return s.v[0] ^ s.v[1];
+}
+
+RT_AES_HASH(robin_hash_aes_sw, robin_aes_block_t, robin_aes_load2_sw, robin_aes_loadu_sw,
+            robin_aes_xor_sw, robin_aes_enc_sw, robin_aes_fold_sw)
+RT_AES_FRAGS(robin_aes_frags_sw, robin_aes_block_t, robin_aes_load2_sw, robin_aes_loadu_sw,
+             robin_aes_xor_sw, robin_aes_enc_sw, robin_aes_fold_sw)
+
+static inline uint32_t robin_crc32c_u64_sw(uint32_t crc, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) {
+        crc = robin_crc32c_table[(crc ^ (uint8_t)v) & 0xff] ^ (crc >> 8);
+        v >>= 8;
+    }
+    return crc;
+}
+
+/*
+ * CRC32C hash: two 32-bit CRC lanes over the 8-byte words, the second one
+ * fed with the word plus the first lane so that the lanes are not linear
+ * in each other, then a 64-bit finalizer.
+ */
+#define RT_CRC32C_HASH(name, crc_u64)                                                   \
+    static uint64_t name(const void* key, size_t klen, uint64_t seed)                  \
+    {                                                                                   \
+        const uint8_t* p = key;                                                         \
+        const size_t len = klen;                                                        \
+        uint32_t a = (uint32_t)seed;                                                    \
+        uint32_t b = (uint32_t)(seed >> 32) ^ (uint32_t)klen;                          \
+        uint64_t w;                                                                     \
+                                                                                        \
+        for (; klen >= 8; klen -= 8, p += 8) {                                          \
+            w = robin_hw_read64(p);                                                     \
+            a = crc_u64(a, w);                                                          \
+            b = crc_u64(b, robin_hw_rotl(w, 32) + a);                                   \
+        }                                                                               \
+        if (klen) {                                                                     \
+            w = 0;                                                                      \
+            memcpy(&w, p, klen);                                                        \
+            a = crc_u64(a, w);                                                          \
+            b = crc_u64(b, robin_hw_rotl(w, 32) + a);                                   \
+        }                                                                               \
+        return robin_hw_fmix((((uint64_t)b << 32) | a) ^ ((uint64_t)len << 56));        \
+    }
+
+/* The CRC32C hash over fragments, reading the 8-byte words in place */
+#define RT_CRC32C_FRAGS(name, crc_u64)                                                  \
+    static uint64_t name(const robin_table_frag_t* frags, size_t nfrags, size_t klen,   \
+                         uint64_t seed)                                                 \
+    {                                                                                   \
+        uint8_t buf[8];                                                                 \
+        robin_frag_cursor_t cur;                                                        \
+        size_t nwords = klen / 8;                                                       \
+        uint32_t a = (uint32_t)seed;                                                    \
+        uint32_t b = (uint32_t)(seed >> 32) ^ (uint32_t)klen;                          \
+        uint64_t w;                                                                     \
+                                                                                        \
+        robin_frag_init(&cur, frags, nfrags);                                           \
+        while (nwords) {                                                                \
+            size_t n = nwords;                                                          \
+            const uint8_t* p = robin_frag_next(&cur, 8, &n, buf);                       \
+                                                                                        \
+            for (nwords -= n; n; --n, p += 8) {                                         \
+                w = robin_hw_read64(p);                                                 \
+                a = crc_u64(a, w);                                                      \
+                b = crc_u64(b, robin_hw_rotl(w, 32) + a);                               \
+            }                                                                           \
+        }                                                                               \
+        if (klen % 8) {                                                                 \
+            w = 0;                                                                      \
+            memcpy(&w, robin_frag_tail(frags, nfrags, klen % 8, buf), klen % 8);        \
+            a = crc_u64(a, w);                                                          \
+            b = crc_u64(b, robin_hw_rotl(w, 32) + a);                                   \
+        }                                                                               \
+        return robin_hw_fmix((((uint64_t)b << 32) | a) ^ ((uint64_t)klen << 56));       \
+    }
+
+RT_CRC32C_HASH(robin_hash_crc32c_sw, robin_crc32c_u64_sw)
+RT_CRC32C_FRAGS(robin_crc32c_frags_sw, robin_crc32c_u64_sw)
+
+/*
+ * The portable implementations, whatever the dispatch picks, so that the
+ * tests can check that the accelerated ones return the same values.
+ */
+uint64_t robin_hash_crc32c_portable(const void* key, size_t klen, uint64_t seed)
+{
+    return robin_hash_crc32c_sw(key, klen, seed);
+}
+
+uint64_t robin_hash_aes_portable(const void* key, size_t klen, uint64_t seed)
+{
+    return robin_hash_aes_sw(key, klen, seed);
+}
+
+#ifdef RT_HWHASH_X86
+
+__attribute__((target("sse4.2"))) static inline uint32_t robin_crc32c_u64_hw(uint32_t crc,
+                                                                             uint64_t v)
+{
+    return (uint32_t)_mm_crc32_u64(crc, v);
+}
+
+__attribute__((target("sse4.2"))) RT_CRC32C_HASH(robin_hash_crc32c_hw, robin_crc32c_u64_hw)
+__attribute__((target("sse4.2"))) RT_CRC32C_FRAGS(robin_crc32c_frags_hw, robin_crc32c_u64_hw)
+
+__attribute__((target("aes,sse2"))) static inline __m128i robin_aes_load2_hw(uint64_t lo,
+                                                                             uint64_t hi)
+{
+    return _mm_set_epi64x((long long)hi, (long long)lo);
+}
+
+__attribute__((target("aes,sse2"))) static inline __m128i robin_aes_loadu_hw(const uint8_t* p)
+{
+    return _mm_loadu_si128((const __m128i*)p);
+}
+
+__attribute__((target("aes,sse2"))) static inline uint64_t robin_aes_fold_hw(__m128i s)
+{
+    uint64_t out[2];
+
+    _mm_storeu_si128((__m128i*)out, s);
+    return out[0] ^ out[1];
+}
+
+__attribute__((target("aes,sse2")))
+RT_AES_HASH(robin_hash_aes_hw, __m128i, robin_aes_load2_hw, robin_aes_loadu_hw, _mm_xor_si128,
+            _mm_aesenc_si128, robin_aes_fold_hw)
+__attribute__((target("aes,sse2")))
+RT_AES_FRAGS(robin_aes_frags_hw, __m128i, robin_aes_load2_hw, robin_aes_loadu_hw,
+             _mm_xor_si128, _mm_aesenc_si128, robin_aes_fold_hw)
+
+static robin_hash_fn_t robin_resolve_crc32c(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2") ? robin_hash_crc32c_hw : robin_hash_crc32c_sw;
+}
+
+static robin_hash_fn_t robin_resolve_aes(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("aes") ? robin_hash_aes_hw : robin_hash_aes_sw;
+}
+
+static robin_hash_fn_t robin_resolve_auto(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("aes")) {
+        return robin_hash_aes_hw;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return robin_hash_crc32c_hw;
+    }
+    return robin_table_rapidhash;
+}
+
+/*
+ * Define the hash function name, which calls the implementation returned by
+ * resolve. The first call resolves it; calls racing with it resolve it too,
+ * which is harmless as they all store the same function.
+ */
+#define RT_HWHASH_DISPATCH(name, resolve)                                               \
+    static uint64_t name##_first(const void* key, size_t klen, uint64_t seed);          \
+    static robin_hash_fn_t name##_impl = name##_first;                                  \
+                                                                                        \
+    static uint64_t name##_first(const void* key, size_t klen, uint64_t seed)           \
+    {                                                                                   \
+        robin_hash_fn_t fn = resolve();                                                 \
+                                                                                        \
+        __atomic_store_n(&name##_impl, fn, __ATOMIC_RELAXED);                           \
+        return fn(key, klen, seed);                                                     \
+    }                                                                                   \
+                                                                                        \
+    uint64_t name(const void* key, size_t klen, uint64_t seed)                          \
+    {                                                                                   \
+        return __atomic_load_n(&name##_impl, __ATOMIC_RELAXED)(key, klen, seed);       \
+    }
+
+RT_HWHASH_DISPATCH(robin_table_hash_crc32c, robin_resolve_crc32c)
+RT_HWHASH_DISPATCH(robin_table_hash_aes, robin_resolve_aes)
+RT_HWHASH_DISPATCH(robin_table_hash_auto, robin_resolve_auto)
+
+/*
+ * The fragment variants follow the choice of the resolvers above, so that
+ * they always return the same values as the hash functions.
+ */
+static robin_frags_fn_t robin_resolve_crc32c_frags(void)
+{
+    return robin_resolve_crc32c() == robin_hash_crc32c_hw ? robin_crc32c_frags_hw
+                                                          : robin_crc32c_frags_sw;
+}
+
+static robin_frags_fn_t robin_resolve_aes_frags(void)
+{
+    return robin_resolve_aes() == robin_hash_aes_hw ? robin_aes_frags_hw : robin_aes_frags_sw;
+}
+
+static robin_frags_fn_t robin_resolve_auto_frags(void)
+{
+    robin_hash_fn_t fn = robin_resolve_auto();
+
+    if (fn == robin_hash_aes_hw) {
+        return robin_aes_frags_hw;
+    }
+    if (fn == robin_hash_crc32c_hw) {
+        return robin_crc32c_frags_hw;
+    }
+    return robin_rapidhash_frags;
+}
+
+#define RT_HWHASH_FRAGS_DISPATCH(name, resolve)                                         \
+    static uint64_t name##_first(const robin_table_frag_t* frags, size_t nfrags,        \
+                                 size_t len, uint64_t seed);                            \
+    static robin_frags_fn_t name##_impl = name##_first;                                 \
+                                                                                        \
+    static uint64_t name##_first(const robin_table_frag_t* frags, size_t nfrags,        \
+                                 size_t len, uint64_t seed)                             \
+    {                                                                                   \
+        robin_frags_fn_t fn = resolve();                                                \
+                                                                                        \
+        __atomic_store_n(&name##_impl, fn, __ATOMIC_RELAXED);                           \
+        return fn(frags, nfrags, len, seed);                                            \
+    }                                                                                   \
+                                                                                        \
+    uint64_t name(const robin_table_frag_t* frags, size_t nfrags, size_t len,           \
+                  uint64_t seed)                                                        \
+    {                                                                                   \
+        return __atomic_load_n(&name##_impl, __ATOMIC_RELAXED)(frags, nfrags, len, seed); \
+    }
+
+RT_HWHASH_FRAGS_DISPATCH(robin_hash_crc32c_frags, robin_resolve_crc32c_frags)
+RT_HWHASH_FRAGS_DISPATCH(robin_hash_aes_frags, robin_resolve_aes_frags)
+RT_HWHASH_FRAGS_DISPATCH(robin_hash_auto_frags, robin_resolve_auto_frags)
+
+#else
+
+uint64_t robin_table_hash_crc32c(const void* key, size_t klen, uint64_t seed)
+{
+    return robin_hash_crc32c_sw(key, klen, seed);
+}
+
+uint64_t robin_table_hash_aes(const void* key, size_t klen, uint64_t seed)
+{
+    return robin_hash_aes_sw(key, klen, seed);
+}
+
+/* Without accelerated instructions, rapidhash is the fastest choice */
+uint64_t robin_table_hash_auto(const void* key, size_t klen, uint64_t seed)
+{
+    return robin_table_rapidhash(key, klen, seed);
+}
+
+uint64_t robin_hash_crc32c_frags(const robin_table_frag_t* frags, size_t nfrags, size_t len,
+                                 uint64_t seed)
+{
+    return robin_crc32c_frags_sw(frags, nfrags, len, seed);
+}
+
+uint64_t robin_hash_aes_frags(const robin_table_frag_t* frags, size_t nfrags, size_t len,
+                              uint64_t seed)
+{
+    return robin_aes_frags_sw(frags, nfrags, len, seed);
+}
+
+uint64_t robin_hash_auto_frags(const robin_table_frag_t* frags, size_t nfrags, size_t len,
+                               uint64_t seed)
+{
+    return robin_rapidhash_frags(frags, nfrags, len, seed);
+}
+
+#endif /* RT_HWHASH_X86 */
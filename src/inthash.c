@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+uint64_t robin_table_rapidhash(const void* key, size_t klen, uint64_t seed);
+
+/*
+ * Multiply-xorshift finalizer. Every step is invertible, so distinct keys
+ * of the same width never collide on the full 64-bit hash value.
+ */
+static inline uint64_t robin_inthash_mix(uint64_t x)
+{
+    x ^= x >> 32;
+    x *= 0xd6e8feb86659fd93ULL;
+    x ^= x >> 32;
+    x *= 0xd6e8feb86659fd93ULL;
+    x ^= x >> 32;
+    return x;
+}
+
+/*
+ * Hash function for 8-byte integer keys in native byte order. Other key
+ * lengths are hashed with rapidhash.
+ */
+uint64_t robin_table_hash_u64(const void* key, size_t klen, uint64_t seed)
+{
+    uint64_t k;
+
+    if (klen != sizeof(k)) {
+        return robin_table_rapidhash(key, klen, seed);
+    }
+    memcpy(&k, key, sizeof(k));
+    return robin_inthash_mix(k ^ seed);
+}
+
+/*
+ * Hash function for 4-byte integer keys in native byte order. Other key
+ * lengths are hashed with rapidhash.
+ */
+uint64_t robin_table_hash_u32(const void* key, size_t klen, uint64_t seed)
+{
+    uint32_t k;
+
+    if (klen != sizeof(k)) {
+        return robin_table_rapidhash(key, klen, seed);
+    }
+    memcpy(&k, key, sizeof(k));
+    return robin_inthash_mix((uint64_t)k ^ seed);
+}
@@ -34,6 +34,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "hashstream.h"
+
 #define _likely_(x) __builtin_expect(!!(x), 1)
 #define _unlikely_(x) __builtin_expect(!!(x), 0)
 
@@ -160,3 +162,52 @@ uint64_t robin_table_rapidhash(const void* key, size_t klen, uint64_t seed)
 {
     return rapidhash((const uint8_t*)key, klen, seed);
 }
+
+/*
+ * rapidhash over fragments of a key longer than 48 bytes: the 48-byte
+ * rounds read whole blocks from the fragments and only the last bytes
+ * (which the final reads overlap) are gathered when they span fragments.
+ */
+uint64_t robin_rapidhash_frags(const robin_table_frag_t* frags, size_t nfrags, size_t len,
+                               uint64_t seed)
+{
+    const uint64_t* secret = rapid_secret;
+    uint8_t buf[64];
+    robin_frag_cursor_t cur;
+    const uint8_t* p;
+    size_t nblocks = len / 48;
+    size_t i = len - 48 * nblocks;
+    uint64_t see1, see2, a, b;
+
+    seed ^= rapid_mix(seed ^ secret[0], secret[1]) ^ len;
+    see1 = see2 = seed;
+
+    robin_frag_init(&cur, frags, nfrags);
+    while (nblocks) {
+        size_t n = nblocks;
+
+        p = robin_frag_next(&cur, 48, &n, buf);
+        for (nblocks -= n; n; --n, p += 48) {
+            seed = rapid_mix(rapid_read64(p) ^ secret[0], rapid_read64(p + 8) ^ seed);
+            see1 = rapid_mix(rapid_read64(p + 16) ^ secret[1], rapid_read64(p + 24) ^ see1);
+            see2 = rapid_mix(rapid_read64(p + 32) ^ secret[2], rapid_read64(p + 40) ^ see2);
+        }
+    }
+    seed ^= see1 ^ see2;
+
+    /* The remaining i bytes, after the 16 bytes that the final reads may overlap */
+    p = robin_frag_tail(frags, nfrags, i + 16, buf) + 16;
+    if (i > 16) {
+        seed = rapid_mix(rapid_read64(p) ^ secret[2], rapid_read64(p + 8) ^ seed ^ secret[1]);
+        if (i > 32) {
+            seed = rapid_mix(rapid_read64(p + 16) ^ secret[2], rapid_read64(p + 24) ^ seed);
+        }
+    }
+    a = rapid_read64(p + i - 16);
+    b = rapid_read64(p + i - 8);
+
+    a ^= secret[1];
+    b ^= seed;
+    uint128_result mul_result = rapid_mul128(a, b);
+    return rapid_mix(mul_result.low ^ secret[0] ^ len, mul_result.high ^ secret[1]);
+}
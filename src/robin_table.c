@@ -27,50 +27,77 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <limits.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#if defined(__linux__) && defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))
+#include <sys/random.h>
+#define RT_HAVE_GETRANDOM
+#endif
 
 #include "robin_table.h"
+#include "robin_table_internal.h"
+#include "hashstream.h"
 
-#ifndef RT_NO_ASSERT
-#include <assert.h>
-#define RT_ASSERT(expr)           assert(expr)
-#else
-#define RT_ASSERT(expr)
-#endif /* RT_NO_ASSERT */
+/* Number of buckets scanned per block by robin_table_export */
+#define RT_EXPORT_BLOCK           32U
 
-#define RT_HASH_FUNC_DEFAULT      robin_table_rapidhash
+/* Number of keys ahead to prefetch in batch operations */
+#define RT_PREFETCH_DISTANCE      8U
 
-/* Bucket count MUST be a power of two */
-#define RT_BUCKET_COUNT_MIN       32U
+/* Number of keys hashed at a time by robin_table_get_batch */
+#define RT_HASH_BATCH             64U
 
-/* Maximum and minimum load factor thresholds */
-#define RT_LOAD_FACTOR_PCT_MAX    75U
-#define RT_LOAD_FACTOR_PCT_MIN    25U
+/* Number of buckets per copy-on-write page of a snapshot */
+#define RT_SNAPSHOT_PAGE          64U
+
+/*
+ * Default flood guard PSL: RT_FLOOD_PSL_LOG2 times the log2 of the bucket
+ * count, but at least RT_FLOOD_PSL_MIN. Random keys stay well below it
+ * (the maximum PSL of 4M random keys is around 12).
+ */
+#define RT_FLOOD_PSL_LOG2         4U
+#define RT_FLOOD_PSL_MIN          32U
 
 typedef struct {
-    void* key;
-    void* val;
-    size_t psl;
-    size_t klen;
-    uint64_t hash;
-} robin_bucket_t;
+    size_t refs;                /* Number of snapshots sharing the page */
+    robin_bucket_t buckets[];
+} robin_snapshot_page_t;
 
-struct robin_table_t {
+/*
+ * Bucket array shared by the live hash table and its snapshots. Its lock
+ * serializes the snapshot bookkeeping of the hash table, which may outlive
+ * the hash table itself.
+ */
+typedef struct robin_snapshot_base_t {
     robin_bucket_t* buckets;
+    pthread_mutex_t lock;
+    size_t refs;                /* Number of snapshots sharing the array */
+    bool detached;              /* Owned by the snapshots, no longer live */
+} robin_snapshot_base_t;
+
+struct robin_table_snapshot_t {
+    struct robin_table_snapshot_t* next;
+    robin_table_t* rt;          /* NULL once the bucket array is detached */
+    robin_snapshot_base_t* base;
+    robin_snapshot_page_t** pages;
     size_t count;
     size_t bucket_count;
-    size_t init_buckets;
     size_t mask;
-    size_t expand_at;
-    size_t shrink_at;
+    size_t page_count;
     uint64_t seed;
     uint64_t (*hash_func)(const void*, size_t, uint64_t);
+    size_t key_width;
+    bool detached;
+    bool invalid;               /* A page copy could not be allocated */
 };
 
-typedef struct {
-    robin_table_iter_t iter;
-    const robin_table_t* rt;
-    size_t idx;
-} robin_table_iter_impl_t;
+static void robin_table_cow_page(robin_table_t* rt, size_t page);
+static bool robin_table_snapshot_detach(robin_table_t* rt);
+static void robin_table_flood_update(robin_table_t* rt);
 
 /*
  * Round n to the next highest power of two.
@@ -108,6 +135,45 @@ static inline size_t robin_table_calc_bucket_count(size_t count)
     return bucket_count;
 }
 
+/*
+ * Deduce a fixed key width from the integer hash functions.
+ */
+static inline size_t robin_table_key_width(uint64_t (*hash_func)(const void*, size_t, uint64_t))
+{
+    if (hash_func == robin_table_hash_u64) {
+        return sizeof(uint64_t);
+    }
+    if (hash_func == robin_table_hash_u32) {
+        return sizeof(uint32_t);
+    }
+    return 0;
+}
+
+/*
+ * Compare two keys of length klen, with a single integer compare when
+ * klen is the fixed key width of the hash table.
+ */
+static inline bool robin_table_key_eq(size_t key_width, const void* key1, const void* key2,
+                                      size_t klen)
+{
+    if (klen == key_width) {
+        if (key_width == sizeof(uint64_t)) {
+            uint64_t a, b;
+
+            memcpy(&a, key1, sizeof(a));
+            memcpy(&b, key2, sizeof(b));
+            return a == b;
+        } else {
+            uint32_t a, b;
+
+            memcpy(&a, key1, sizeof(a));
+            memcpy(&b, key2, sizeof(b));
+            return a == b;
+        }
+    }
+    return memcmp(key1, key2, klen) == 0;
+}
+
 /*
  * Construct a new hash table with the given number of entries and hash function.
  */
@@ -133,16 +199,102 @@ robin_table_t* robin_table_create(size_t count,
     rt->expand_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100;
     rt->shrink_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MIN) / 100;
     rt->hash_func = hash_func ? hash_func : RT_HASH_FUNC_DEFAULT;
+    rt->key_width = robin_table_key_width(rt->hash_func);
     rt->seed = seed;
+    rt->seq = 0;
+    rt->swmr = false;
+    rt->retired = NULL;
+    rt->snapshots = NULL;
+    rt->cow_base = NULL;
+    rt->cow_bits = NULL;
+    rt->key_arena = NULL;
+    rt->flood_limit = SIZE_MAX;
+    rt->flood_psl = SIZE_MAX;
+    rt->flood_hit = 0;
+    rt->flood_backoff = 0;
+    rt->flood_hash = NULL;
+    rt->flood_cb = NULL;
+    rt->flood_ctx = NULL;
     return rt;
 }
 
+/*
+ * Open a write section: in SWMR mode, readers that overlap with it retry.
+ *
+ * => Once the last snapshot is released, the writes stop checking for pages
+ *    to copy.
+ */
+static inline void robin_table_write_begin(robin_table_t* rt)
+{
+    if (rt->cow_base && !__atomic_load_n(&rt->cow_base->refs, __ATOMIC_ACQUIRE)) {
+        (void)robin_table_snapshot_detach(rt);
+    }
+    if (rt->swmr) {
+        __atomic_store_n(&rt->seq, rt->seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+}
+
+/*
+ * Close a write section opened by robin_table_write_begin.
+ */
+static inline void robin_table_write_end(robin_table_t* rt)
+{
+    if (rt->swmr) {
+        __atomic_store_n(&rt->seq, rt->seq + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/*
+ * Store an entry into a bucket. In SWMR mode, and while snapshots share the
+ * bucket array, readers load the fields of a bucket while it is written, so
+ * every field is stored atomically.
+ */
+static inline void robin_table_store(const robin_table_t* rt, robin_bucket_t* bucket,
+                                     const robin_bucket_t* entry)
+{
+    if (rt->swmr || rt->cow_bits) {
+        __atomic_store_n(&bucket->key, entry->key, __ATOMIC_RELAXED);
+        __atomic_store_n(&bucket->val, entry->val, __ATOMIC_RELAXED);
+        __atomic_store_n(&bucket->psl, entry->psl, __ATOMIC_RELAXED);
+        __atomic_store_n(&bucket->klen, entry->klen, __ATOMIC_RELAXED);
+        __atomic_store_n(&bucket->hash, entry->hash, __ATOMIC_RELAXED);
+    } else {
+        *bucket = *entry;
+    }
+}
+
+/*
+ * Empty a bucket (see robin_table_store).
+ */
+static inline void robin_table_store_empty(const robin_table_t* rt, robin_bucket_t* bucket)
+{
+    static const robin_bucket_t empty;
+
+    robin_table_store(rt, bucket, &empty);
+}
+
+/*
+ * Copy the page holding the given bucket into the snapshots that still share
+ * it, before the bucket is modified for the first time since they were taken.
+ */
+static inline void robin_table_cow(robin_table_t* rt, size_t idx)
+{
+    if (rt->cow_bits) {
+        const size_t page = idx / RT_SNAPSHOT_PAGE;
+
+        if (!(rt->cow_bits[page / 64] & ((uint64_t)1 << (page % 64)))) {
+            robin_table_cow_page(rt, page);
+        }
+    }
+}
+
 /*
  * Internal function to add an entry without resizing the hash table.
  */
-static void* robin_table_put0(robin_table_t* rt, const void* key, size_t klen, void* val)
+static void* robin_table_put0(robin_table_t* rt, const void* key, size_t klen,
+                              uint64_t hash, void* val)
 {
-    const uint64_t hash = rt->hash_func(key, klen, rt->seed);
     size_t idx = hash & rt->mask;
     robin_bucket_t entry;
 
@@ -158,14 +310,18 @@ static void* robin_table_put0(robin_table_t* rt, const void* key, size_t klen, v
 
         /* Empty bucket: insert the entry */
         if (!bucket->key) {
-            *bucket = entry;
+            robin_table_cow(rt, idx);
+            robin_table_store(rt, bucket, &entry);
             ++rt->count;
+            if (entry.psl > rt->flood_psl && entry.psl > rt->flood_hit) {
+                rt->flood_hit = entry.psl;
+            }
             return val;
         }
 
         /* Duplicate key: do not overwrite existing value */
         if (bucket->hash == hash && bucket->klen == klen &&
-            memcmp(bucket->key, key, klen) == 0) {
+            robin_table_key_eq(rt->key_width, bucket->key, key, klen)) {
             return bucket->val;
         }
 
@@ -175,8 +331,12 @@ static void* robin_table_put0(robin_table_t* rt, const void* key, size_t klen, v
          */
         if (bucket->psl < entry.psl) {
             robin_bucket_t temp;
+            robin_table_cow(rt, idx);
             temp = *bucket;
-            *bucket = entry;
+            robin_table_store(rt, bucket, &entry);
+            if (entry.psl > rt->flood_psl && entry.psl > rt->flood_hit) {
+                rt->flood_hit = entry.psl;
+            }
             entry = temp;
         }
 
@@ -187,39 +347,213 @@ static void* robin_table_put0(robin_table_t* rt, const void* key, size_t klen, v
 }
 
 /*
- * Expand or shrink the hash table and rehash all existing entries.
+ * Expand or shrink the hash table and reinsert all existing entries into a
+ * new bucket array of bucket_count buckets.
+ *
+ * => The entries keep their stored hash values, unless rehash is set: then
+ *    the hash of every entry is recomputed with the current hash function
+ *    and seed.
+ * => In SWMR mode the old bucket array may still be read by concurrent
+ *    readers, so it is retired instead of freed.
  */
-static bool robin_table_resize(robin_table_t* rt, size_t bucket_count)
+static bool robin_table_resize(robin_table_t* rt, size_t bucket_count, bool rehash)
 {
     const size_t old_bucket_count = rt->bucket_count;
     robin_bucket_t* old_buckets = rt->buckets;
     robin_bucket_t* new_buckets;
+    robin_retired_t* retired = NULL;
+    bool detached;
 
     RT_ASSERT((bucket_count & (bucket_count - 1)) == 0);
     RT_ASSERT(bucket_count > rt->count);
+    RT_ASSERT(!rt->swmr || bucket_count > rt->bucket_count);
+    RT_ASSERT(!rt->swmr || !rehash);
+
+    if (rt->swmr) {
+        retired = malloc(sizeof(*retired));
+        if (!retired) {
+            return false;
+        }
+    }
 
     new_buckets = calloc(bucket_count, sizeof(robin_bucket_t));
     if (!new_buckets) {
+        free(retired);
         return false;
     }
-    rt->buckets = new_buckets;
+
+    /* Snapshots keep the old bucket array, which is no longer modified */
+    detached = robin_table_snapshot_detach(rt);
+
+    /*
+     * Publish the (larger) bucket array before the mask so that a reader
+     * never combines a mask with a bucket array that is too small for it.
+     */
+    __atomic_store_n(&rt->buckets, new_buckets, __ATOMIC_RELEASE);
     rt->count = 0;
     rt->bucket_count = bucket_count;
-    rt->mask = rt->bucket_count - 1;
+    __atomic_store_n(&rt->mask, rt->bucket_count - 1, __ATOMIC_RELEASE);
     rt->expand_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100;
     rt->shrink_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MIN) / 100;
+    robin_table_flood_update(rt);
 
     for (size_t i = 0; i < old_bucket_count; ++i) {
         const robin_bucket_t* bucket = old_buckets + i;
 
         if (bucket->key) {
-            robin_table_put0(rt, bucket->key, bucket->klen, bucket->val);
+            const uint64_t hash = rehash ?
+                                  rt->hash_func(bucket->key, bucket->klen, rt->seed) :
+                                  bucket->hash;
+
+            robin_table_put0(rt, bucket->key, bucket->klen, hash, bucket->val);
         }
     }
-    free(old_buckets);
+
+    if (retired) {
+        retired->buckets = old_buckets;
+        retired->next = rt->retired;
+        rt->retired = retired;
+    } else if (!detached) {
+        free(old_buckets);
+    }
     return true;
 }
 
+/*
+ * Recompute the PSL above which an insertion triggers a reseed.
+ */
+static void robin_table_flood_update(robin_table_t* rt)
+{
+    size_t psl = rt->flood_limit;
+
+    if (psl == SIZE_MAX) {
+        rt->flood_psl = SIZE_MAX;
+        return;
+    }
+    if (!psl) {
+        size_t bits = 0;
+
+        while (((size_t)1 << bits) < rt->bucket_count) {
+            ++bits;
+        }
+        psl = RT_FLOOD_PSL_LOG2 * bits;
+        psl = psl < RT_FLOOD_PSL_MIN ? RT_FLOOD_PSL_MIN : psl;
+    }
+
+    /* A PSL never reaches the bucket count, which disables the guard */
+    for (unsigned i = 0; i < rt->flood_backoff && psl < rt->bucket_count; ++i) {
+        psl <<= 1;
+    }
+    rt->flood_psl = psl;
+}
+
+/*
+ * Return a fresh random seed for the hash table.
+ */
+static uint64_t robin_table_random_seed(const robin_table_t* rt)
+{
+    uint64_t seed;
+    FILE* f;
+
+#ifdef RT_HAVE_GETRANDOM
+    if (getrandom(&seed, sizeof(seed), 0) == (ssize_t)sizeof(seed)) {
+        return seed;
+    }
+#endif /* RT_HAVE_GETRANDOM */
+
+    f = fopen("/dev/urandom", "rb");
+    if (f) {
+        const size_t n = fread(&seed, sizeof(seed), 1, f);
+
+        fclose(f);
+        if (n == 1) {
+            return seed;
+        }
+    }
+
+    /* No entropy source: at least move away from the attacked seed */
+    seed = rt->seed ^ (uint64_t)time(NULL) ^ (uint64_t)clock() ^ (uint64_t)(uintptr_t)rt;
+    return robin_table_rapidhash(&seed, sizeof(seed), rt->seed);
+}
+
+/*
+ * Reseed the hash table after an insertion exceeded the flood guard PSL,
+ * switch to the keyed hash function if one was given, and rehash every
+ * entry in place of the old ones.
+ * => If the rehash still exceeds the PSL, the keys collide regardless of
+ *    the seed; the PSL limit is doubled so that they do not trigger a
+ *    reseed on every insertion.
+ * => On allocation failure the hash table is left unchanged, and the next
+ *    insertion above the PSL tries again.
+ */
+static void robin_table_flood(robin_table_t* rt)
+{
+    uint64_t (*const hash_func)(const void*, size_t, uint64_t) = rt->hash_func;
+    const uint64_t seed = rt->seed;
+    const size_t psl = rt->flood_hit;
+
+    RT_ASSERT(!rt->swmr);
+
+    rt->flood_hit = 0;
+    if (rt->flood_hash) {
+        rt->hash_func = rt->flood_hash;
+        rt->key_width = robin_table_key_width(rt->hash_func);
+    }
+    rt->seed = robin_table_random_seed(rt);
+
+    if (!robin_table_resize(rt, rt->bucket_count, true)) {
+        rt->hash_func = hash_func;
+        rt->key_width = robin_table_key_width(rt->hash_func);
+        rt->seed = seed;
+        return;
+    }
+
+    if (rt->flood_hit) {
+        rt->flood_hit = 0;
+        ++rt->flood_backoff;
+        robin_table_flood_update(rt);
+    }
+
+    if (rt->flood_cb) {
+        rt->flood_cb(rt, psl, rt->flood_ctx);
+    }
+}
+
+/*
+ * Guard the hash table against hash flooding: when an insertion places an
+ * entry further than max_psl buckets from its home bucket, the hash table
+ * picks a fresh random seed, optionally switches to keyed_hash, and
+ * rehashes every entry.
+ *
+ * => max_psl 0 uses a limit derived from the bucket count, far above the
+ *    PSL of random keys; SIZE_MAX disables the guard.
+ * => keyed_hash (e.g. robin_table_siphash13) is only used from the first
+ *    reseed on, so that the fast hash function is kept until an attack
+ *    is detected. NULL keeps the current hash function.
+ * => on_reseed, if not NULL, is called with the PSL that triggered each
+ *    reseed, after the rehash.
+ * => Hashes computed for the _hashed functions are invalidated by a
+ *    reseed (robin_table_hash returns the current ones); a saved hash
+ *    table has to be loaded with the hash function it was using.
+ * => Not supported in SWMR mode, whose readers hash without a lock.
+ */
+void robin_table_flood_guard(robin_table_t* rt, size_t max_psl,
+                             uint64_t (*keyed_hash)(const void*, size_t, uint64_t),
+                             void (*on_reseed)(robin_table_t* rt, size_t psl, void* ctx),
+                             void* ctx)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(!rt->swmr);
+
+    rt->flood_limit = max_psl;
+    rt->flood_hit = 0;
+    rt->flood_backoff = 0;
+    rt->flood_hash = keyed_hash;
+    rt->flood_cb = on_reseed;
+    rt->flood_ctx = ctx;
+    robin_table_flood_update(rt);
+}
+
 /*
  * Add a new entry in the hash table using Robin Hood hashing.
  *
@@ -227,17 +561,54 @@ static bool robin_table_resize(robin_table_t* rt, size_t bucket_count)
  * => Otherwise, return newly assigned value on successful insertion.
  */
 void* robin_table_put(robin_table_t* rt, const void* key, size_t klen, void* val)
+{
+    RT_ASSERT(rt != NULL);
+
+    return robin_table_put_hashed(rt, key, klen, rt->hash_func(key, klen, rt->seed), val);
+}
+
+/*
+ * Return the hash value of a key under the current hash function and seed
+ * of the hash table, as expected by the _hashed functions.
+ *
+ * => A reseed of the flood guard changes the value for every key.
+ */
+uint64_t robin_table_hash(const robin_table_t* rt, const void* key, size_t klen)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(key != NULL && klen > 0);
+
+    return rt->hash_func(key, klen, rt->seed);
+}
+
+/*
+ * Add a new entry whose hash value has already been computed by the caller.
+ *
+ * => The hash value MUST be the one the hash function of the hash table
+ *    returns for the key with the seed of the hash table.
+ */
+void* robin_table_put_hashed(robin_table_t* rt, const void* key, size_t klen,
+                             uint64_t hash, void* val)
 {
     RT_ASSERT(rt != NULL);
     RT_ASSERT(key != NULL && klen != 0);
 
+    robin_table_write_begin(rt);
+
     if (rt->count >= rt->expand_at) {
-        if (!robin_table_resize(rt, rt->bucket_count << 1)) {
+        if (!robin_table_resize(rt, rt->bucket_count << 1, false)) {
+            robin_table_write_end(rt);
             return NULL;
         }
     }
 
-    return robin_table_put0(rt, key, klen, val);
+    val = robin_table_put0(rt, key, klen, hash, val);
+    robin_table_write_end(rt);
+
+    if (rt->flood_hit) {
+        robin_table_flood(rt);
+    }
+    return val;
 }
 
 /*
@@ -246,9 +617,8 @@ void* robin_table_put(robin_table_t* rt, const void* key, size_t klen, void* val
  * => If the key exists, return its associated bucket; otherwise, NULL.
  */
 static robin_bucket_t* robin_table_get_bucket(robin_table_t* rt, const void* key,
-                                              size_t klen)
+                                              size_t klen, uint64_t hash)
 {
-    const uint64_t hash = rt->hash_func(key, klen, rt->seed);
     size_t idx = hash & rt->mask;
     size_t psl = 0;
 
@@ -257,7 +627,7 @@ static robin_bucket_t* robin_table_get_bucket(robin_table_t* rt, const void* key
 
         /* Matching key: return the bucket */
         if (bucket->hash == hash && bucket->klen == klen &&
-            memcmp(bucket->key, key, klen) == 0) {
+            robin_table_key_eq(rt->key_width, bucket->key, key, klen)) {
             return bucket;
         }
 
@@ -275,48 +645,176 @@ static robin_bucket_t* robin_table_get_bucket(robin_table_t* rt, const void* key
     }
 }
 
+/*
+ * Compare a stored key with a key given as fragments of the same total length.
+ */
+static inline bool robin_table_frags_eq(const void* key, const robin_table_frag_t* frags,
+                                        size_t nfrags)
+{
+    const uint8_t* p = key;
+
+    for (size_t i = 0; i < nfrags; ++i) {
+        if (frags[i].len && memcmp(p, frags[i].data, frags[i].len) != 0) {
+            return false;
+        }
+        p += frags[i].len;
+    }
+    return true;
+}
+
+/*
+ * Search the bucket containing the key given as fragments (see
+ * robin_table_get_bucket).
+ */
+static robin_bucket_t* robin_table_get_bucket_frags(robin_table_t* rt,
+                                                    const robin_table_frag_t* frags,
+                                                    size_t nfrags, size_t klen, uint64_t hash)
+{
+    size_t idx = hash & rt->mask;
+    size_t psl = 0;
+
+    while (1) {
+        robin_bucket_t* bucket = rt->buckets + idx;
+
+        if (bucket->hash == hash && bucket->klen == klen &&
+            robin_table_frags_eq(bucket->key, frags, nfrags)) {
+            return bucket;
+        }
+        if (!bucket->key || bucket->psl < psl) {
+            return NULL;
+        }
+        idx = (idx + 1) & rt->mask;
+        ++psl;
+    }
+}
+
+/*
+ * Find the bucket of a key given as fragments.
+ *
+ * => Keys of at most RT_FRAGS_GATHER_MAX bytes are gathered on the stack
+ *    and looked up as one key, which is faster for them.
+ * => Longer keys are hashed and compared fragment by fragment, in place.
+ */
+static robin_bucket_t* robin_table_find_frags(robin_table_t* rt,
+                                              const robin_table_frag_t* frags, size_t nfrags)
+{
+    uint8_t buf[RT_FRAGS_GATHER_MAX];
+    size_t klen;
+    uint64_t hash;
+
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(frags != NULL && nfrags != 0);
+
+    klen = robin_frags_len(frags, nfrags);
+    RT_ASSERT(klen != 0);
+
+    if (nfrags == 1) {
+        return robin_table_get_bucket(rt, frags[0].data, klen,
+                                      rt->hash_func(frags[0].data, klen, rt->seed));
+    }
+    if (klen <= sizeof(buf)) {
+        robin_frags_gather(frags, nfrags, buf);
+        return robin_table_get_bucket(rt, buf, klen, rt->hash_func(buf, klen, rt->seed));
+    }
+
+    if (!robin_table_hash_frags(rt->hash_func, frags, nfrags, rt->seed, &hash)) {
+        return NULL;
+    }
+    return robin_table_get_bucket_frags(rt, frags, nfrags, klen, hash);
+}
+
 /*
  * Retrieve the value associated with a given key, or NULL if no entry exists.
  */
 void* robin_table_get(robin_table_t* rt, const void* key, size_t klen)
+{
+    RT_ASSERT(rt != NULL);
+
+    return robin_table_get_hashed(rt, key, klen, rt->hash_func(key, klen, rt->seed));
+}
+
+/*
+ * Retrieve the value associated with a key whose hash value has already been
+ * computed by the caller (see robin_table_put_hashed).
+ */
+void* robin_table_get_hashed(robin_table_t* rt, const void* key, size_t klen,
+                             uint64_t hash)
 {
     robin_bucket_t* bucket;
 
     RT_ASSERT(rt != NULL);
     RT_ASSERT(key != NULL && klen != 0);
 
-    bucket = robin_table_get_bucket(rt, key, klen);
+    bucket = robin_table_get_bucket(rt, key, klen, hash);
     return bucket ? bucket->val : NULL;
 }
 
 /*
- * Remove an entry with the specified key from the hash table.
+ * Retrieve the value associated with a key given as fragments (a composite
+ * key), or NULL if no entry exists.
  *
- * => Return the associated value, or NULL, if the entry is not found.
+ * => The key is the concatenation of the fragments; long keys are hashed
+ *    and compared in place, without being copied.
+ * => Also return NULL if a custom hash function needed a buffer for the key
+ *    that could not be allocated (see robin_table_hash_frags).
  */
-void* robin_table_del(robin_table_t* rt, const void* key, size_t klen)
+void* robin_table_get_frags(robin_table_t* rt, const robin_table_frag_t* frags, size_t nfrags)
 {
-    robin_bucket_t* bucket;
-    size_t idx;
-    void* val;
+    robin_bucket_t* bucket = robin_table_find_frags(rt, frags, nfrags);
 
+    return bucket ? bucket->val : NULL;
+}
+
+/*
+ * Retrieve the values of a batch of keys into vals_out (NULL if not found).
+ *
+ * => The keys are hashed RT_HASH_BATCH at a time with robin_table_hash_keys,
+ *    which runs the batch kernels of the built-in hash functions.
+ * => The home buckets are prefetched RT_PREFETCH_DISTANCE keys ahead, so
+ *    that several cache misses overlap.
+ */
+void robin_table_get_batch(robin_table_t* rt, const void* const* keys, const size_t* klens,
+                           size_t n, void** vals_out)
+{
     RT_ASSERT(rt != NULL);
-    RT_ASSERT(key != NULL && klen != 0);
+    RT_ASSERT(keys != NULL && klens != NULL && vals_out != NULL);
 
-    bucket = robin_table_get_bucket(rt, key, klen);
-    if (!bucket) {
-        return NULL;  /* Key not found */
+    uint64_t hashes[RT_HASH_BATCH];
+
+    for (size_t base = 0; base < n; base += RT_HASH_BATCH) {
+        const size_t m = n - base < RT_HASH_BATCH ? n - base : RT_HASH_BATCH;
+
+        robin_table_hash_keys(rt->hash_func, keys + base, klens + base, m, rt->seed, hashes);
+        for (size_t i = 0; i < m && i < RT_PREFETCH_DISTANCE; ++i) {
+            __builtin_prefetch(rt->buckets + (hashes[i] & rt->mask));
+        }
+
+        for (size_t i = 0; i < m; ++i) {
+            if (i + RT_PREFETCH_DISTANCE < m) {
+                __builtin_prefetch(rt->buckets + (hashes[i + RT_PREFETCH_DISTANCE] & rt->mask));
+            }
+            vals_out[base + i] = robin_table_get_hashed(rt, keys[base + i], klens[base + i],
+                                                        hashes[i]);
+        }
     }
+}
 
-    /* Store the value */
-    val = bucket->val;
+/*
+ * Internal function to remove the entry held by the given bucket using the
+ * backward shift method, without resizing the hash table.
+ */
+static void robin_table_del_bucket(robin_table_t* rt, robin_bucket_t* bucket)
+{
+    size_t idx;
 
     /* Get the bucket index */
     idx = bucket - rt->buckets;
+    robin_table_cow(rt, idx);
 
     /* Apply the backward shift method */
     while (1) {
         robin_bucket_t* next_bucket;
+        robin_bucket_t entry;
 
         idx = (idx + 1) & rt->mask;
         next_bucket = rt->buckets + idx;
@@ -327,65 +825,666 @@ void* robin_table_del(robin_table_t* rt, const void* key, size_t klen)
          */
         if (!next_bucket->key || next_bucket->psl == 0) {
             /* Clear the bucket */
-            memset(bucket, 0, sizeof(*bucket));
+            robin_table_store_empty(rt, bucket);
             --rt->count;
             break;
         }
 
-        --next_bucket->psl;
-        *bucket = *next_bucket;
+        robin_table_cow(rt, idx);
+        entry = *next_bucket;
+        --entry.psl;
+        robin_table_store(rt, bucket, &entry);
         bucket = next_bucket;
     }
+}
+
+/*
+ * Shrink the hash table, in a single resize, to the smallest bucket count
+ * that keeps the load factor above its minimum threshold.
+ */
+static void robin_table_shrink(robin_table_t* rt)
+{
+    size_t bucket_count = rt->bucket_count;
+
+    /* SWMR readers rely on the bucket array never shrinking */
+    if (rt->swmr) {
+        return;
+    }
+
+    while (bucket_count > rt->init_buckets &&
+           rt->count <= (bucket_count * RT_LOAD_FACTOR_PCT_MIN) / 100) {
+        bucket_count >>= 1;
+    }
 
-    if (rt->bucket_count > rt->init_buckets && rt->count <= rt->shrink_at) {
+    if (bucket_count != rt->bucket_count) {
         /*
          * Safe to ignore shrink failures: no structural impact on the hash table
          */
-        (void)robin_table_resize(rt, rt->bucket_count >> 1);
+        (void)robin_table_resize(rt, bucket_count, false);
     }
-    return val;
 }
 
 /*
- * Clear the hash table and optionally shrink to its initial number of buckets.
+ * Remove the entry of a bucket found by a lookup and return its value,
+ * shrinking the hash table if the load factor fell below its minimum.
  */
-bool robin_table_clear(robin_table_t* rt, bool update_buckets)
+static void* robin_table_del_found(robin_table_t* rt, robin_bucket_t* bucket)
 {
-    RT_ASSERT(rt != NULL);
+    /* Store the value */
+    void* val = bucket->val;
 
-    if (update_buckets) {
-        robin_bucket_t* new_buckets;
+    robin_table_write_begin(rt);
+    robin_table_del_bucket(rt, bucket);
 
-        new_buckets = malloc(rt->init_buckets * sizeof(robin_bucket_t));
-        if (!new_buckets) {
-            return false;
-        }
-        free(rt->buckets);
-        rt->buckets = new_buckets;
-        rt->bucket_count = rt->init_buckets;
-        rt->mask = rt->bucket_count - 1;
-        rt->expand_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100;
-        rt->shrink_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MIN) / 100;
+    if (!rt->swmr && rt->bucket_count > rt->init_buckets && rt->count <= rt->shrink_at) {
+        /*
+         * Safe to ignore shrink failures: no structural impact on the hash table
+         */
+        (void)robin_table_resize(rt, rt->bucket_count >> 1, false);
     }
-    rt->count = 0;
-    memset(rt->buckets, 0, rt->bucket_count * sizeof(*rt->buckets));
-    return true;
+    robin_table_write_end(rt);
+    return val;
 }
 
 /*
- * Free the memory associated with the hash table.
+ * Remove an entry with the specified key from the hash table.
+ *
+ * => Return the associated value, or NULL, if the entry is not found.
  */
-void robin_table_destroy(robin_table_t* rt)
+void* robin_table_del(robin_table_t* rt, const void* key, size_t klen)
+{
+    RT_ASSERT(rt != NULL);
+
+    return robin_table_del_hashed(rt, key, klen, rt->hash_func(key, klen, rt->seed));
+}
+
+/*
+ * Remove an entry with a key whose hash value has already been computed by
+ * the caller (see robin_table_put_hashed).
+ */
+void* robin_table_del_hashed(robin_table_t* rt, const void* key, size_t klen,
+                             uint64_t hash)
+{
+    robin_bucket_t* bucket;
+
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(key != NULL && klen != 0);
+
+    bucket = robin_table_get_bucket(rt, key, klen, hash);
+    if (!bucket) {
+        return NULL;  /* Key not found */
+    }
+    return robin_table_del_found(rt, bucket);
+}
+
+/*
+ * Remove the entry with a key given as fragments (see robin_table_get_frags).
+ *
+ * => Return the associated value, or NULL, if the entry is not found.
+ */
+void* robin_table_del_frags(robin_table_t* rt, const robin_table_frag_t* frags, size_t nfrags)
+{
+    robin_bucket_t* bucket = robin_table_find_frags(rt, frags, nfrags);
+
+    if (!bucket) {
+        return NULL;  /* Key not found */
+    }
+    return robin_table_del_found(rt, bucket);
+}
+
+/*
+ * Keep only the entries for which pred returns true.
+ *
+ * => The survivors are compacted towards their home buckets in a single
+ *    forward sweep that starts right after an empty bucket, so no entry is
+ *    shifted more than once and the Robin Hood ordering is preserved.
+ * => At most one shrink is applied once the sweep is complete.
+ * => Return the number of removed entries.
+ */
+size_t robin_table_retain(robin_table_t* rt,
+                          bool (*pred)(const void* key, size_t klen, void* val, void* ctx),
+                          void* ctx)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(pred != NULL);
+
+    size_t start = 0;
+    size_t next = 1;  /* Position of the first bucket not claimed by a survivor */
+    size_t removed = 0;
+
+    /* The load factor guarantees that at least one bucket is empty */
+    while (rt->buckets[start].key) {
+        ++start;
+    }
+
+    robin_table_write_begin(rt);
+
+    for (size_t pos = 1; pos < rt->bucket_count; ++pos) {
+        robin_bucket_t* bucket = rt->buckets + ((start + pos) & rt->mask);
+        size_t home;
+        size_t dest;
+
+        if (!bucket->key) {
+            continue;
+        }
+
+        if (!pred(bucket->key, bucket->klen, bucket->val, ctx)) {
+            robin_table_cow(rt, (start + pos) & rt->mask);
+            robin_table_store_empty(rt, bucket);
+            ++removed;
+            continue;
+        }
+
+        /* Positions are relative to the empty starting bucket */
+        home = pos - bucket->psl;
+        dest = home > next ? home : next;
+
+        if (dest != pos) {
+            robin_bucket_t* dest_bucket = rt->buckets + ((start + dest) & rt->mask);
+            robin_bucket_t entry = *bucket;
+
+            robin_table_cow(rt, (start + dest) & rt->mask);
+            robin_table_cow(rt, (start + pos) & rt->mask);
+            entry.psl = dest - home;
+            robin_table_store(rt, dest_bucket, &entry);
+            robin_table_store_empty(rt, bucket);
+        }
+        next = dest + 1;
+    }
+
+    rt->count -= removed;
+    robin_table_shrink(rt);
+    robin_table_write_end(rt);
+    return removed;
+}
+
+/*
+ * Clear the hash table and optionally shrink to its initial number of buckets.
+ *
+ * => In SWMR mode the number of buckets is always kept.
+ * => If snapshots share the bucket array, they keep it and a new one is
+ *    allocated instead of clearing it in place.
+ */
+bool robin_table_clear(robin_table_t* rt, bool update_buckets)
+{
+    RT_ASSERT(rt != NULL);
+
+    if (!rt->swmr && (update_buckets || rt->cow_bits)) {
+        const size_t bucket_count = update_buckets ? rt->init_buckets : rt->bucket_count;
+        robin_bucket_t* new_buckets;
+
+        new_buckets = malloc(bucket_count * sizeof(robin_bucket_t));
+        if (!new_buckets) {
+            return false;
+        }
+        if (!robin_table_snapshot_detach(rt)) {
+            free(rt->buckets);
+        }
+        rt->buckets = new_buckets;
+        rt->bucket_count = bucket_count;
+        rt->mask = rt->bucket_count - 1;
+        rt->expand_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100;
+        rt->shrink_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MIN) / 100;
+    }
+    rt->flood_hit = 0;
+    rt->flood_backoff = 0;
+    robin_table_flood_update(rt);
+    robin_table_write_begin(rt);
+    rt->count = 0;
+    if (rt->swmr) {
+        for (size_t i = 0; i < rt->bucket_count; ++i) {
+            robin_table_store_empty(rt, rt->buckets + i);
+        }
+    } else {
+        memset(rt->buckets, 0, rt->bucket_count * sizeof(*rt->buckets));
+    }
+    robin_table_write_end(rt);
+    return true;
+}
+
+/*
+ * Free the memory associated with the hash table.
+ */
+void robin_table_destroy(robin_table_t* rt)
 {
     if (!rt) {
         return;
     }
 
-    free(rt->buckets);
+    robin_table_swmr_reclaim(rt);
+    if (!robin_table_snapshot_detach(rt)) {
+        free(rt->buckets);
+    }
+    free(rt->key_arena);
     memset(rt, 0, sizeof(*rt));
     free(rt);
 }
 
+/*
+ * Switch the hash table to single-writer/multi-reader (SWMR) mode.
+ *
+ * => One thread may keep using the regular functions to modify the hash
+ *    table while any number of threads call robin_table_get_swmr, without
+ *    taking a lock. Enable the mode before the readers are started.
+ * => Readers validate a sequence counter that the writer bumps around every
+ *    modification, and retry if a put, delete or resize overlapped.
+ * => The hash table never shrinks in SWMR mode, and replaced bucket arrays
+ *    are retired until robin_table_swmr_reclaim or robin_table_destroy.
+ */
+void robin_table_swmr_enable(robin_table_t* rt)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(rt->cow_base == NULL);
+    RT_ASSERT(rt->flood_limit == SIZE_MAX);
+
+    rt->swmr = true;
+}
+
+/*
+ * Free the bucket arrays retired by resizes in SWMR mode.
+ *
+ * => Only call when no reader can still be inside robin_table_get_swmr.
+ */
+void robin_table_swmr_reclaim(robin_table_t* rt)
+{
+    RT_ASSERT(rt != NULL);
+
+    while (rt->retired) {
+        robin_retired_t* next = rt->retired->next;
+
+        free(rt->retired->buckets);
+        free(rt->retired);
+        rt->retired = next;
+    }
+}
+
+/*
+ * Internal function to look up a key during one SWMR read attempt.
+ *
+ * => Return false if a write overlapped with the attempt.
+ */
+static bool robin_table_get_swmr0(const robin_table_t* rt, const void* key, size_t klen,
+                                  uint64_t seq, void** val)
+{
+    /* Fixed once SWMR mode is enabled, but loaded like every shared field */
+    uint64_t (*const hash_func)(const void*, size_t, uint64_t) =
+        __atomic_load_n(&rt->hash_func, __ATOMIC_RELAXED);
+    const uint64_t hash = hash_func(key, klen, __atomic_load_n(&rt->seed, __ATOMIC_RELAXED));
+    const size_t mask = __atomic_load_n(&rt->mask, __ATOMIC_ACQUIRE);
+    const robin_bucket_t* buckets = __atomic_load_n(&rt->buckets, __ATOMIC_RELAXED);
+    size_t idx = hash & mask;
+
+    *val = NULL;
+
+    /* Bound the probe: a torn read must never loop forever */
+    for (size_t psl = 0; psl <= mask; ++psl) {
+        const robin_bucket_t* bucket = buckets + idx;
+        const void* bkey = __atomic_load_n(&bucket->key, __ATOMIC_RELAXED);
+
+        if (!bkey || __atomic_load_n(&bucket->psl, __ATOMIC_RELAXED) < psl) {
+            break;
+        }
+
+        if (__atomic_load_n(&bucket->hash, __ATOMIC_RELAXED) == hash &&
+            __atomic_load_n(&bucket->klen, __ATOMIC_RELAXED) == klen) {
+            void* bval = __atomic_load_n(&bucket->val, __ATOMIC_RELAXED);
+
+            /* Validate before dereferencing the stored key */
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&rt->seq, __ATOMIC_RELAXED) != seq) {
+                return false;
+            }
+            if (robin_table_key_eq(rt->key_width, bkey, key, klen)) {
+                *val = bval;
+                return true;
+            }
+        }
+
+        /* Advance to the next bucket */
+        idx = (idx + 1) & mask;
+    }
+
+    /* Validate the miss */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&rt->seq, __ATOMIC_RELAXED) == seq;
+}
+
+/*
+ * Retrieve the value associated with a given key without taking a lock,
+ * while a single writer may be modifying the hash table (see
+ * robin_table_swmr_enable).
+ *
+ * => Keys removed by the writer must remain readable until the retired
+ *    bucket arrays are reclaimed.
+ */
+void* robin_table_get_swmr(const robin_table_t* rt, const void* key, size_t klen)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(key != NULL && klen != 0);
+
+    void* val;
+
+    while (1) {
+        const uint64_t seq = __atomic_load_n(&rt->seq, __ATOMIC_ACQUIRE);
+
+        /* Retry while a write is in progress or overlapped with the lookup */
+        if (!(seq & 1) && robin_table_get_swmr0(rt, key, klen, seq, &val)) {
+            return val;
+        }
+    }
+}
+
+/*
+ * Take a point-in-time, read-only snapshot of the hash table.
+ *
+ * => The snapshot shares the bucket array with the hash table; a write copies
+ *    a page of RT_SNAPSHOT_PAGE buckets into the snapshots only when it first
+ *    modifies that page after they were taken. A resize or clear hands the
+ *    whole old bucket array over to the snapshots instead of freeing it.
+ * => Must not be called concurrently with writes; the snapshot itself may be
+ *    read and released from any thread while the hash table is modified.
+ * => Keys of entries removed after the snapshot was taken must remain valid
+ *    until it is released.
+ * => Not supported in SWMR mode.
+ */
+robin_table_snapshot_t* robin_table_snapshot(robin_table_t* rt)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(!rt->swmr);
+
+    robin_table_snapshot_t* snap;
+    const size_t page_count = (rt->bucket_count + RT_SNAPSHOT_PAGE - 1) / RT_SNAPSHOT_PAGE;
+    const size_t words = (page_count + 63) / 64;
+
+    snap = malloc(sizeof(robin_table_snapshot_t));
+    if (!snap) {
+        return NULL;
+    }
+    snap->pages = calloc(page_count, sizeof(*snap->pages));
+    if (!snap->pages) {
+        free(snap);
+        return NULL;
+    }
+
+    if (!rt->cow_base) {
+        robin_snapshot_base_t* base = malloc(sizeof(robin_snapshot_base_t));
+        uint64_t* bits = malloc(words * sizeof(uint64_t));
+
+        if (!base || !bits || pthread_mutex_init(&base->lock, NULL) != 0) {
+            free(base);
+            free(bits);
+            free(snap->pages);
+            free(snap);
+            return NULL;
+        }
+        base->buckets = rt->buckets;
+        base->refs = 0;
+        base->detached = false;
+        rt->cow_base = base;
+        rt->cow_bits = bits;
+    }
+
+    pthread_mutex_lock(&rt->cow_base->lock);
+
+    /* The new snapshot has no page copies yet */
+    memset(rt->cow_bits, 0, words * sizeof(uint64_t));
+    __atomic_add_fetch(&rt->cow_base->refs, 1, __ATOMIC_RELAXED);
+
+    snap->rt = rt;
+    snap->base = rt->cow_base;
+    snap->count = rt->count;
+    snap->bucket_count = rt->bucket_count;
+    snap->mask = rt->mask;
+    snap->page_count = page_count;
+    snap->seed = rt->seed;
+    snap->hash_func = rt->hash_func;
+    snap->key_width = rt->key_width;
+    snap->detached = false;
+    snap->invalid = false;
+    snap->next = rt->snapshots;
+    rt->snapshots = snap;
+    pthread_mutex_unlock(&rt->cow_base->lock);
+    return snap;
+}
+
+/*
+ * Copy a page of the bucket array into every snapshot that still shares it.
+ */
+static void robin_table_cow_page(robin_table_t* rt, size_t page)
+{
+    const size_t first = page * RT_SNAPSHOT_PAGE;
+    const size_t len = rt->bucket_count < RT_SNAPSHOT_PAGE ? rt->bucket_count
+                                                           : RT_SNAPSHOT_PAGE;
+    robin_snapshot_page_t* copy = NULL;
+
+    pthread_mutex_lock(&rt->cow_base->lock);
+    for (robin_table_snapshot_t* snap = rt->snapshots; snap; snap = snap->next) {
+        if (snap->pages[page]) {
+            continue;
+        }
+        if (!copy) {
+            copy = malloc(sizeof(robin_snapshot_page_t) + len * sizeof(robin_bucket_t));
+            if (!copy) {
+                /* The snapshot can no longer be consistent */
+                __atomic_store_n(&snap->invalid, true, __ATOMIC_RELEASE);
+                continue;
+            }
+            copy->refs = 0;
+            memcpy(copy->buckets, rt->buckets + first, len * sizeof(robin_bucket_t));
+        }
+        ++copy->refs;
+        __atomic_store_n(&snap->pages[page], copy, __ATOMIC_RELEASE);
+    }
+    rt->cow_bits[page / 64] |= (uint64_t)1 << (page % 64);
+    pthread_mutex_unlock(&rt->cow_base->lock);
+
+    /* Publish the copies before the page is modified */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/*
+ * Hand the bucket array over to the snapshots sharing it, before the hash
+ * table replaces or frees it.
+ *
+ * => Return true if the snapshots took ownership of the bucket array.
+ */
+static bool robin_table_snapshot_detach(robin_table_t* rt)
+{
+    robin_snapshot_base_t* base = rt->cow_base;
+
+    if (!base) {
+        return false;
+    }
+
+    pthread_mutex_lock(&base->lock);
+    for (robin_table_snapshot_t* snap = rt->snapshots; snap; snap = snap->next) {
+        snap->rt = NULL;
+        __atomic_store_n(&snap->detached, true, __ATOMIC_RELEASE);
+    }
+    rt->snapshots = NULL;
+    rt->cow_base = NULL;
+    free(rt->cow_bits);
+    rt->cow_bits = NULL;
+
+    base->detached = true;
+    if (!__atomic_load_n(&base->refs, __ATOMIC_RELAXED)) {
+        pthread_mutex_unlock(&base->lock);
+        pthread_mutex_destroy(&base->lock);
+        free(base);
+        return false;
+    }
+    pthread_mutex_unlock(&base->lock);
+    return true;
+}
+
+/*
+ * Release a snapshot and the pages only it still references.
+ *
+ * => May be called from any thread, also after the hash table was destroyed.
+ */
+void robin_table_snapshot_release(robin_table_snapshot_t* snap)
+{
+    robin_snapshot_base_t* base;
+
+    if (!snap) {
+        return;
+    }
+
+    base = snap->base;
+    pthread_mutex_lock(&base->lock);
+    if (snap->rt) {
+        robin_table_snapshot_t** link = &snap->rt->snapshots;
+
+        while (*link != snap) {
+            link = &(*link)->next;
+        }
+        *link = snap->next;
+    }
+
+    for (size_t i = 0; i < snap->page_count; ++i) {
+        robin_snapshot_page_t* page = snap->pages[i];
+
+        if (page && --page->refs == 0) {
+            free(page);
+        }
+    }
+
+    /*
+     * The last snapshot of a detached bucket array frees it; if the array
+     * is still live, the next write of the hash table frees the base.
+     */
+    if (__atomic_sub_fetch(&base->refs, 1, __ATOMIC_RELEASE) == 0 && base->detached) {
+        pthread_mutex_unlock(&base->lock);
+        pthread_mutex_destroy(&base->lock);
+        free(base->buckets);
+        free(base);
+    } else {
+        pthread_mutex_unlock(&base->lock);
+    }
+
+    free(snap->pages);
+    free(snap);
+}
+
+/*
+ * Return a consistent view of a page of the snapshot: its copy, the shared
+ * bucket array if the page was not modified, or buf filled from it.
+ */
+static const robin_bucket_t* robin_table_snapshot_page(const robin_table_snapshot_t* snap,
+                                                       size_t page, robin_bucket_t* buf)
+{
+    const bool detached = __atomic_load_n(&snap->detached, __ATOMIC_ACQUIRE);
+    const robin_snapshot_page_t* copy = __atomic_load_n(&snap->pages[page], __ATOMIC_ACQUIRE);
+    const robin_bucket_t* live = snap->base->buckets + page * RT_SNAPSHOT_PAGE;
+    const size_t len = snap->bucket_count < RT_SNAPSHOT_PAGE ? snap->bucket_count
+                                                             : RT_SNAPSHOT_PAGE;
+
+    if (copy) {
+        return copy->buckets;
+    }
+
+    /* A detached bucket array is never modified again */
+    if (detached) {
+        return live;
+    }
+
+    /*
+     * The writer publishes a copy before it modifies the page: if there is
+     * still no copy after reading the page, the read was not torn.
+     */
+    for (size_t i = 0; i < len; ++i) {
+        buf[i].key = __atomic_load_n(&live[i].key, __ATOMIC_RELAXED);
+        buf[i].val = __atomic_load_n(&live[i].val, __ATOMIC_RELAXED);
+        buf[i].psl = __atomic_load_n(&live[i].psl, __ATOMIC_RELAXED);
+        buf[i].klen = __atomic_load_n(&live[i].klen, __ATOMIC_RELAXED);
+        buf[i].hash = __atomic_load_n(&live[i].hash, __ATOMIC_RELAXED);
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    copy = __atomic_load_n(&snap->pages[page], __ATOMIC_ACQUIRE);
+    return copy ? copy->buckets : buf;
+}
+
+/*
+ * Invoke fn for every entry of the snapshot, as of the time it was taken.
+ *
+ * => The traversal stops as soon as fn returns false.
+ * => Return false if the traversal was stopped early or the snapshot was
+ *    invalidated by a failed page copy; otherwise, true.
+ */
+bool robin_table_snapshot_for_each(const robin_table_snapshot_t* snap,
+                                   bool (*fn)(const void* key, size_t klen, void* val,
+                                              void* ctx),
+                                   void* ctx)
+{
+    RT_ASSERT(snap != NULL);
+    RT_ASSERT(fn != NULL);
+
+    robin_bucket_t buf[RT_SNAPSHOT_PAGE];
+    const size_t len = snap->bucket_count < RT_SNAPSHOT_PAGE ? snap->bucket_count
+                                                             : RT_SNAPSHOT_PAGE;
+
+    for (size_t page = 0; page < snap->page_count; ++page) {
+        const robin_bucket_t* bucket = robin_table_snapshot_page(snap, page, buf);
+        const robin_bucket_t* end = bucket + len;
+
+        for (; bucket != end; ++bucket) {
+            if (bucket->key && !fn(bucket->key, bucket->klen, bucket->val, ctx)) {
+                return false;
+            }
+        }
+    }
+    return !__atomic_load_n(&snap->invalid, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Retrieve the value a key had when the snapshot was taken, or NULL.
+ */
+void* robin_table_snapshot_get(const robin_table_snapshot_t* snap, const void* key,
+                               size_t klen)
+{
+    RT_ASSERT(snap != NULL);
+    RT_ASSERT(key != NULL && klen != 0);
+
+    const uint64_t hash = snap->hash_func(key, klen, snap->seed);
+    robin_bucket_t buf[RT_SNAPSHOT_PAGE];
+    const robin_bucket_t* page = NULL;
+    size_t page_idx = SIZE_MAX;
+    size_t idx = hash & snap->mask;
+
+    for (size_t psl = 0; psl <= snap->mask; ++psl) {
+        const robin_bucket_t* bucket;
+
+        if (idx / RT_SNAPSHOT_PAGE != page_idx) {
+            page_idx = idx / RT_SNAPSHOT_PAGE;
+            page = robin_table_snapshot_page(snap, page_idx, buf);
+        }
+        bucket = page + idx % RT_SNAPSHOT_PAGE;
+
+        if (!bucket->key || bucket->psl < psl) {
+            break;
+        }
+        if (bucket->hash == hash && bucket->klen == klen &&
+            robin_table_key_eq(snap->key_width, bucket->key, key, klen)) {
+            return bucket->val;
+        }
+
+        /* Advance to the next bucket */
+        idx = (idx + 1) & snap->mask;
+    }
+    return NULL;
+}
+
+/*
+ * Return the number of entries in the snapshot.
+ */
+size_t robin_table_snapshot_count(const robin_table_snapshot_t* snap)
+{
+    RT_ASSERT(snap != NULL);
+
+    return snap->count;
+}
+
 /*
  * Return the number of entries in the hash table.
  */
@@ -407,6 +1506,45 @@ double robin_table_load_factor(const robin_table_t* rt)
     return (double)rt->count / rt->bucket_count;
 }
 
+/*
+ * Initialize a caller-provided (e.g., stack allocated) iterator.
+ *
+ * => The traversal starts right after an empty bucket, so no cluster wraps
+ *    around the start and backward shifts in robin_table_iter_erase never
+ *    move an entry across the starting point.
+ */
+void robin_table_iter_init(robin_table_iter_t* iter, const robin_table_t* rt)
+{
+    RT_ASSERT(iter != NULL);
+    RT_ASSERT(rt != NULL);
+
+    size_t start = 0;
+
+    /* The load factor guarantees that at least one bucket is empty */
+    while (rt->buckets[start].key) {
+        ++start;
+    }
+
+    iter->key = NULL;
+    iter->klen = 0;
+    iter->val = NULL;
+    iter->priv.rt = rt;
+    iter->priv.mut = NULL;
+    iter->priv.idx = 0;
+    iter->priv.start = start;
+    iter->priv.erased = false;
+}
+
+/*
+ * Initialize a caller-provided iterator that may remove entries with
+ * robin_table_iter_erase.
+ */
+void robin_table_iter_init_mut(robin_table_iter_t* iter, robin_table_t* rt)
+{
+    robin_table_iter_init(iter, rt);
+    iter->priv.mut = rt;
+}
+
 /*
  * Create a new iterator for traversing the hash table.
  */
@@ -414,55 +1552,412 @@ robin_table_iter_t* robin_table_iter_create(const robin_table_t* rt)
 {
     RT_ASSERT(rt != NULL);
 
-    robin_table_iter_impl_t* iter_impl = malloc(sizeof(robin_table_iter_impl_t));
-    if (!iter_impl) {
+    robin_table_iter_t* iter = malloc(sizeof(robin_table_iter_t));
+    if (!iter) {
         return NULL;
     }
-    iter_impl->iter.key = NULL;
-    iter_impl->iter.val = NULL;
-    iter_impl->rt = rt;
-    iter_impl->idx = -1;
+    robin_table_iter_init(iter, rt);
 
-    return &iter_impl->iter;
+    return iter;
 }
 
 /*
  * Advance the iterator to the next entry in the hash table.
  *
  * => Return false if no more valid entries are left in the hash table.
+ * => Any shrink deferred by robin_table_iter_erase is applied here once
+ *    the traversal is complete.
  */
 bool robin_table_iter_next(robin_table_iter_t* iter)
 {
     RT_ASSERT(iter != NULL);
 
-    robin_table_iter_impl_t* iter_impl = (robin_table_iter_impl_t*)iter;
+    const robin_table_t* rt = iter->priv.rt;
 
-    while (++iter_impl->idx < iter_impl->rt->bucket_count) {
-        const robin_bucket_t* bucket = iter_impl->rt->buckets + iter_impl->idx;
+    while (++iter->priv.idx < rt->bucket_count) {
+        const robin_bucket_t* bucket =
+            rt->buckets + ((iter->priv.start + iter->priv.idx) & rt->mask);
 
         if (bucket->key) {
-            iter_impl->iter.key = bucket->key;
-            iter_impl->iter.val = bucket->val;
+            iter->key = bucket->key;
+            iter->klen = bucket->klen;
+            iter->val = bucket->val;
             return true;
         }
     }
 
     /* Clear the iterator */
-    memset(&iter_impl->iter, 0, sizeof(*iter));
+    iter->key = NULL;
+    iter->klen = 0;
+    iter->val = NULL;
+
+    if (iter->priv.erased) {
+        iter->priv.erased = false;
+        robin_table_shrink(iter->priv.mut);
+    }
     return false;
 }
 
 /*
- * Free the memory associated with the iterator.
+ * Remove the entry the iterator is currently positioned on.
+ *
+ * => The backward shift only ever pulls not yet visited entries into the
+ *    current bucket, so the cursor is stepped back to revisit it and every
+ *    remaining entry is still returned exactly once.
+ * => The iterator MUST come from robin_table_iter_init_mut.
+ * => Shrinking is deferred until robin_table_iter_next reaches the end. A
+ *    traversal abandoned earlier skips it: the hash table keeps its size
+ *    until later deletions shrink it, by half per deletion.
+ * => Return the value of the removed entry.
+ */
+void* robin_table_iter_erase(robin_table_iter_t* iter)
+{
+    RT_ASSERT(iter != NULL);
+    RT_ASSERT(iter->key != NULL);
+    RT_ASSERT(iter->priv.mut != NULL);
+
+    robin_table_t* rt = iter->priv.mut;
+    robin_bucket_t* bucket = rt->buckets + ((iter->priv.start + iter->priv.idx) & rt->mask);
+    void* val = bucket->val;
+
+    robin_table_write_begin(rt);
+    robin_table_del_bucket(rt, bucket);
+    robin_table_write_end(rt);
+
+    --iter->priv.idx;
+    iter->key = NULL;
+    iter->klen = 0;
+    iter->val = NULL;
+    iter->priv.erased = true;
+    return val;
+}
+
+/*
+ * Free the memory associated with an iterator from robin_table_iter_create.
  */
 void robin_table_iter_destroy(robin_table_iter_t* iter)
 {
-    if (!iter) {
-        return;
+    free(iter);
+}
+
+/*
+ * Return the bucket array and set *bucket_count, for the header-only
+ * traversal of robin_table_inline.h.
+ *
+ * => The array is only valid until the hash table is modified.
+ */
+const robin_table_bucket_t* robin_table_buckets(const robin_table_t* rt, size_t* bucket_count)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(bucket_count != NULL);
+
+    *bucket_count = rt->bucket_count;
+    return rt->buckets;
+}
+
+/*
+ * Invoke fn for every entry in the hash table without allocating an iterator.
+ *
+ * => The traversal stops as soon as fn returns false.
+ * => Return false if the traversal was stopped early; otherwise, true.
+ */
+bool robin_table_for_each(const robin_table_t* rt,
+                          bool (*fn)(const void* key, size_t klen, void* val, void* ctx),
+                          void* ctx)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(fn != NULL);
+
+    return robin_table_for_each_inline(rt, fn, ctx);
+}
+
+/*
+ * Reverse the bits of the given cursor.
+ */
+static inline size_t robin_table_rev_bits(size_t v)
+{
+    size_t s = CHAR_BIT * sizeof(v);
+    size_t mask = ~(size_t)0;
+
+    while ((s >>= 1) > 0) {
+        mask ^= (mask << s);
+        v = ((v >> s) & mask) | ((v << s) & ~mask);
+    }
+    return v;
+}
+
+/*
+ * Incrementally scan the hash table; start with a cursor of 0 and pass the
+ * returned cursor to the next call until it returns 0 again.
+ *
+ * => Each call visits the entries of up to count home buckets, so the work
+ *    per call is bounded by count times the maximum probe sequence length.
+ * => The cursor is advanced with a reverse binary increment over the bucket
+ *    index bits, so every entry present for the whole scan is returned at
+ *    least once even if the hash table is expanded or shrunk between calls.
+ *    Entries may be returned more than once.
+ * => fn must not modify the hash table.
+ */
+size_t robin_table_scan(const robin_table_t* rt, size_t cursor, size_t count,
+                        void (*fn)(const void* key, size_t klen, void* val, void* ctx),
+                        void* ctx)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(fn != NULL);
+    RT_ASSERT(count != 0);
+
+    do {
+        size_t idx = cursor & rt->mask;
+        size_t psl = 0;
+
+        /*
+         * Entries whose home bucket is idx form a contiguous run that ends
+         * at the first empty bucket or the first "richer" bucket.
+         */
+        while (1) {
+            const robin_bucket_t* bucket = rt->buckets + idx;
+
+            if (!bucket->key || bucket->psl < psl) {
+                break;
+            }
+            if (bucket->psl == psl) {
+                fn(bucket->key, bucket->klen, bucket->val, ctx);
+            }
+
+            /* Advance to the next bucket */
+            idx = (idx + 1) & rt->mask;
+            ++psl;
+        }
+
+        /* Increment the reversed cursor over the unmasked bits */
+        cursor |= ~rt->mask;
+        cursor = robin_table_rev_bits(cursor);
+        ++cursor;
+        cursor = robin_table_rev_bits(cursor);
+    } while (cursor != 0 && --count > 0);
+
+    return cursor;
+}
+
+/*
+ * Return the index of the lowest set bit of v, which MUST be nonzero.
+ */
+static inline unsigned robin_table_ctz32(uint32_t v)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctz(v);
+#else
+    unsigned n = 0;
+
+    while (!(v & 1)) {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/*
+ * Copy up to cap entries into the given arrays in bucket order; any of the
+ * output arrays may be NULL.
+ *
+ * => Buckets are processed in blocks: an occupancy mask is computed for the
+ *    whole block first, so empty regions are skipped without branching on
+ *    every bucket.
+ * => Return the number of exported entries.
+ */
+size_t robin_table_export(const robin_table_t* rt, const void** keys_out,
+                          size_t* klens_out, void** vals_out, size_t cap)
+{
+    RT_ASSERT(rt != NULL);
+
+    size_t n = 0;
+
+    for (size_t base = 0; base < rt->bucket_count && n < cap; base += RT_EXPORT_BLOCK) {
+        const robin_bucket_t* block = rt->buckets + base;
+        uint32_t occupied = 0;
+
+        for (unsigned i = 0; i < RT_EXPORT_BLOCK; ++i) {
+            occupied |= (uint32_t)(block[i].key != NULL) << i;
+        }
+
+        while (occupied && n < cap) {
+            const robin_bucket_t* bucket = block + robin_table_ctz32(occupied);
+
+            occupied &= occupied - 1;
+            if (keys_out) {
+                keys_out[n] = bucket->key;
+            }
+            if (klens_out) {
+                klens_out[n] = bucket->klen;
+            }
+            if (vals_out) {
+                vals_out[n] = bucket->val;
+            }
+            ++n;
+        }
+    }
+    return n;
+}
+
+/*
+ * Compare two exported entries by key, or by hash value if cmp is NULL.
+ */
+static inline int robin_table_export_cmp(const robin_bucket_t* a, const robin_bucket_t* b,
+                                         int (*cmp)(const void*, size_t, const void*, size_t))
+{
+    if (!cmp) {
+        return (a->hash > b->hash) - (a->hash < b->hash);
     }
+    return cmp(a->key, a->klen, b->key, b->klen);
+}
+
+/*
+ * Sort the entries with a stable bottom-up merge sort, starting from runs of
+ * width entries that are already sorted (1 for unsorted entries).
+ *
+ * => Return the array holding the sorted entries (either src or tmp).
+ */
+RT_INTERNAL robin_bucket_t* robin_table_export_sort(robin_bucket_t* src, robin_bucket_t* tmp,
+                                                    size_t n, size_t width,
+                                                    int (*cmp)(const void*, size_t,
+                                                               const void*, size_t))
+{
+    for (; width < n; width <<= 1) {
+        for (size_t lo = 0; lo < n; lo += width << 1) {
+            size_t mid = lo + width < n ? lo + width : n;
+            size_t hi = lo + (width << 1) < n ? lo + (width << 1) : n;
+            size_t i = lo;
+            size_t j = mid;
+            size_t k = lo;
+
+            while (i < mid && j < hi) {
+                if (robin_table_export_cmp(src + j, src + i, cmp) < 0) {
+                    tmp[k++] = src[j++];
+                } else {
+                    tmp[k++] = src[i++];
+                }
+            }
+            while (i < mid) {
+                tmp[k++] = src[i++];
+            }
+            while (j < hi) {
+                tmp[k++] = src[j++];
+            }
+        }
+
+        /* Swap the roles of the arrays */
+        robin_bucket_t* swap = src;
+        src = tmp;
+        tmp = swap;
+    }
+    return src;
+}
+
+/*
+ * Export the entries sorted, first sorting runs of entries on the threads of
+ * the pool if it is not NULL, then merging the runs on the calling thread.
+ */
+static bool robin_table_export_sorted_pool(robin_table_pool_t* pool, const robin_table_t* rt,
+                                           const void** keys_out, size_t* klens_out,
+                                           void** vals_out, size_t cap,
+                                           int (*cmp)(const void*, size_t,
+                                                      const void*, size_t),
+                                           size_t* count)
+{
+    robin_bucket_t* entries;
+    robin_bucket_t* sorted;
+    size_t width = 1;
+    size_t n = 0;
+
+    *count = 0;
+    if (rt->count == 0 || cap == 0) {
+        return true;
+    }
+
+    /* The merge sort needs a second array of the same size */
+    if (rt->count > SIZE_MAX / (2 * sizeof(robin_bucket_t))) {
+        return false;
+    }
+    entries = malloc(2 * rt->count * sizeof(robin_bucket_t));
+    if (!entries) {
+        return false;
+    }
+
+    for (size_t i = 0; i < rt->bucket_count; ++i) {
+        if (rt->buckets[i].key) {
+            entries[n++] = rt->buckets[i];
+        }
+    }
+    RT_ASSERT(n == rt->count);
+
+    if (pool) {
+        width = robin_pool_sort_runs(pool, entries, entries + n, n, cmp);
+    }
+    sorted = robin_table_export_sort(entries, entries + n, n, width, cmp);
+
+    if (n > cap) {
+        n = cap;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (keys_out) {
+            keys_out[i] = sorted[i].key;
+        }
+        if (klens_out) {
+            klens_out[i] = sorted[i].klen;
+        }
+        if (vals_out) {
+            vals_out[i] = sorted[i].val;
+        }
+    }
+    free(entries);
+    *count = n;
+    return true;
+}
+
+/*
+ * Copy up to cap entries into the given arrays, ordered by key using cmp,
+ * or by hash value if cmp is NULL; any of the output arrays may be NULL.
+ *
+ * => When cap is smaller than the number of entries, the first cap entries
+ *    of the sorted order are exported.
+ * => The number of exported entries is stored in *count.
+ * => Return false on allocation failure, with *count set to 0.
+ */
+bool robin_table_export_sorted(const robin_table_t* rt, const void** keys_out,
+                               size_t* klens_out, void** vals_out, size_t cap,
+                               int (*cmp)(const void* key1, size_t klen1,
+                                          const void* key2, size_t klen2),
+                               size_t* count)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(count != NULL);
+
+    return robin_table_export_sorted_pool(NULL, rt, keys_out, klens_out, vals_out, cap, cmp,
+                                          count);
+}
+
+/*
+ * Same as robin_table_export_sorted, but the threads of the pool sort runs of
+ * entries in parallel before the calling thread merges them.
+ *
+ * => The final merge passes run on the calling thread alone, so the speedup
+ *    is largest for expensive comparators.
+ * => The hash table must not be modified during the call.
+ */
+bool robin_table_export_sorted_parallel(robin_table_pool_t* pool, const robin_table_t* rt,
+                                        const void** keys_out, size_t* klens_out,
+                                        void** vals_out, size_t cap,
+                                        int (*cmp)(const void* key1, size_t klen1,
+                                                   const void* key2, size_t klen2),
+                                        size_t* count)
+{
+    RT_ASSERT(pool != NULL);
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(count != NULL);
 
-    robin_table_iter_impl_t* iter_impl = (robin_table_iter_impl_t*)iter;
-    free(iter_impl);
+    return robin_table_export_sorted_pool(pool, rt, keys_out, klens_out, vals_out, cap, cmp,
+                                          count);
 }
 
 /*
@@ -0,0 +1,347 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/*
+ * A slot packs the index of its entry plus one into the low 32 bits (zero if
+ * the slot is empty) and the low 32 bits of the hash value into the high
+ * ones, so that probing can compute distances without touching the entries.
+ */
+#define RT_SLOT_ENTRY(slot)       ((uint32_t)(slot))
+#define RT_SLOT_HASH(slot)        ((uint32_t)((slot) >> 32))
+#define RT_SLOT_MAKE(entry, hash) (((uint64_t)(uint32_t)(hash) << 32) | (uint32_t)(entry))
+
+/*
+ * The head of the list of handed-back entries packs the index of the first
+ * entry plus one (zero if the list is empty) into the low 32 bits and a tag,
+ * bumped on every change against ABA, into the high ones.
+ */
+#define RT_FREE_ENTRY(head)       ((uint32_t)(head))
+#define RT_FREE_TAG(head)         ((uint32_t)((head) >> 32))
+#define RT_FREE_MAKE(entry, tag)  (((uint64_t)(uint32_t)(tag) << 32) | (uint32_t)(entry))
+
+typedef struct {
+    const void* key;
+    void* val;
+    size_t klen;
+    uint64_t hash;
+    uint32_t next_free;            /* Next handed-back entry plus one, or 0 */
+} robin_build_entry_t;
+
+struct robin_table_builder_t {
+    robin_table_t* rt;             /* Returned by robin_table_freeze */
+    uint64_t* slots;
+    robin_build_entry_t* entries;
+    size_t capacity;               /* Maximum number of entries */
+    size_t next;                   /* Next never used entry */
+    uint64_t free_head;            /* Entries handed back by duplicate keys */
+};
+
+/*
+ * Construct a builder that lets many threads insert into a hash table at
+ * the same time, sized for the given number of entries.
+ *
+ * => At most as many entries as fit below the maximum load factor of the
+ *    resulting hash table can be added, and fewer than 2^32.
+ */
+robin_table_builder_t* robin_table_builder_create(size_t count,
+                                                  uint64_t (*hash_func)(const void*, size_t,
+                                                                        uint64_t),
+                                                  uint64_t seed)
+{
+    robin_table_builder_t* rb;
+
+    rb = malloc(sizeof(robin_table_builder_t));
+    if (!rb) {
+        return NULL;
+    }
+
+    rb->rt = robin_table_create(count, hash_func, seed);
+    if (!rb->rt) {
+        free(rb);
+        return NULL;
+    }
+    /* Slots hold 32 bits of the hash value and of the entry index */
+    if (rb->rt->mask > UINT32_MAX) {
+        robin_table_destroy(rb->rt);
+        free(rb);
+        return NULL;
+    }
+    rb->capacity = rb->rt->expand_at;
+    if (rb->capacity >= UINT32_MAX) {
+        rb->capacity = UINT32_MAX - 1;
+    }
+    rb->next = 0;
+    rb->free_head = 0;
+
+    rb->slots = calloc(rb->rt->bucket_count, sizeof(uint64_t));
+    rb->entries = malloc(rb->capacity * sizeof(robin_build_entry_t));
+    if (!rb->slots || !rb->entries) {
+        robin_table_builder_destroy(rb);
+        return NULL;
+    }
+    return rb;
+}
+
+/*
+ * Free the memory associated with a builder that was not frozen.
+ */
+void robin_table_builder_destroy(robin_table_builder_t* rb)
+{
+    if (!rb) {
+        return;
+    }
+
+    robin_table_destroy(rb->rt);
+    free(rb->slots);
+    free(rb->entries);
+    free(rb);
+}
+
+/*
+ * Reserve an entry: a handed-back one if there is any, otherwise the next
+ * one never used.
+ *
+ * => Return the index of the entry, or SIZE_MAX if the builder is full.
+ */
+static size_t robin_build_reserve(robin_table_builder_t* rb)
+{
+    uint64_t head = __atomic_load_n(&rb->free_head, __ATOMIC_ACQUIRE);
+    size_t index;
+
+    while (RT_FREE_ENTRY(head)) {
+        const size_t first = RT_FREE_ENTRY(head) - 1;
+        const uint32_t next = __atomic_load_n(&rb->entries[first].next_free, __ATOMIC_RELAXED);
+
+        if (__atomic_compare_exchange_n(&rb->free_head, &head,
+                                        RT_FREE_MAKE(next, RT_FREE_TAG(head) + 1), false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            return first;
+        }
+    }
+
+    index = __atomic_fetch_add(&rb->next, 1, __ATOMIC_RELAXED);
+    return index < rb->capacity ? index : SIZE_MAX;
+}
+
+/*
+ * Hand back an entry that was reserved but never published in a slot.
+ */
+static void robin_build_release(robin_table_builder_t* rb, size_t index)
+{
+    size_t next = index + 1;
+    uint64_t head;
+
+    /* Usually no other entry was reserved since */
+    if (__atomic_compare_exchange_n(&rb->next, &next, index, false, __ATOMIC_RELAXED,
+                                    __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    head = __atomic_load_n(&rb->free_head, __ATOMIC_RELAXED);
+    do {
+        __atomic_store_n(&rb->entries[index].next_free, RT_FREE_ENTRY(head),
+                         __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&rb->free_head, &head,
+                                          RT_FREE_MAKE(index + 1, RT_FREE_TAG(head) + 1),
+                                          false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*
+ * Add a new entry; safe to call from many threads at once without locking.
+ *
+ * => Empty slots are claimed with a CAS, and richer entries are displaced
+ *    by swapping the slot atomically and carrying the displaced entry on.
+ * => An entry is only reserved when the key is about to be published in a
+ *    slot, and handed back if a CAS race reveals the key was added by
+ *    another thread, so adding existing keys never uses up capacity.
+ * => Return the value of an existing entry with the same key, the given
+ *    value on success, or NULL if the builder is full.
+ * => If two threads add the same key at the same time, both calls may
+ *    succeed; robin_table_freeze keeps only one of the entries.
+ */
+void* robin_table_builder_put(robin_table_builder_t* rb, const void* key, size_t klen,
+                              void* val)
+{
+    RT_ASSERT(rb != NULL);
+    RT_ASSERT(key != NULL);
+    RT_ASSERT(val != NULL);
+
+    const uint64_t hash = rb->rt->hash_func(key, klen, rb->rt->seed);
+    const size_t mask = rb->rt->mask;
+    size_t index = SIZE_MAX;  /* Entry of the key, once reserved */
+    size_t idx = hash & mask;
+    uint64_t slot = 0;
+    bool own = true;   /* Carrying our own entry, not a displaced one */
+
+    for (size_t psl = 0;;) {
+        uint64_t cur = __atomic_load_n(&rb->slots[idx], __ATOMIC_ACQUIRE);
+        size_t cur_psl = 0;
+
+        if (cur && own && RT_SLOT_HASH(cur) == (uint32_t)hash) {
+            const robin_build_entry_t* other = rb->entries + RT_SLOT_ENTRY(cur) - 1;
+
+            if (other->hash == hash && other->klen == klen &&
+                memcmp(other->key, key, klen) == 0) {
+                if (index != SIZE_MAX) {
+                    robin_build_release(rb, index);
+                }
+                return other->val;
+            }
+        }
+
+        if (cur) {
+            cur_psl = (idx - RT_SLOT_HASH(cur)) & mask;
+        }
+        if (!cur || cur_psl < psl) {
+            if (index == SIZE_MAX) {
+                robin_build_entry_t* entry;
+
+                index = robin_build_reserve(rb);
+                if (index == SIZE_MAX) {
+                    return NULL;
+                }
+                entry = rb->entries + index;
+                entry->key = key;
+                entry->val = val;
+                entry->klen = klen;
+                entry->hash = hash;
+                slot = RT_SLOT_MAKE(index + 1, hash);
+            }
+
+            /*
+             * Claim the empty slot (slots never become empty again), or
+             * displace the richer entry and carry it on.
+             */
+            if (!__atomic_compare_exchange_n(&rb->slots[idx], &cur, slot, false,
+                                             __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                continue;
+            }
+            if (!cur) {
+                return val;
+            }
+            slot = cur;
+            psl = cur_psl;
+            own = false;
+        }
+
+        /* Advance to the next slot */
+        idx = (idx + 1) & mask;
+        ++psl;
+    }
+}
+
+/*
+ * Remove the entry in the given bucket with the backward shift method.
+ */
+static void robin_build_remove(robin_table_t* rt, size_t idx)
+{
+    robin_bucket_t* bucket = rt->buckets + idx;
+
+    while (1) {
+        robin_bucket_t* next_bucket;
+
+        idx = (idx + 1) & rt->mask;
+        next_bucket = rt->buckets + idx;
+
+        if (!next_bucket->key || next_bucket->psl == 0) {
+            memset(bucket, 0, sizeof(*bucket));
+            break;
+        }
+
+        --next_bucket->psl;
+        *bucket = *next_bucket;
+        bucket = next_bucket;
+    }
+    --rt->count;
+}
+
+/*
+ * Turn a builder into an ordinary hash table and free the builder.
+ *
+ * => All calls to robin_table_builder_put must have returned.
+ * => Entries with the same key added concurrently are merged into one.
+ */
+robin_table_t* robin_table_freeze(robin_table_builder_t* rb)
+{
+    RT_ASSERT(rb != NULL);
+
+    robin_table_t* rt = rb->rt;
+    size_t count = 0;
+
+    for (size_t idx = 0; idx < rt->bucket_count; ++idx) {
+        const uint64_t slot = rb->slots[idx];
+        const robin_build_entry_t* entry;
+        robin_bucket_t* bucket;
+
+        if (!slot) {
+            continue;
+        }
+        entry = rb->entries + RT_SLOT_ENTRY(slot) - 1;
+        bucket = rt->buckets + idx;
+        bucket->key = (void*)entry->key;
+        bucket->val = entry->val;
+        bucket->klen = entry->klen;
+        bucket->hash = entry->hash;
+        bucket->psl = (idx - entry->hash) & rt->mask;
+        ++count;
+    }
+    rt->count = count;
+
+    /*
+     * Duplicates share the home bucket, and entries with the same home bucket
+     * are adjacent; remove the later copies.
+     */
+    for (size_t idx = 0; idx < rt->bucket_count; ++idx) {
+        const robin_bucket_t* bucket = rt->buckets + idx;
+        size_t next = (idx + 1) & rt->mask;
+
+        for (size_t dist = 1; rt->buckets[next].key &&
+                              rt->buckets[next].psl == bucket->psl + dist;) {
+            const robin_bucket_t* other = rt->buckets + next;
+
+            if (other->hash == bucket->hash && other->klen == bucket->klen &&
+                memcmp(other->key, bucket->key, bucket->klen) == 0) {
+                robin_build_remove(rt, next);
+                continue;
+            }
+            next = (next + 1) & rt->mask;
+            ++dist;
+        }
+    }
+
+    free(rb->slots);
+    free(rb->entries);
+    free(rb);
+    return rt;
+}
@@ -0,0 +1,1033 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/* Size of a cache line, used to keep locks and counters apart */
+#define RT_CACHE_LINE_SIZE        64U
+
+/* Number of buckets guarded by one lock stripe; MUST be a power of two */
+#define RT_CT_STRIPE_SIZE         64U
+
+/* Bucket count MUST be a power of two and a multiple of the stripe size */
+#define RT_CT_BUCKET_COUNT_MIN    4096U
+
+/* Maximum number of threads that may use a concurrent hash table at once */
+#define RT_CT_MAX_THREADS         128U
+
+/* Maximum number of stripes a lock-free lookup validates before locking */
+#define RT_CT_READ_STRIPES        8U
+
+/* Number of spins before a waiting thread yields the processor */
+#define RT_CT_SPIN_LIMIT          128U
+
+typedef enum {
+    RT_CT_OK,
+    RT_CT_RETRY,     /* Lock order could not be kept, start over */
+    RT_CT_MIGRATED   /* The stripe was moved to a new bucket array */
+} robin_ct_status_t;
+
+typedef struct {
+    uint32_t lock;
+    uint32_t migrated;
+    uint64_t seq;    /* Odd while the stripe is being modified */
+} robin_ct_stripe_data_t;
+
+typedef union {
+    robin_ct_stripe_data_t data;
+    char pad[RT_CACHE_LINE_SIZE];
+} robin_ct_stripe_t;
+
+typedef struct robin_ct_array_t {
+    robin_bucket_t* buckets;
+    robin_ct_stripe_t* stripes;
+    size_t bucket_count;
+    size_t mask;
+    size_t stripe_count;
+    size_t expand_at;
+    int64_t count_batch;             /* Per-thread count delta before publishing */
+    struct robin_ct_array_t* next;   /* Bucket array being migrated into */
+    size_t migrate_next;             /* Next stripe to migrate */
+    size_t migrate_done;             /* Number of migrated stripes */
+} robin_ct_array_t;
+
+typedef struct {
+    robin_table_concurrent_t* ct;
+    uint32_t in_use;
+    uint64_t epoch;   /* Global epoch on entry with the low bit set, 0 if inactive */
+    int64_t delta;    /* Count changes not yet published */
+} robin_ct_thread_data_t;
+
+typedef union {
+    robin_ct_thread_data_t data;
+    char pad[RT_CACHE_LINE_SIZE];
+} robin_ct_thread_t;
+
+typedef struct robin_ct_retired_t {
+    struct robin_ct_retired_t* next;
+    robin_ct_array_t* arr;
+    uint64_t epoch;
+} robin_ct_retired_t;
+
+struct robin_table_concurrent_t {
+    robin_ct_thread_t threads[RT_CT_MAX_THREADS];
+    robin_ct_array_t* arr;
+    uint64_t seed;
+    uint64_t (*hash_func)(const void*, size_t, uint64_t);
+    pthread_key_t thread_key;
+    char pad0[RT_CACHE_LINE_SIZE];
+    int64_t count;
+    char pad1[RT_CACHE_LINE_SIZE];
+    uint64_t epoch;
+    pthread_mutex_t retire_lock;
+    robin_ct_retired_t* retired;
+};
+
+typedef struct {
+    robin_ct_array_t* arr;
+    size_t first;   /* First locked stripe */
+    size_t count;   /* Number of consecutive locked stripes */
+} robin_ct_locks_t;
+
+/*
+ * Acquire a spinlock, yielding the processor if it is held for long.
+ */
+static inline void robin_ct_spin_lock(uint32_t* lock)
+{
+    unsigned spins = 0;
+
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED)) {
+            if (++spins >= RT_CT_SPIN_LIMIT) {
+                sched_yield();
+                spins = 0;
+            }
+        }
+    }
+}
+
+static inline bool robin_ct_spin_trylock(uint32_t* lock)
+{
+    return !__atomic_load_n(lock, __ATOMIC_RELAXED) &&
+           !__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE);
+}
+
+static inline void robin_ct_spin_unlock(uint32_t* lock)
+{
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Allocate an empty bucket array with its lock stripes.
+ */
+static robin_ct_array_t* robin_ct_array_create(size_t bucket_count)
+{
+    robin_ct_array_t* arr;
+    void* stripes;
+
+    arr = calloc(1, sizeof(robin_ct_array_t));
+    if (!arr) {
+        return NULL;
+    }
+    arr->bucket_count = bucket_count;
+    arr->mask = bucket_count - 1;
+    arr->stripe_count = bucket_count / RT_CT_STRIPE_SIZE;
+    arr->expand_at = (bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100;
+
+    /*
+     * Publish the count in batches small enough that all threads together
+     * can never overshoot the maximum load factor by more than half of the
+     * remaining free buckets.
+     */
+    arr->count_batch = (int64_t)(bucket_count / (8 * RT_CT_MAX_THREADS));
+    if (arr->count_batch < 1) {
+        arr->count_batch = 1;
+    } else if (arr->count_batch > 256) {
+        arr->count_batch = 256;
+    }
+
+    arr->buckets = calloc(bucket_count, sizeof(robin_bucket_t));
+    if (!arr->buckets ||
+        posix_memalign(&stripes, RT_CACHE_LINE_SIZE,
+                       arr->stripe_count * sizeof(robin_ct_stripe_t))) {
+        free(arr->buckets);
+        free(arr);
+        return NULL;
+    }
+    arr->stripes = stripes;
+    memset(arr->stripes, 0, arr->stripe_count * sizeof(robin_ct_stripe_t));
+    return arr;
+}
+
+static void robin_ct_array_destroy(robin_ct_array_t* arr)
+{
+    if (!arr) {
+        return;
+    }
+
+    free(arr->buckets);
+    free(arr->stripes);
+    free(arr);
+}
+
+/*
+ * Lock the stripe that follows the already locked ones.
+ *
+ * => Stripes are locked in ascending order; when the range wraps around the
+ *    end of the bucket array, only a trylock is attempted to avoid deadlocks.
+ */
+static robin_ct_status_t robin_ct_lock_next(robin_ct_locks_t* locks)
+{
+    const size_t s = (locks->first + locks->count) & (locks->arr->stripe_count - 1);
+    robin_ct_stripe_data_t* stripe = &locks->arr->stripes[s].data;
+
+    RT_ASSERT(locks->count < locks->arr->stripe_count);
+
+    if (locks->count && s < locks->first) {
+        if (!robin_ct_spin_trylock(&stripe->lock)) {
+            return RT_CT_RETRY;
+        }
+    } else {
+        robin_ct_spin_lock(&stripe->lock);
+    }
+
+    if (__atomic_load_n(&stripe->migrated, __ATOMIC_ACQUIRE)) {
+        robin_ct_spin_unlock(&stripe->lock);
+        return RT_CT_MIGRATED;
+    }
+
+    ++locks->count;
+    return RT_CT_OK;
+}
+
+/*
+ * Make sure the stripe holding the given bucket is locked.
+ */
+static inline robin_ct_status_t robin_ct_lock_bucket(robin_ct_locks_t* locks, size_t idx)
+{
+    const size_t s = idx / RT_CT_STRIPE_SIZE;
+
+    if (((locks->first + locks->count - 1) & (locks->arr->stripe_count - 1)) == s) {
+        return RT_CT_OK;
+    }
+    return robin_ct_lock_next(locks);
+}
+
+/*
+ * Mark the locked stripes as being modified (odd) or stable again (even).
+ */
+static void robin_ct_bump_seq(robin_ct_locks_t* locks, bool begin)
+{
+    for (size_t i = 0; i < locks->count; ++i) {
+        const size_t s = (locks->first + i) & (locks->arr->stripe_count - 1);
+        robin_ct_stripe_data_t* stripe = &locks->arr->stripes[s].data;
+
+        if (begin) {
+            __atomic_store_n(&stripe->seq, stripe->seq + 1, __ATOMIC_RELAXED);
+        } else {
+            __atomic_store_n(&stripe->seq, stripe->seq + 1, __ATOMIC_RELEASE);
+        }
+    }
+    if (begin) {
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+}
+
+static void robin_ct_unlock_all(robin_ct_locks_t* locks)
+{
+    for (size_t i = 0; i < locks->count; ++i) {
+        const size_t s = (locks->first + i) & (locks->arr->stripe_count - 1);
+        robin_ct_spin_unlock(&locks->arr->stripes[s].data.lock);
+    }
+    locks->count = 0;
+}
+
+/*
+ * Lock the stripe of the home bucket and probe for the key, locking every
+ * stripe before reading from it.
+ *
+ * => On RT_CT_OK, *found is the matching bucket or NULL, and *end is the
+ *    index of the bucket at which the probe stopped.
+ */
+static robin_ct_status_t robin_ct_probe_locked(robin_ct_locks_t* locks, const void* key,
+                                               size_t klen, uint64_t hash,
+                                               robin_bucket_t** found, size_t* end)
+{
+    robin_ct_array_t* arr = locks->arr;
+    size_t idx = hash & arr->mask;
+    robin_ct_status_t status;
+
+    locks->first = idx / RT_CT_STRIPE_SIZE;
+    locks->count = 0;
+    *found = NULL;
+
+    status = robin_ct_lock_next(locks);
+    if (status != RT_CT_OK) {
+        return status;
+    }
+
+    for (size_t psl = 0;; ++psl) {
+        robin_bucket_t* bucket;
+
+        status = robin_ct_lock_bucket(locks, idx);
+        if (status != RT_CT_OK) {
+            robin_ct_unlock_all(locks);
+            return status;
+        }
+        bucket = arr->buckets + idx;
+
+        if (bucket->hash == hash && bucket->klen == klen &&
+            memcmp(bucket->key, key, klen) == 0) {
+            *found = bucket;
+            break;
+        }
+        if (!bucket->key || bucket->psl < psl) {
+            break;
+        }
+
+        /* Advance to the next bucket */
+        idx = (idx + 1) & arr->mask;
+    }
+
+    *end = idx;
+    return RT_CT_OK;
+}
+
+/*
+ * Extend the locked range up to the first empty bucket at or after idx.
+ */
+static robin_ct_status_t robin_ct_lock_until_empty(robin_ct_locks_t* locks, size_t idx)
+{
+    robin_ct_status_t status;
+
+    while (1) {
+        status = robin_ct_lock_bucket(locks, idx);
+        if (status != RT_CT_OK) {
+            robin_ct_unlock_all(locks);
+            return status;
+        }
+        if (!locks->arr->buckets[idx].key) {
+            return RT_CT_OK;
+        }
+        idx = (idx + 1) & locks->arr->mask;
+    }
+}
+
+/*
+ * Store an entry into a bucket; lock-free readers load the fields while
+ * they are written, so every field is stored atomically.
+ */
+static inline void robin_ct_store(robin_bucket_t* bucket, const robin_bucket_t* src)
+{
+    __atomic_store_n(&bucket->key, src->key, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket->val, src->val, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket->psl, src->psl, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket->klen, src->klen, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket->hash, src->hash, __ATOMIC_RELAXED);
+}
+
+/*
+ * Insert an entry with the Robin Hood method; all buckets up to the first
+ * empty bucket after its home bucket must be locked by the caller.
+ */
+static void robin_ct_insert(robin_ct_array_t* arr, const void* key, size_t klen,
+                            uint64_t hash, void* val)
+{
+    size_t idx = hash & arr->mask;
+    robin_bucket_t entry;
+
+    entry.key = (void*)key;
+    entry.val = val;
+    entry.klen = klen;
+    entry.hash = hash;
+    entry.psl = 0;
+
+    while (1) {
+        robin_bucket_t* bucket = arr->buckets + idx;
+
+        if (!bucket->key) {
+            robin_ct_store(bucket, &entry);
+            return;
+        }
+
+        if (bucket->psl < entry.psl) {
+            robin_bucket_t temp;
+            temp = *bucket;
+            robin_ct_store(bucket, &entry);
+            entry = temp;
+        }
+
+        idx = (idx + 1) & arr->mask;
+        ++entry.psl;
+    }
+}
+
+/*
+ * Attempt to add an entry to the given bucket array.
+ */
+static robin_ct_status_t robin_ct_put0(robin_ct_array_t* arr, const void* key, size_t klen,
+                                       uint64_t hash, void** val, bool* inserted)
+{
+    robin_ct_locks_t locks = {arr, 0, 0};
+    robin_bucket_t* found;
+    robin_ct_status_t status;
+    size_t end;
+
+    status = robin_ct_probe_locked(&locks, key, klen, hash, &found, &end);
+    if (status != RT_CT_OK) {
+        return status;
+    }
+
+    /* Duplicate key: do not overwrite existing value */
+    if (found) {
+        *val = found->val;
+        *inserted = false;
+        robin_ct_unlock_all(&locks);
+        return RT_CT_OK;
+    }
+
+    status = robin_ct_lock_until_empty(&locks, end);
+    if (status != RT_CT_OK) {
+        return status;
+    }
+
+    robin_ct_bump_seq(&locks, true);
+    robin_ct_insert(arr, key, klen, hash, *val);
+    robin_ct_bump_seq(&locks, false);
+    robin_ct_unlock_all(&locks);
+    *inserted = true;
+    return RT_CT_OK;
+}
+
+/*
+ * Attempt to remove an entry from the given bucket array.
+ */
+static robin_ct_status_t robin_ct_del0(robin_ct_array_t* arr, const void* key, size_t klen,
+                                       uint64_t hash, void** val)
+{
+    robin_ct_locks_t locks = {arr, 0, 0};
+    robin_bucket_t* bucket;
+    robin_ct_status_t status;
+    size_t idx;
+
+    status = robin_ct_probe_locked(&locks, key, klen, hash, &bucket, &idx);
+    if (status != RT_CT_OK) {
+        return status;
+    }
+
+    if (!bucket) {
+        *val = NULL;
+        robin_ct_unlock_all(&locks);
+        return RT_CT_OK;
+    }
+    *val = bucket->val;
+
+    /* Lock the whole range the backward shift will touch */
+    for (size_t next = (idx + 1) & arr->mask;; next = (next + 1) & arr->mask) {
+        status = robin_ct_lock_bucket(&locks, next);
+        if (status != RT_CT_OK) {
+            robin_ct_unlock_all(&locks);
+            return status;
+        }
+        if (!arr->buckets[next].key || arr->buckets[next].psl == 0) {
+            break;
+        }
+    }
+
+    robin_ct_bump_seq(&locks, true);
+
+    /* Apply the backward shift method */
+    while (1) {
+        static const robin_bucket_t empty;
+        robin_bucket_t* next_bucket;
+        robin_bucket_t entry;
+
+        idx = (idx + 1) & arr->mask;
+        next_bucket = arr->buckets + idx;
+
+        if (!next_bucket->key || next_bucket->psl == 0) {
+            robin_ct_store(bucket, &empty);
+            break;
+        }
+
+        entry = *next_bucket;
+        --entry.psl;
+        robin_ct_store(bucket, &entry);
+        bucket = next_bucket;
+    }
+
+    robin_ct_bump_seq(&locks, false);
+    robin_ct_unlock_all(&locks);
+    return RT_CT_OK;
+}
+
+/*
+ * Look up a key with its probe stripes locked.
+ */
+static robin_ct_status_t robin_ct_get_locked(robin_ct_array_t* arr, const void* key,
+                                             size_t klen, uint64_t hash, void** val)
+{
+    robin_ct_locks_t locks = {arr, 0, 0};
+    robin_bucket_t* bucket;
+    robin_ct_status_t status;
+    size_t end;
+
+    status = robin_ct_probe_locked(&locks, key, klen, hash, &bucket, &end);
+    if (status != RT_CT_OK) {
+        return status;
+    }
+    *val = bucket ? bucket->val : NULL;
+    robin_ct_unlock_all(&locks);
+    return RT_CT_OK;
+}
+
+/*
+ * Attempt a lock-free lookup, validating the sequence counters of every
+ * stripe the probe read from.
+ */
+static robin_ct_status_t robin_ct_get0(robin_ct_array_t* arr, const void* key, size_t klen,
+                                       uint64_t hash, void** val)
+{
+    const robin_ct_stripe_data_t* stripes[RT_CT_READ_STRIPES];
+    uint64_t seqs[RT_CT_READ_STRIPES];
+    size_t nstripes = 0;
+    size_t idx = hash & arr->mask;
+
+    *val = NULL;
+
+    for (size_t psl = 0; psl <= arr->mask; ++psl) {
+        const robin_bucket_t* bucket = arr->buckets + idx;
+        const void* bkey;
+        bool match;
+
+        /* Record the sequence counter of every stripe before reading it */
+        if (psl == 0 || idx % RT_CT_STRIPE_SIZE == 0) {
+            const robin_ct_stripe_data_t* stripe = &arr->stripes[idx / RT_CT_STRIPE_SIZE].data;
+
+            /* Unusually long probe: fall back to locking the stripes */
+            if (nstripes == RT_CT_READ_STRIPES) {
+                return robin_ct_get_locked(arr, key, klen, hash, val);
+            }
+            seqs[nstripes] = __atomic_load_n(&stripe->seq, __ATOMIC_ACQUIRE);
+            if (seqs[nstripes] & 1) {
+                return RT_CT_RETRY;
+            }
+            stripes[nstripes++] = stripe;
+        }
+
+        bkey = __atomic_load_n(&bucket->key, __ATOMIC_RELAXED);
+        match = bkey && __atomic_load_n(&bucket->hash, __ATOMIC_RELAXED) == hash &&
+                __atomic_load_n(&bucket->klen, __ATOMIC_RELAXED) == klen;
+
+        if (match || !bkey || __atomic_load_n(&bucket->psl, __ATOMIC_RELAXED) < psl) {
+            void* bval = __atomic_load_n(&bucket->val, __ATOMIC_RELAXED);
+
+            /* Validate before dereferencing the stored key */
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            for (size_t i = 0; i < nstripes; ++i) {
+                if (__atomic_load_n(&stripes[i]->seq, __ATOMIC_RELAXED) != seqs[i]) {
+                    return RT_CT_RETRY;
+                }
+            }
+            if (!match) {
+                return RT_CT_OK;
+            }
+            if (memcmp(bkey, key, klen) == 0) {
+                *val = bval;
+                return RT_CT_OK;
+            }
+        }
+
+        /* Advance to the next bucket */
+        idx = (idx + 1) & arr->mask;
+    }
+    return RT_CT_RETRY;
+}
+
+/*
+ * Return the calling thread's slot, registering the thread on first use.
+ *
+ * => Return NULL if RT_CT_MAX_THREADS threads are already registered.
+ */
+static robin_ct_thread_data_t* robin_ct_thread(robin_table_concurrent_t* ct)
+{
+    robin_ct_thread_data_t* thread = pthread_getspecific(ct->thread_key);
+
+    if (thread) {
+        return thread;
+    }
+
+    for (size_t i = 0; i < RT_CT_MAX_THREADS; ++i) {
+        uint32_t expected = 0;
+
+        thread = &ct->threads[i].data;
+        if (__atomic_compare_exchange_n(&thread->in_use, &expected, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            if (pthread_setspecific(ct->thread_key, thread)) {
+                __atomic_store_n(&thread->in_use, 0, __ATOMIC_RELEASE);
+                return NULL;
+            }
+            return thread;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Release the slot of an exiting thread, publishing its count changes.
+ */
+static void robin_ct_thread_exit(void* arg)
+{
+    robin_ct_thread_data_t* thread = arg;
+
+    __atomic_fetch_add(&thread->ct->count, thread->delta, __ATOMIC_RELAXED);
+    __atomic_store_n(&thread->delta, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&thread->epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&thread->in_use, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Enter and leave an epoch-protected critical section; bucket arrays loaded
+ * inside one stay valid until it is left.
+ */
+static inline void robin_ct_enter(robin_table_concurrent_t* ct, robin_ct_thread_data_t* thread)
+{
+    __atomic_store_n(&thread->epoch, __atomic_load_n(&ct->epoch, __ATOMIC_RELAXED) | 1,
+                     __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void robin_ct_leave(robin_ct_thread_data_t* thread)
+{
+    __atomic_store_n(&thread->epoch, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Free the retired bucket arrays no thread can still be reading.
+ *
+ * => The retire lock must be held.
+ */
+static void robin_ct_collect(robin_table_concurrent_t* ct)
+{
+    robin_ct_retired_t** link = &ct->retired;
+    uint64_t min_epoch = UINT64_MAX;
+
+    for (size_t i = 0; i < RT_CT_MAX_THREADS; ++i) {
+        const uint64_t epoch = __atomic_load_n(&ct->threads[i].data.epoch, __ATOMIC_SEQ_CST);
+
+        if ((epoch & 1) && (epoch & ~(uint64_t)1) < min_epoch) {
+            min_epoch = epoch & ~(uint64_t)1;
+        }
+    }
+
+    while (*link) {
+        robin_ct_retired_t* retired = *link;
+
+        if (retired->epoch < min_epoch) {
+            *link = retired->next;
+            robin_ct_array_destroy(retired->arr);
+            free(retired);
+        } else {
+            link = &retired->next;
+        }
+    }
+}
+
+/*
+ * Retire a bucket array replaced by a resize and advance the global epoch.
+ */
+static void robin_ct_retire(robin_table_concurrent_t* ct, robin_ct_array_t* arr)
+{
+    robin_ct_retired_t* retired = malloc(sizeof(robin_ct_retired_t));
+
+    pthread_mutex_lock(&ct->retire_lock);
+    if (retired) {
+        retired->arr = arr;
+        retired->epoch = __atomic_load_n(&ct->epoch, __ATOMIC_SEQ_CST);
+        retired->next = ct->retired;
+        ct->retired = retired;
+    }
+    __atomic_fetch_add(&ct->epoch, 2, __ATOMIC_SEQ_CST);
+    robin_ct_collect(ct);
+    pthread_mutex_unlock(&ct->retire_lock);
+
+    /*
+     * Without memory for the list node the old array has to be leaked;
+     * freeing it here could pull it from under a concurrent reader.
+     */
+}
+
+/*
+ * Move the entries of one stripe of the old bucket array into the new one.
+ */
+static void robin_ct_migrate_stripe(robin_ct_array_t* arr, robin_ct_array_t* next, size_t s)
+{
+    robin_ct_stripe_data_t* stripe = &arr->stripes[s].data;
+
+    /*
+     * Once flagged, writers abort on this stripe and retry on the new array,
+     * so its entries can be copied without holding the lock.
+     */
+    robin_ct_spin_lock(&stripe->lock);
+    __atomic_store_n(&stripe->migrated, 1, __ATOMIC_RELEASE);
+    robin_ct_spin_unlock(&stripe->lock);
+
+    for (size_t idx = s * RT_CT_STRIPE_SIZE; idx < (s + 1) * RT_CT_STRIPE_SIZE; ++idx) {
+        const robin_bucket_t* bucket = arr->buckets + idx;
+        void* val = bucket->val;
+        bool inserted;
+
+        if (!bucket->key) {
+            continue;
+        }
+        while (robin_ct_put0(next, bucket->key, bucket->klen, bucket->hash, &val,
+                             &inserted) != RT_CT_OK) {
+            val = bucket->val;
+        }
+        RT_ASSERT(inserted);
+    }
+}
+
+/*
+ * Help with a resize in progress: claim and migrate stripes until none are
+ * left, wait for the other helpers, and publish the new bucket array.
+ */
+static void robin_ct_help_resize(robin_table_concurrent_t* ct, robin_ct_array_t* arr)
+{
+    robin_ct_array_t* next = __atomic_load_n(&arr->next, __ATOMIC_ACQUIRE);
+    robin_ct_array_t* expected = arr;
+    size_t s;
+    unsigned spins = 0;
+
+    while ((s = __atomic_fetch_add(&arr->migrate_next, 1, __ATOMIC_RELAXED)) <
+           arr->stripe_count) {
+        robin_ct_migrate_stripe(arr, next, s);
+        __atomic_fetch_add(&arr->migrate_done, 1, __ATOMIC_RELEASE);
+    }
+
+    while (__atomic_load_n(&arr->migrate_done, __ATOMIC_ACQUIRE) < arr->stripe_count) {
+        if (++spins >= RT_CT_SPIN_LIMIT) {
+            sched_yield();
+            spins = 0;
+        }
+    }
+
+    /* Exactly one helper publishes the new array and retires the old one */
+    if (__atomic_compare_exchange_n(&ct->arr, &expected, next, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        robin_ct_retire(ct, arr);
+    }
+}
+
+/*
+ * Start doubling the bucket array, unless another thread already did.
+ */
+static void robin_ct_start_resize(robin_ct_array_t* arr)
+{
+    robin_ct_array_t* next = NULL;
+    robin_ct_array_t* new_arr;
+
+    if (__atomic_load_n(&arr->next, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    new_arr = robin_ct_array_create(arr->bucket_count << 1);
+    if (!new_arr) {
+        /* Keep going at a higher load factor */
+        return;
+    }
+    if (!__atomic_compare_exchange_n(&arr->next, &next, new_arr, false,
+                                     __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+        robin_ct_array_destroy(new_arr);
+    }
+}
+
+/*
+ * Record a change of the entry count, publishing it in batches; returns true
+ * if the published count crossed the expansion threshold.
+ */
+static bool robin_ct_count(robin_table_concurrent_t* ct, robin_ct_thread_data_t* thread,
+                           const robin_ct_array_t* arr, int64_t change)
+{
+    const int64_t delta = thread->delta + change;
+    int64_t count;
+
+    /* The delta is read by robin_table_concurrent_count from other threads */
+    if (delta < arr->count_batch && delta > -arr->count_batch) {
+        __atomic_store_n(&thread->delta, delta, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    count = __atomic_add_fetch(&ct->count, delta, __ATOMIC_RELAXED);
+    __atomic_store_n(&thread->delta, 0, __ATOMIC_RELAXED);
+    return count >= (int64_t)arr->expand_at;
+}
+
+/*
+ * Construct a new concurrent hash table, sized for the given number of
+ * entries.
+ *
+ * => Up to 128 (RT_CT_MAX_THREADS) threads may use the table at the same
+ *    time; a thread that exits frees its slot for another one.
+ */
+robin_table_concurrent_t* robin_table_concurrent_create(size_t count,
+                                                        uint64_t (*hash_func)(const void*,
+                                                                              size_t,
+                                                                              uint64_t),
+                                                        uint64_t seed)
+{
+    robin_table_concurrent_t* ct;
+    size_t bucket_count = RT_CT_BUCKET_COUNT_MIN;
+    void* mem;
+
+    if (posix_memalign(&mem, RT_CACHE_LINE_SIZE, sizeof(robin_table_concurrent_t))) {
+        return NULL;
+    }
+    ct = mem;
+    memset(ct, 0, sizeof(*ct));
+
+    while ((bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100 < count) {
+        bucket_count <<= 1;
+    }
+
+    for (size_t i = 0; i < RT_CT_MAX_THREADS; ++i) {
+        ct->threads[i].data.ct = ct;
+    }
+    ct->hash_func = hash_func ? hash_func : RT_HASH_FUNC_DEFAULT;
+    ct->seed = seed;
+    ct->epoch = 2;
+
+    ct->arr = robin_ct_array_create(bucket_count);
+    if (!ct->arr) {
+        free(ct);
+        return NULL;
+    }
+    if (pthread_key_create(&ct->thread_key, robin_ct_thread_exit)) {
+        robin_ct_array_destroy(ct->arr);
+        free(ct);
+        return NULL;
+    }
+    if (pthread_mutex_init(&ct->retire_lock, NULL)) {
+        pthread_key_delete(ct->thread_key);
+        robin_ct_array_destroy(ct->arr);
+        free(ct);
+        return NULL;
+    }
+    return ct;
+}
+
+/*
+ * Free the memory associated with the concurrent hash table.
+ *
+ * => No other thread may be using the table.
+ */
+void robin_table_concurrent_destroy(robin_table_concurrent_t* ct)
+{
+    if (!ct) {
+        return;
+    }
+
+    pthread_key_delete(ct->thread_key);
+    pthread_mutex_destroy(&ct->retire_lock);
+
+    while (ct->retired) {
+        robin_ct_retired_t* retired = ct->retired;
+        ct->retired = retired->next;
+        robin_ct_array_destroy(retired->arr);
+        free(retired);
+    }
+    if (ct->arr) {
+        robin_ct_array_destroy(ct->arr->next);
+    }
+    robin_ct_array_destroy(ct->arr);
+    free(ct);
+}
+
+/*
+ * Register the calling thread with the concurrent hash table, which the other
+ * operations otherwise do on first use.
+ *
+ * => Return false if 128 (RT_CT_MAX_THREADS) other threads are already
+ *    registered, in which case the calling thread MUST NOT use the table.
+ */
+bool robin_table_concurrent_register(robin_table_concurrent_t* ct)
+{
+    RT_ASSERT(ct != NULL);
+
+    return robin_ct_thread(ct) != NULL;
+}
+
+/*
+ * Add a new entry to the concurrent hash table, locking only the stripes
+ * covered by its probe.
+ *
+ * => Same semantics as robin_table_put.
+ * => The calling thread MUST be registered or able to register; see
+ *    robin_table_concurrent_register.
+ */
+void* robin_table_concurrent_put(robin_table_concurrent_t* ct, const void* key, size_t klen,
+                                 void* val)
+{
+    RT_ASSERT(ct != NULL);
+    RT_ASSERT(key != NULL);
+    RT_ASSERT(val != NULL);
+
+    const uint64_t hash = ct->hash_func(key, klen, ct->seed);
+    robin_ct_thread_data_t* thread = robin_ct_thread(ct);
+    bool inserted = false;
+
+    /* More than RT_CT_MAX_THREADS threads use the table */
+    RT_ASSERT(thread != NULL);
+    if (!thread) {
+        return NULL;
+    }
+
+    robin_ct_enter(ct, thread);
+    while (1) {
+        robin_ct_array_t* arr = __atomic_load_n(&ct->arr, __ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&arr->next, __ATOMIC_ACQUIRE)) {
+            robin_ct_help_resize(ct, arr);
+            continue;
+        }
+        if (robin_ct_put0(arr, key, klen, hash, &val, &inserted) != RT_CT_OK) {
+            continue;
+        }
+        if (inserted && robin_ct_count(ct, thread, arr, 1)) {
+            robin_ct_start_resize(arr);
+            if (__atomic_load_n(&arr->next, __ATOMIC_ACQUIRE)) {
+                robin_ct_help_resize(ct, arr);
+            }
+        }
+        break;
+    }
+    robin_ct_leave(thread);
+    return val;
+}
+
+/*
+ * Retrieve the value associated with a given key, or NULL if no entry exists.
+ *
+ * => Lock-free: the probe is validated against the stripe sequence counters
+ *    and retried if a writer changed any of them.
+ * => The calling thread MUST be registered or able to register; see
+ *    robin_table_concurrent_register.
+ */
+void* robin_table_concurrent_get(robin_table_concurrent_t* ct, const void* key, size_t klen)
+{
+    RT_ASSERT(ct != NULL);
+
+    const uint64_t hash = ct->hash_func(key, klen, ct->seed);
+    robin_ct_thread_data_t* thread = robin_ct_thread(ct);
+    void* val = NULL;
+
+    /* More than RT_CT_MAX_THREADS threads use the table */
+    RT_ASSERT(thread != NULL);
+    if (!thread) {
+        return NULL;
+    }
+
+    robin_ct_enter(ct, thread);
+    while (1) {
+        robin_ct_array_t* arr = __atomic_load_n(&ct->arr, __ATOMIC_ACQUIRE);
+
+        /* A completed resize may have made arr stale while it was read */
+        if (robin_ct_get0(arr, key, klen, hash, &val) == RT_CT_OK &&
+            __atomic_load_n(&ct->arr, __ATOMIC_ACQUIRE) == arr) {
+            break;
+        }
+    }
+    robin_ct_leave(thread);
+    return val;
+}
+
+/*
+ * Remove an entry with the specified key from the concurrent hash table.
+ *
+ * => Return the associated value, or NULL, if the entry is not found.
+ * => The bucket array is never shrunk.
+ * => The calling thread MUST be registered or able to register; see
+ *    robin_table_concurrent_register.
+ */
+void* robin_table_concurrent_del(robin_table_concurrent_t* ct, const void* key, size_t klen)
+{
+    RT_ASSERT(ct != NULL);
+
+    const uint64_t hash = ct->hash_func(key, klen, ct->seed);
+    robin_ct_thread_data_t* thread = robin_ct_thread(ct);
+    void* val = NULL;
+
+    /* More than RT_CT_MAX_THREADS threads use the table */
+    RT_ASSERT(thread != NULL);
+    if (!thread) {
+        return NULL;
+    }
+
+    robin_ct_enter(ct, thread);
+    while (1) {
+        robin_ct_array_t* arr = __atomic_load_n(&ct->arr, __ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&arr->next, __ATOMIC_ACQUIRE)) {
+            robin_ct_help_resize(ct, arr);
+            continue;
+        }
+        if (robin_ct_del0(arr, key, klen, hash, &val) != RT_CT_OK) {
+            continue;
+        }
+        if (val) {
+            robin_ct_count(ct, thread, arr, -1);
+        }
+        break;
+    }
+    robin_ct_leave(thread);
+    return val;
+}
+
+/*
+ * Return the number of entries in the concurrent hash table.
+ *
+ * => Exact when no other thread is modifying the table; otherwise, an
+ *    approximation.
+ */
+size_t robin_table_concurrent_count(robin_table_concurrent_t* ct)
+{
+    RT_ASSERT(ct != NULL);
+
+    int64_t count = __atomic_load_n(&ct->count, __ATOMIC_RELAXED);
+
+    for (size_t i = 0; i < RT_CT_MAX_THREADS; ++i) {
+        count += __atomic_load_n(&ct->threads[i].data.delta, __ATOMIC_RELAXED);
+    }
+    return count > 0 ? (size_t)count : 0;
+}
@@ -0,0 +1,340 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/* Size of a cache line, used to keep the publication slots apart */
+#define RT_CACHE_LINE_SIZE        64U
+
+/* Maximum number of threads with a publication slot */
+#define RT_FC_MAX_THREADS         128U
+
+/* Number of scans over the slots a combiner makes before unlocking */
+#define RT_FC_PASSES              4U
+
+/* Number of operations ahead to prefetch while combining */
+#define RT_PREFETCH_DISTANCE      8U
+
+/* Number of spins before a waiting thread yields the processor */
+#define RT_FC_SPIN_LIMIT          128U
+
+typedef enum {
+    RT_FC_EMPTY,
+    RT_FC_PENDING,
+    RT_FC_DONE
+} robin_fc_state_t;
+
+typedef enum {
+    RT_FC_PUT,
+    RT_FC_GET,
+    RT_FC_DEL
+} robin_fc_op_t;
+
+typedef struct {
+    uint32_t state;
+    uint32_t in_use;
+    robin_fc_op_t op;
+    const void* key;
+    size_t klen;
+    uint64_t hash;
+    void* val;        /* Argument of a put, then the result */
+} robin_fc_slot_data_t;
+
+typedef union {
+    robin_fc_slot_data_t data;
+    char pad[RT_CACHE_LINE_SIZE * ((sizeof(robin_fc_slot_data_t) + RT_CACHE_LINE_SIZE - 1) /
+                                   RT_CACHE_LINE_SIZE)];
+} robin_fc_slot_t;
+
+struct robin_table_fc_t {
+    robin_fc_slot_t slots[RT_FC_MAX_THREADS];
+    robin_table_t* rt;
+    pthread_mutex_t lock;          /* Held by the combiner */
+    pthread_key_t slot_key;
+    size_t slot_limit;             /* One past the highest slot ever used */
+};
+
+/*
+ * Return the publication slot of the calling thread, claiming a free one on
+ * first use.
+ *
+ * => Return NULL if all slots are taken.
+ */
+static robin_fc_slot_data_t* robin_fc_slot(robin_table_fc_t* fc)
+{
+    robin_fc_slot_data_t* slot = pthread_getspecific(fc->slot_key);
+
+    if (slot) {
+        return slot;
+    }
+
+    for (size_t i = 0; i < RT_FC_MAX_THREADS; ++i) {
+        uint32_t expected = 0;
+        size_t limit;
+
+        slot = &fc->slots[i].data;
+        if (__atomic_compare_exchange_n(&slot->in_use, &expected, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            if (pthread_setspecific(fc->slot_key, slot)) {
+                __atomic_store_n(&slot->in_use, 0, __ATOMIC_RELEASE);
+                return NULL;
+            }
+
+            /* Make the slot visible to combiners */
+            limit = __atomic_load_n(&fc->slot_limit, __ATOMIC_RELAXED);
+            while (limit < i + 1 &&
+                   !__atomic_compare_exchange_n(&fc->slot_limit, &limit, i + 1, false,
+                                                __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            }
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Release the slot of an exiting thread.
+ */
+static void robin_fc_slot_exit(void* arg)
+{
+    robin_fc_slot_data_t* slot = arg;
+
+    __atomic_store_n(&slot->in_use, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Apply a single operation to the hash table.
+ */
+static void* robin_fc_apply(robin_table_t* rt, robin_fc_op_t op, const void* key, size_t klen,
+                            uint64_t hash, void* val)
+{
+    switch (op) {
+    case RT_FC_PUT:
+        return robin_table_put_hashed(rt, key, klen, hash, val);
+    case RT_FC_GET:
+        return robin_table_get_hashed(rt, key, klen, hash);
+    case RT_FC_DEL:
+        return robin_table_del_hashed(rt, key, klen, hash);
+    }
+    return NULL;
+}
+
+/*
+ * Apply all pending operations as one batch; the combiner lock is held.
+ *
+ * => The operations were hashed by the publishing threads, so the combiner
+ *    only probes, prefetching home buckets a few operations ahead.
+ */
+static void robin_fc_combine(robin_table_fc_t* fc)
+{
+    robin_fc_slot_data_t* pending[RT_FC_MAX_THREADS];
+    robin_table_t* rt = fc->rt;
+
+    for (size_t pass = 0; pass < RT_FC_PASSES; ++pass) {
+        const size_t limit = __atomic_load_n(&fc->slot_limit, __ATOMIC_ACQUIRE);
+        size_t n = 0;
+
+        for (size_t i = 0; i < limit; ++i) {
+            robin_fc_slot_data_t* slot = &fc->slots[i].data;
+
+            if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) == RT_FC_PENDING) {
+                pending[n++] = slot;
+            }
+        }
+        if (!n) {
+            break;
+        }
+
+        for (size_t i = 0; i < n && i < RT_PREFETCH_DISTANCE; ++i) {
+            __builtin_prefetch(rt->buckets + (pending[i]->hash & rt->mask));
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            robin_fc_slot_data_t* slot = pending[i];
+
+            if (i + RT_PREFETCH_DISTANCE < n) {
+                const uint64_t hash = pending[i + RT_PREFETCH_DISTANCE]->hash;
+                __builtin_prefetch(rt->buckets + (hash & rt->mask));
+            }
+
+            slot->val = robin_fc_apply(rt, slot->op, slot->key, slot->klen, slot->hash,
+                                       slot->val);
+            __atomic_store_n(&slot->state, RT_FC_DONE, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+/*
+ * Publish an operation and wait until a combiner, possibly the calling
+ * thread itself, has applied it.
+ */
+static void* robin_fc_run(robin_table_fc_t* fc, robin_fc_op_t op, const void* key,
+                          size_t klen, void* val)
+{
+    const uint64_t hash = fc->rt->hash_func(key, klen, fc->rt->seed);
+    robin_fc_slot_data_t* slot = robin_fc_slot(fc);
+    unsigned spins = 0;
+
+    /* Without a slot, fall back to taking the lock for this operation */
+    if (!slot) {
+        pthread_mutex_lock(&fc->lock);
+        val = robin_fc_apply(fc->rt, op, key, klen, hash, val);
+        pthread_mutex_unlock(&fc->lock);
+        return val;
+    }
+
+    slot->op = op;
+    slot->key = key;
+    slot->klen = klen;
+    slot->hash = hash;
+    slot->val = val;
+    __atomic_store_n(&slot->state, RT_FC_PENDING, __ATOMIC_RELEASE);
+
+    while (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != RT_FC_DONE) {
+        if (pthread_mutex_trylock(&fc->lock) == 0) {
+            robin_fc_combine(fc);
+            pthread_mutex_unlock(&fc->lock);
+            continue;
+        }
+        if (++spins >= RT_FC_SPIN_LIMIT) {
+            sched_yield();
+            spins = 0;
+        }
+    }
+
+    val = slot->val;
+    __atomic_store_n(&slot->state, RT_FC_EMPTY, __ATOMIC_RELAXED);
+    return val;
+}
+
+/*
+ * Construct a new flat-combining hash table with the given number of entries.
+ */
+robin_table_fc_t* robin_table_fc_create(size_t count,
+                                        uint64_t (*hash_func)(const void*, size_t, uint64_t),
+                                        uint64_t seed)
+{
+    robin_table_fc_t* fc;
+    void* mem;
+
+    if (posix_memalign(&mem, RT_CACHE_LINE_SIZE, sizeof(robin_table_fc_t))) {
+        return NULL;
+    }
+    fc = mem;
+    memset(fc, 0, sizeof(*fc));
+
+    fc->rt = robin_table_create(count, hash_func ? hash_func : RT_HASH_FUNC_DEFAULT, seed);
+    if (!fc->rt) {
+        free(fc);
+        return NULL;
+    }
+    if (pthread_mutex_init(&fc->lock, NULL)) {
+        robin_table_destroy(fc->rt);
+        free(fc);
+        return NULL;
+    }
+    if (pthread_key_create(&fc->slot_key, robin_fc_slot_exit)) {
+        pthread_mutex_destroy(&fc->lock);
+        robin_table_destroy(fc->rt);
+        free(fc);
+        return NULL;
+    }
+    return fc;
+}
+
+/*
+ * Free the memory associated with the flat-combining hash table.
+ *
+ * => No other thread may be using the hash table.
+ */
+void robin_table_fc_destroy(robin_table_fc_t* fc)
+{
+    if (!fc) {
+        return;
+    }
+
+    pthread_key_delete(fc->slot_key);
+    pthread_mutex_destroy(&fc->lock);
+    robin_table_destroy(fc->rt);
+    free(fc);
+}
+
+/*
+ * Add a new entry; safe to call from any thread.
+ *
+ * => Same semantics as robin_table_put.
+ */
+void* robin_table_fc_put(robin_table_fc_t* fc, const void* key, size_t klen, void* val)
+{
+    RT_ASSERT(fc != NULL);
+
+    return robin_fc_run(fc, RT_FC_PUT, key, klen, val);
+}
+
+/*
+ * Retrieve the value associated with a given key, or NULL if no entry exists.
+ */
+void* robin_table_fc_get(robin_table_fc_t* fc, const void* key, size_t klen)
+{
+    RT_ASSERT(fc != NULL);
+
+    return robin_fc_run(fc, RT_FC_GET, key, klen, NULL);
+}
+
+/*
+ * Remove an entry with the specified key.
+ *
+ * => Return the associated value, or NULL, if the entry is not found.
+ */
+void* robin_table_fc_del(robin_table_fc_t* fc, const void* key, size_t klen)
+{
+    RT_ASSERT(fc != NULL);
+
+    return robin_fc_run(fc, RT_FC_DEL, key, klen, NULL);
+}
+
+/*
+ * Return the number of entries in the hash table.
+ */
+size_t robin_table_fc_count(robin_table_fc_t* fc)
+{
+    RT_ASSERT(fc != NULL);
+
+    size_t count;
+
+    pthread_mutex_lock(&fc->lock);
+    count = robin_table_count(fc->rt);
+    pthread_mutex_unlock(&fc->lock);
+    return count;
+}
@@ -0,0 +1,397 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+#define RT_IMAGE_MAGIC            "ROBINIMG"
+#define RT_IMAGE_VERSION          1U
+#define RT_IMAGE_BYTE_ORDER       0x01020304U
+
+/* Key hashed to check that an image is opened with the same hash function */
+#define RT_IMAGE_PROBE            "robin_table"
+
+/*
+ * An image is a header, the key and value bytes of every entry, and the
+ * bucket array at an 8-byte aligned offset. Buckets refer to their key and
+ * value bytes by file offset, so the image can be mapped at any address and
+ * shared by every process that maps the file. Integers are stored in the
+ * byte order of the writer, which the reader checks.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t bucket_count;
+    uint64_t count;
+    uint64_t seed;
+    uint64_t fingerprint;
+    uint64_t buckets_off;
+    uint64_t size;
+} robin_image_header_t;
+
+typedef struct {
+    uint64_t hash;
+    uint64_t off;       /* Offset of the key bytes, followed by the value bytes; 0 if empty */
+    uint32_t klen;
+    uint32_t vlen;
+} robin_image_bucket_t;
+
+struct robin_table_image_t {
+    const uint8_t* base;
+    size_t size;
+    const robin_image_bucket_t* buckets;
+    size_t bucket_count;
+    size_t mask;
+    size_t count;
+    uint64_t seed;
+    uint64_t (*hash_func)(const void*, size_t, uint64_t);
+};
+
+static bool robin_image_write_all(FILE* fp, const void* buf, size_t len)
+{
+    return fwrite(buf, 1, len, fp) == len;
+}
+
+/*
+ * Write the image of every entry into fp.
+ */
+static bool robin_image_write(FILE* fp, const robin_table_t* rt, robin_image_bucket_t* buckets,
+                              const void* (*val_fn)(void* val, size_t* len, void* ctx),
+                              void* ctx)
+{
+    static const uint8_t pad[8];
+    robin_image_header_t header;
+    uint64_t off = sizeof(header);
+
+    memset(&header, 0, sizeof(header));
+    if (!robin_image_write_all(fp, &header, sizeof(header))) {
+        return false;
+    }
+
+    for (size_t i = 0; i < rt->bucket_count; ++i) {
+        const robin_bucket_t* bucket = rt->buckets + i;
+        const void* val;
+        size_t vlen;
+
+        if (!bucket->key) {
+            continue;
+        }
+
+        val = val_fn(bucket->val, &vlen, ctx);
+        if (bucket->klen > UINT32_MAX || vlen > UINT32_MAX ||
+            !robin_image_write_all(fp, bucket->key, bucket->klen) ||
+            !robin_image_write_all(fp, val, vlen)) {
+            return false;
+        }
+
+        buckets[i].hash = bucket->hash;
+        buckets[i].off = off;
+        buckets[i].klen = (uint32_t)bucket->klen;
+        buckets[i].vlen = (uint32_t)vlen;
+        off += bucket->klen + vlen;
+    }
+
+    /* Align the bucket array */
+    if (!robin_image_write_all(fp, pad, (8 - (off & 7)) & 7)) {
+        return false;
+    }
+    off = (off + 7) & ~(uint64_t)7;
+
+    if (!robin_image_write_all(fp, buckets, rt->bucket_count * sizeof(*buckets))) {
+        return false;
+    }
+
+    memcpy(header.magic, RT_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = RT_IMAGE_VERSION;
+    header.byte_order = RT_IMAGE_BYTE_ORDER;
+    header.bucket_count = rt->bucket_count;
+    header.count = rt->count;
+    header.seed = rt->seed;
+    header.fingerprint = rt->hash_func(RT_IMAGE_PROBE, sizeof(RT_IMAGE_PROBE) - 1, rt->seed);
+    header.buckets_off = off;
+    header.size = off + rt->bucket_count * sizeof(*buckets);
+
+    return fseek(fp, 0, SEEK_SET) == 0 && robin_image_write_all(fp, &header, sizeof(header));
+}
+
+/*
+ * Write a read-only image of the hash table to path, to be mapped by
+ * robin_table_open_mmap. The image keeps the bucket layout and the stored
+ * hash values, with the key bytes and the bytes val_fn returns for each
+ * value.
+ *
+ * => val_fn returns the bytes representing a value and sets *len; the bytes
+ *    must stay valid until the next call.
+ * => Keys and values are limited to 4GB each.
+ * => The image is written to a new file "<path>.XXXXXX" (see mkstemp),
+ *    synced and renamed over path, so an existing image, possibly mapped,
+ *    is never left half written, and concurrent writers do not clobber each
+ *    other's temporary files. The image is readable by everyone and
+ *    writable by its owner (0644).
+ * => Return false if the file cannot be written.
+ */
+bool robin_table_write_image(const robin_table_t* rt, const char* path,
+                             const void* (*val_fn)(void* val, size_t* len, void* ctx),
+                             void* ctx)
+{
+    RT_ASSERT(rt != NULL && path != NULL);
+    RT_ASSERT(val_fn != NULL);
+
+    const size_t path_len = strlen(path);
+    robin_image_bucket_t* buckets;
+    char* tmp_path;
+    FILE* fp = NULL;
+    bool ok;
+    int fd;
+
+    buckets = calloc(rt->bucket_count, sizeof(robin_image_bucket_t));
+    tmp_path = malloc(path_len + sizeof(".XXXXXX"));
+    if (!buckets || !tmp_path) {
+        free(buckets);
+        free(tmp_path);
+        return false;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".XXXXXX", sizeof(".XXXXXX"));
+
+    /* mkstemp creates the file readable by its owner only */
+    fd = mkstemp(tmp_path);
+    if (fd < 0) {
+        free(buckets);
+        free(tmp_path);
+        return false;
+    }
+    if (fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0 ||
+        !(fp = fdopen(fd, "wb"))) {
+        close(fd);
+        unlink(tmp_path);
+        free(buckets);
+        free(tmp_path);
+        return false;
+    }
+
+    ok = robin_image_write(fp, rt, buckets, val_fn, ctx) && fflush(fp) == 0 &&
+         fsync(fileno(fp)) == 0;
+    ok = (fclose(fp) == 0) && ok;
+    ok = ok && rename(tmp_path, path) == 0;
+    if (!ok) {
+        unlink(tmp_path);
+    }
+    free(buckets);
+    free(tmp_path);
+    return ok;
+}
+
+/*
+ * Check the header of a mapped image against its size and the hash function.
+ */
+static bool robin_image_check(const robin_image_header_t* header, size_t size,
+                              uint64_t (*hash_func)(const void*, size_t, uint64_t))
+{
+    uint64_t bucket_count = header->bucket_count;
+
+    return memcmp(header->magic, RT_IMAGE_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == RT_IMAGE_VERSION && header->byte_order == RT_IMAGE_BYTE_ORDER &&
+           header->size == size && bucket_count && !(bucket_count & (bucket_count - 1)) &&
+           header->count < bucket_count && !(header->buckets_off & 7) &&
+           header->buckets_off >= sizeof(*header) && header->buckets_off <= size &&
+           bucket_count <= (size - header->buckets_off) / sizeof(robin_image_bucket_t) &&
+           header->fingerprint ==
+               hash_func(RT_IMAGE_PROBE, sizeof(RT_IMAGE_PROBE) - 1, header->seed);
+}
+
+/*
+ * Map an image written by robin_table_write_image. Lookups and iteration
+ * read the file pages directly, so the image costs no loading time and all
+ * processes mapping the same file share one copy in the page cache.
+ *
+ * => hash_func MUST be the hash function the hash table was written with.
+ * => Return NULL if the file cannot be mapped, is not an image of this
+ *    version and byte order, or was written with another hash function.
+ */
+robin_table_image_t* robin_table_open_mmap(const char* path,
+                                           uint64_t (*hash_func)(const void*, size_t, uint64_t))
+{
+    RT_ASSERT(path != NULL);
+
+    robin_table_image_t* img;
+    const robin_image_header_t* header;
+    struct stat st;
+    void* base;
+    int fd;
+
+    hash_func = hash_func ? hash_func : RT_HASH_FUNC_DEFAULT;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(robin_image_header_t) ||
+        (uint64_t)st.st_size > SIZE_MAX) {
+        close(fd);
+        return NULL;
+    }
+
+    /* The mapping stays valid after the descriptor is closed */
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    header = base;
+    img = malloc(sizeof(robin_table_image_t));
+    if (!img || !robin_image_check(header, (size_t)st.st_size, hash_func)) {
+        munmap(base, (size_t)st.st_size);
+        free(img);
+        return NULL;
+    }
+
+    img->base = base;
+    img->size = (size_t)st.st_size;
+    img->buckets = (const robin_image_bucket_t*)(img->base + header->buckets_off);
+    img->bucket_count = header->bucket_count;
+    img->mask = header->bucket_count - 1;
+    img->count = header->count;
+    img->seed = header->seed;
+    img->hash_func = hash_func;
+    return img;
+}
+
+/*
+ * Unmap the image. Keys and values it returned are no longer valid.
+ */
+void robin_table_image_close(robin_table_image_t* img)
+{
+    if (!img) {
+        return;
+    }
+
+    munmap((void*)img->base, img->size);
+    free(img);
+}
+
+/*
+ * Return the key bytes of a bucket, or NULL if they lie outside the image.
+ */
+static inline const uint8_t* robin_image_key(const robin_table_image_t* img,
+                                             const robin_image_bucket_t* bucket)
+{
+    if (bucket->off > img->size ||
+        (uint64_t)bucket->klen + bucket->vlen > img->size - bucket->off) {
+        return NULL;
+    }
+    return img->base + bucket->off;
+}
+
+/*
+ * Look up a key in the image.
+ *
+ * => Return a pointer to the value bytes in the mapping and set *vlen (if
+ *    not NULL), or return NULL if the key is not found.
+ */
+const void* robin_table_image_get(const robin_table_image_t* img, const void* key, size_t klen,
+                                  size_t* vlen)
+{
+    RT_ASSERT(img != NULL);
+    RT_ASSERT(key != NULL && klen > 0);
+
+    const uint64_t hash = img->hash_func(key, klen, img->seed);
+    size_t idx = hash & img->mask;
+    size_t psl = 0;
+
+    for (;;) {
+        const robin_image_bucket_t* bucket = img->buckets + idx;
+        const uint8_t* bkey;
+
+        /* Robin Hood invariant: stop at an empty or a richer bucket */
+        if (!bucket->off || psl > ((idx - bucket->hash) & img->mask) || psl > img->mask) {
+            return NULL;
+        }
+
+        if (bucket->hash == hash && bucket->klen == klen) {
+            bkey = robin_image_key(img, bucket);
+            if (bkey && memcmp(bkey, key, klen) == 0) {
+                if (vlen) {
+                    *vlen = bucket->vlen;
+                }
+                return bkey + klen;
+            }
+        }
+
+        idx = (idx + 1) & img->mask;
+        psl++;
+    }
+}
+
+/*
+ * Call fn for every entry of the image, in bucket order, until it returns
+ * false.
+ *
+ * => Return false if the iteration was stopped by fn.
+ */
+bool robin_table_image_for_each(const robin_table_image_t* img,
+                                bool (*fn)(const void* key, size_t klen, const void* val,
+                                           size_t vlen, void* ctx),
+                                void* ctx)
+{
+    RT_ASSERT(img != NULL && fn != NULL);
+
+    for (size_t i = 0; i < img->bucket_count; ++i) {
+        const robin_image_bucket_t* bucket = img->buckets + i;
+        const uint8_t* bkey;
+
+        if (!bucket->off || !(bkey = robin_image_key(img, bucket))) {
+            continue;
+        }
+        if (!fn(bkey, bucket->klen, bkey + bucket->klen, bucket->vlen, ctx)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Return the number of entries in the image.
+ */
+size_t robin_table_image_count(const robin_table_image_t* img)
+{
+    RT_ASSERT(img != NULL);
+
+    return img->count;
+}
@@ -0,0 +1,134 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Definitions shared by the modules of the library. Internal to the library.
+ */
+
+#ifndef ROBIN_TABLE_INTERNAL_H
+#define ROBIN_TABLE_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "robin_table.h"
+#include "robin_table_inline.h"
+
+#ifndef RT_NO_ASSERT
+#include <assert.h>
+#define RT_ASSERT(expr)           assert(expr)
+#else
+#define RT_ASSERT(expr)
+#endif /* RT_NO_ASSERT */
+
+/*
+ * Functions shared by the modules of the library but not exported from it,
+ * so that only the robin_table_ API is visible to applications.
+ */
+#if defined(__GNUC__)
+#define RT_INTERNAL               __attribute__((visibility("hidden")))
+#else
+#define RT_INTERNAL
+#endif
+
+#define RT_HASH_FUNC_DEFAULT      robin_table_rapidhash
+
+/* Bucket count MUST be a power of two */
+#define RT_BUCKET_COUNT_MIN       32U
+
+/* Maximum and minimum load factor thresholds */
+#define RT_LOAD_FACTOR_PCT_MAX    75U
+#define RT_LOAD_FACTOR_PCT_MIN    25U
+
+typedef robin_table_bucket_t robin_bucket_t;
+
+typedef struct robin_retired_t {
+    struct robin_retired_t* next;
+    robin_bucket_t* buckets;
+} robin_retired_t;
+
+struct robin_table_snapshot_t;
+struct robin_snapshot_base_t;
+
+struct robin_table_t {
+    robin_bucket_t* buckets;
+    size_t count;
+    size_t bucket_count;
+    size_t init_buckets;
+    size_t mask;
+    size_t expand_at;
+    size_t shrink_at;
+    uint64_t seed;
+    uint64_t (*hash_func)(const void*, size_t, uint64_t);
+    size_t key_width;           /* Fixed key length of the integer hash functions, or 0 */
+    uint64_t seq;               /* SWMR sequence counter, odd while writing */
+    bool swmr;
+    robin_retired_t* retired;   /* Bucket arrays replaced in SWMR mode */
+    struct robin_table_snapshot_t* snapshots;  /* Snapshots sharing the bucket array */
+    struct robin_snapshot_base_t* cow_base;    /* Shared bucket array holder */
+    uint64_t* cow_bits;         /* Pages already copied for every snapshot */
+    void* key_arena;            /* Key bytes owned by a loaded hash table */
+    size_t flood_limit;         /* Configured flood guard PSL, 0 for the default, SIZE_MAX if off */
+    size_t flood_psl;           /* PSL above which an insertion triggers a reseed */
+    size_t flood_hit;           /* Largest PSL above flood_psl seen by an insertion, or 0 */
+    unsigned flood_backoff;     /* Doublings of flood_psl after reseeds that did not help */
+    uint64_t (*flood_hash)(const void*, size_t, uint64_t);  /* Keyed hash to switch to */
+    void (*flood_cb)(struct robin_table_t*, size_t, void*);
+    void* flood_ctx;
+};
+
+typedef struct {
+    const void* key;
+    void* val;
+    size_t klen;
+} robin_mphf_entry_t;
+
+struct robin_table_mphf_t {
+    robin_mphf_entry_t* entries;    /* One per key, indexed by its slot */
+    size_t count;
+    uint32_t* pilots;               /* Displacement of every group of keys */
+    size_t group_count;
+    uint32_t* remap;                /* Final slot of slots count and above */
+    size_t slot_count;
+    uint64_t seed;
+    uint64_t (*hash_func)(const void*, size_t, uint64_t);
+    void* key_arena;                /* Key bytes owned by a loaded table */
+};
+
+/* Portable implementations of the accelerated hash functions (hwhash.c) */
+RT_INTERNAL uint64_t robin_hash_crc32c_portable(const void* key, size_t klen, uint64_t seed);
+RT_INTERNAL uint64_t robin_hash_aes_portable(const void* key, size_t klen, uint64_t seed);
+
+/* Sorting of exported entries (robin_table.c, robin_table_pool.c) */
+RT_INTERNAL robin_bucket_t* robin_table_export_sort(robin_bucket_t* src, robin_bucket_t* tmp,
+                                                    size_t n, size_t width,
+                                                    int (*cmp)(const void*, size_t,
+                                                               const void*, size_t));
+RT_INTERNAL size_t robin_pool_sort_runs(robin_table_pool_t* pool, robin_bucket_t* entries,
+                                        robin_bucket_t* tmp, size_t n,
+                                        int (*cmp)(const void*, size_t, const void*, size_t));
+
+#endif /* ROBIN_TABLE_INTERNAL_H */
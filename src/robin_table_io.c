@@ -0,0 +1,752 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/* Maximum number of payload bytes per checksummed block of the stream */
+#define RT_STREAM_BLOCK           65536U
+
+#define RT_SAVE_MAGIC             "ROBINTBL"
+#define RT_SAVE_VERSION           1U
+#define RT_SAVE_HEADER_SIZE       64U
+#define RT_MPHF_MAGIC             "ROBINMPH"
+
+/* Key hashed to check that a hash table is loaded with the same hash function */
+#define RT_SAVE_PROBE             "robin_table"
+
+/*
+ * The stream is a sequence of blocks, each made of a 32-bit payload length,
+ * the payload and a 64-bit xxh64 checksum chained from the previous block.
+ * A block with an empty payload terminates the stream. All integers are
+ * stored in little-endian byte order.
+ *
+ * The payload is the header (magic, version, bucket count, initial bucket
+ * count, entry count, seed, total key bytes, hash function fingerprint),
+ * followed by the entries in bucket order: bucket index, hash value, key
+ * length, key bytes, value length and value bytes.
+ */
+typedef struct {
+    uint8_t buf[RT_STREAM_BLOCK];
+    size_t len;       /* Bytes buffered (writer) or available (reader) */
+    size_t pos;       /* Read position within the block */
+    uint64_t check;   /* Chained checksum */
+    bool end;         /* Terminating block seen */
+    void* ctx;
+    union {
+        bool (*write_fn)(const void* buf, size_t len, void* ctx);
+        bool (*read_fn)(void* buf, size_t len, void* ctx);
+    } io;
+} robin_stream_t;
+
+static inline void robin_store_le32(uint8_t* p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static inline void robin_store_le64(uint8_t* p, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static inline uint32_t robin_load_le32(const uint8_t* p)
+{
+    uint32_t v = 0;
+
+    for (int i = 3; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline uint64_t robin_load_le64(const uint8_t* p)
+{
+    uint64_t v = 0;
+
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static robin_stream_t* robin_stream_create(void* ctx)
+{
+    robin_stream_t* s = malloc(sizeof(robin_stream_t));
+
+    if (s) {
+        s->len = 0;
+        s->pos = 0;
+        s->check = 0;
+        s->end = false;
+        s->ctx = ctx;
+    }
+    return s;
+}
+
+/*
+ * Write the buffered payload as one block.
+ */
+static bool robin_stream_flush(robin_stream_t* s)
+{
+    uint8_t frame[8];
+
+    s->check = robin_table_xxh64(s->buf, s->len, s->check);
+
+    robin_store_le32(frame, (uint32_t)s->len);
+    if (!s->io.write_fn(frame, 4, s->ctx) ||
+        (s->len && !s->io.write_fn(s->buf, s->len, s->ctx))) {
+        return false;
+    }
+    robin_store_le64(frame, s->check);
+    if (!s->io.write_fn(frame, 8, s->ctx)) {
+        return false;
+    }
+    s->len = 0;
+    return true;
+}
+
+static bool robin_stream_write(robin_stream_t* s, const void* data, size_t len)
+{
+    const uint8_t* p = data;
+
+    while (len) {
+        size_t n = RT_STREAM_BLOCK - s->len;
+
+        if (n > len) {
+            n = len;
+        }
+        memcpy(s->buf + s->len, p, n);
+        s->len += n;
+        p += n;
+        len -= n;
+
+        if (s->len == RT_STREAM_BLOCK && !robin_stream_flush(s)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool robin_stream_write_u32(robin_stream_t* s, uint32_t v)
+{
+    uint8_t buf[4];
+
+    robin_store_le32(buf, v);
+    return robin_stream_write(s, buf, sizeof(buf));
+}
+
+static bool robin_stream_write_u64(robin_stream_t* s, uint64_t v)
+{
+    uint8_t buf[8];
+
+    robin_store_le64(buf, v);
+    return robin_stream_write(s, buf, sizeof(buf));
+}
+
+/*
+ * Read and verify the next block.
+ */
+static bool robin_stream_fill(robin_stream_t* s)
+{
+    uint8_t frame[8];
+    uint32_t len;
+
+    if (s->end || !s->io.read_fn(frame, 4, s->ctx)) {
+        return false;
+    }
+    len = robin_load_le32(frame);
+    if (len > RT_STREAM_BLOCK || (len && !s->io.read_fn(s->buf, len, s->ctx)) ||
+        !s->io.read_fn(frame, 8, s->ctx)) {
+        return false;
+    }
+
+    s->check = robin_table_xxh64(s->buf, len, s->check);
+    if (robin_load_le64(frame) != s->check) {
+        return false;
+    }
+    s->len = len;
+    s->pos = 0;
+    s->end = (len == 0);
+    return true;
+}
+
+static bool robin_stream_read(robin_stream_t* s, void* data, size_t len)
+{
+    uint8_t* p = data;
+
+    while (len) {
+        size_t n = s->len - s->pos;
+
+        if (!n) {
+            if (!robin_stream_fill(s) || s->end) {
+                return false;
+            }
+            continue;
+        }
+        if (n > len) {
+            n = len;
+        }
+        memcpy(p, s->buf + s->pos, n);
+        s->pos += n;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool robin_stream_read_u32(robin_stream_t* s, uint32_t* v)
+{
+    uint8_t buf[4];
+
+    if (!robin_stream_read(s, buf, sizeof(buf))) {
+        return false;
+    }
+    *v = robin_load_le32(buf);
+    return true;
+}
+
+static bool robin_stream_read_u64(robin_stream_t* s, uint64_t* v)
+{
+    uint8_t buf[8];
+
+    if (!robin_stream_read(s, buf, sizeof(buf))) {
+        return false;
+    }
+    *v = robin_load_le64(buf);
+    return true;
+}
+
+/*
+ * Read the length and bytes of a value into a scratch buffer grown as
+ * needed.
+ */
+static bool robin_stream_read_val(robin_stream_t* s, uint8_t** buf, size_t* cap,
+                                  uint64_t* vlen)
+{
+    if (!robin_stream_read_u64(s, vlen) || *vlen > PTRDIFF_MAX) {
+        return false;
+    }
+    if (*vlen > *cap) {
+        uint8_t* new_buf = realloc(*buf, *vlen);
+
+        if (!new_buf) {
+            return false;
+        }
+        *buf = new_buf;
+        *cap = *vlen;
+    }
+    return robin_stream_read(s, *buf, *vlen);
+}
+
+/*
+ * Write the header and every entry of the hash table into the stream.
+ */
+static bool robin_save_entries(robin_stream_t* s, const robin_table_t* rt,
+                               const void* (*val_fn)(void* val, size_t* len, void* ctx))
+{
+    uint8_t header[RT_SAVE_HEADER_SIZE];
+    uint64_t key_bytes = 0;
+
+    for (size_t i = 0; i < rt->bucket_count; ++i) {
+        key_bytes += rt->buckets[i].key ? rt->buckets[i].klen : 0;
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, RT_SAVE_MAGIC, 8);
+    robin_store_le32(header + 8, RT_SAVE_VERSION);
+    robin_store_le64(header + 16, rt->bucket_count);
+    robin_store_le64(header + 24, rt->init_buckets);
+    robin_store_le64(header + 32, rt->count);
+    robin_store_le64(header + 40, rt->seed);
+    robin_store_le64(header + 48, key_bytes);
+    robin_store_le64(header + 56, rt->hash_func(RT_SAVE_PROBE, sizeof(RT_SAVE_PROBE) - 1,
+                                                rt->seed));
+    if (!robin_stream_write(s, header, sizeof(header))) {
+        return false;
+    }
+
+    for (size_t i = 0; i < rt->bucket_count; ++i) {
+        const robin_bucket_t* bucket = rt->buckets + i;
+        const void* val;
+        size_t vlen;
+
+        if (!bucket->key) {
+            continue;
+        }
+
+        val = val_fn(bucket->val, &vlen, s->ctx);
+        if (!robin_stream_write_u64(s, i) || !robin_stream_write_u64(s, bucket->hash) ||
+            !robin_stream_write_u64(s, bucket->klen) ||
+            !robin_stream_write(s, bucket->key, bucket->klen) ||
+            !robin_stream_write_u64(s, vlen) || !robin_stream_write(s, val, vlen)) {
+            return false;
+        }
+    }
+
+    /* Flush the last block, then terminate the stream */
+    return (!s->len || robin_stream_flush(s)) && robin_stream_flush(s);
+}
+
+/*
+ * Serialize the hash table through write_fn: the bucket layout with the
+ * stored hash values and the key bytes, and every value as the bytes val_fn
+ * returns for it.
+ *
+ * => write_fn must write all len bytes and return true, or return false.
+ * => val_fn returns the bytes representing a value and sets *len; the bytes
+ *    must stay valid until the next call.
+ * => Return false if any write fails.
+ */
+bool robin_table_save(const robin_table_t* rt,
+                      bool (*write_fn)(const void* buf, size_t len, void* ctx),
+                      const void* (*val_fn)(void* val, size_t* len, void* ctx),
+                      void* ctx)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(write_fn != NULL && val_fn != NULL);
+
+    robin_stream_t* s;
+    bool ok;
+
+    s = robin_stream_create(ctx);
+    if (!s) {
+        return false;
+    }
+    s->io.write_fn = write_fn;
+
+    ok = robin_save_entries(s, rt, val_fn);
+    free(s);
+    return ok;
+}
+
+/*
+ * Read the header and create an empty hash table with the saved layout.
+ */
+static robin_table_t* robin_load_header(robin_stream_t* s,
+                                        uint64_t (*hash_func)(const void*, size_t, uint64_t),
+                                        size_t* count, size_t* key_bytes)
+{
+    uint8_t header[RT_SAVE_HEADER_SIZE];
+    uint64_t bucket_count, init_buckets, seed;
+    robin_table_t* rt;
+
+    if (!robin_stream_read(s, header, sizeof(header)) ||
+        memcmp(header, RT_SAVE_MAGIC, 8) != 0 ||
+        robin_load_le32(header + 8) != RT_SAVE_VERSION) {
+        return NULL;
+    }
+    bucket_count = robin_load_le64(header + 16);
+    init_buckets = robin_load_le64(header + 24);
+    seed = robin_load_le64(header + 40);
+
+    if (bucket_count < RT_BUCKET_COUNT_MIN || (bucket_count & (bucket_count - 1)) ||
+        bucket_count > SIZE_MAX / sizeof(robin_bucket_t) || init_buckets > bucket_count ||
+        init_buckets < RT_BUCKET_COUNT_MIN || (init_buckets & (init_buckets - 1)) ||
+        robin_load_le64(header + 32) > (bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100 ||
+        robin_load_le64(header + 48) < robin_load_le64(header + 32) ||
+        robin_load_le64(header + 48) > PTRDIFF_MAX ||
+        robin_load_le64(header + 56) !=
+            hash_func(RT_SAVE_PROBE, sizeof(RT_SAVE_PROBE) - 1, seed)) {
+        return NULL;
+    }
+    *count = robin_load_le64(header + 32);
+    *key_bytes = robin_load_le64(header + 48);
+
+    rt = robin_table_create(0, hash_func, seed);
+    if (!rt) {
+        return NULL;
+    }
+    free(rt->buckets);
+    rt->buckets = calloc(bucket_count, sizeof(robin_bucket_t));
+    rt->key_arena = malloc(*key_bytes ? *key_bytes : 1);
+    if (!rt->buckets || !rt->key_arena) {
+        robin_table_destroy(rt);
+        return NULL;
+    }
+    rt->bucket_count = bucket_count;
+    rt->init_buckets = init_buckets;
+    rt->mask = bucket_count - 1;
+    rt->expand_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100;
+    rt->shrink_at = (rt->bucket_count * RT_LOAD_FACTOR_PCT_MIN) / 100;
+    return rt;
+}
+
+/*
+ * Read every entry and place it at its saved bucket.
+ *
+ * => Every entry must satisfy the Robin Hood invariant: an entry away from
+ *    its home bucket follows an occupied bucket whose PSL is at most one
+ *    lower.
+ */
+static bool robin_load_entries(robin_stream_t* s, robin_table_t* rt, size_t count,
+                               size_t key_bytes, uint8_t** val_buf,
+                               void* (*val_fn)(const void* buf, size_t len, void* ctx))
+{
+    uint8_t* key_next = rt->key_arena;
+    const robin_bucket_t* first = rt->buckets;
+    const robin_bucket_t* last = rt->buckets + rt->mask;
+    size_t val_cap = 0;
+    size_t key_used = 0;
+    uint64_t prev_idx = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        robin_bucket_t* bucket;
+        uint64_t idx, hash, klen, vlen;
+        size_t psl;
+
+        if (!robin_stream_read_u64(s, &idx) || !robin_stream_read_u64(s, &hash) ||
+            !robin_stream_read_u64(s, &klen)) {
+            return false;
+        }
+
+        /* Entries come in ascending bucket order, each key inside the arena */
+        if (idx >= rt->bucket_count || (i && idx <= prev_idx) || !klen ||
+            klen > key_bytes - key_used) {
+            return false;
+        }
+
+        /* The predecessor of a bucket other than the first is the previous entry */
+        psl = (idx - hash) & rt->mask;
+        if (psl && idx && (!i || prev_idx != idx - 1 || psl > rt->buckets[prev_idx].psl + 1)) {
+            return false;
+        }
+        prev_idx = idx;
+
+        if (!robin_stream_read(s, key_next, klen) ||
+            !robin_stream_read_val(s, val_buf, &val_cap, &vlen)) {
+            return false;
+        }
+
+        bucket = rt->buckets + idx;
+        bucket->val = val_fn(*val_buf, vlen, s->ctx);
+        if (!bucket->val) {
+            return false;
+        }
+        bucket->key = key_next;
+        bucket->klen = klen;
+        bucket->hash = hash;
+        bucket->psl = psl;
+        rt->count++;
+
+        key_next += klen;
+        key_used += klen;
+    }
+
+    /* The probe run of the first bucket may wrap around from the last one */
+    if (first->key && first->psl && (!last->key || first->psl > last->psl + 1)) {
+        return false;
+    }
+
+    /* The terminating block must follow the last entry */
+    return key_used == key_bytes && s->pos == s->len && robin_stream_fill(s) && s->end;
+}
+
+/*
+ * Restore a hash table serialized by robin_table_save.
+ *
+ * => Every entry is placed directly at its saved bucket with its saved hash
+ *    value: nothing is rehashed or probed. The bucket layout is checked in
+ *    a single pass.
+ * => The key bytes are kept in a single allocation owned by the hash table
+ *    and freed by robin_table_destroy.
+ * => val_fn turns the bytes of a value back into a value, or returns NULL
+ *    on failure; the bytes are only valid during the call.
+ * => If the load fails after values were produced, free_fn (unless NULL)
+ *    is called on each of them.
+ * => hash_func MUST be the hash function the hash table was saved with.
+ * => Return NULL if the stream is truncated, corrupt, of another version
+ *    or was saved with another hash function, if val_fn fails, or on
+ *    allocation failure.
+ */
+robin_table_t* robin_table_load(bool (*read_fn)(void* buf, size_t len, void* ctx),
+                                void* (*val_fn)(const void* buf, size_t len, void* ctx),
+                                void (*free_fn)(void* val, void* ctx),
+                                void* ctx,
+                                uint64_t (*hash_func)(const void*, size_t, uint64_t))
+{
+    RT_ASSERT(read_fn != NULL && val_fn != NULL);
+
+    robin_stream_t* s;
+    robin_table_t* rt;
+    uint8_t* val_buf = NULL;
+    size_t count, key_bytes;
+
+    s = robin_stream_create(ctx);
+    if (!s) {
+        return NULL;
+    }
+    s->io.read_fn = read_fn;
+
+    rt = robin_load_header(s, hash_func ? hash_func : RT_HASH_FUNC_DEFAULT, &count,
+                           &key_bytes);
+    if (rt && !robin_load_entries(s, rt, count, key_bytes, &val_buf, val_fn)) {
+        for (size_t i = 0; free_fn && i < rt->bucket_count; ++i) {
+            if (rt->buckets[i].key) {
+                free_fn(rt->buckets[i].val, ctx);
+            }
+        }
+        robin_table_destroy(rt);
+        rt = NULL;
+    }
+
+    free(val_buf);
+    free(s);
+    return rt;
+}
+
+/*
+ * Write the header, pilots, remap array and entries of a read-only table.
+ */
+static bool robin_save_mphf(robin_stream_t* s, const robin_table_mphf_t* mp,
+                            const void* (*val_fn)(void* val, size_t* len, void* ctx))
+{
+    uint8_t header[RT_SAVE_HEADER_SIZE];
+    uint64_t key_bytes = 0;
+
+    for (size_t i = 0; i < mp->count; ++i) {
+        key_bytes += mp->entries[i].klen;
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, RT_MPHF_MAGIC, 8);
+    robin_store_le32(header + 8, RT_SAVE_VERSION);
+    robin_store_le64(header + 16, mp->count);
+    robin_store_le64(header + 24, mp->group_count);
+    robin_store_le64(header + 32, mp->slot_count);
+    robin_store_le64(header + 40, mp->seed);
+    robin_store_le64(header + 48, key_bytes);
+    robin_store_le64(header + 56, mp->hash_func(RT_SAVE_PROBE, sizeof(RT_SAVE_PROBE) - 1,
+                                                mp->seed));
+    if (!robin_stream_write(s, header, sizeof(header))) {
+        return false;
+    }
+
+    for (size_t g = 0; g < mp->group_count; ++g) {
+        if (!robin_stream_write_u32(s, mp->pilots[g])) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < mp->slot_count - mp->count; ++i) {
+        if (!robin_stream_write_u32(s, mp->remap[i])) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < mp->count; ++i) {
+        const robin_mphf_entry_t* entry = mp->entries + i;
+        const void* val;
+        size_t vlen;
+
+        val = val_fn(entry->val, &vlen, s->ctx);
+        if (!robin_stream_write_u64(s, entry->klen) ||
+            !robin_stream_write(s, entry->key, entry->klen) ||
+            !robin_stream_write_u64(s, vlen) || !robin_stream_write(s, val, vlen)) {
+            return false;
+        }
+    }
+
+    return (!s->len || robin_stream_flush(s)) && robin_stream_flush(s);
+}
+
+/*
+ * Serialize a read-only table built by robin_table_freeze_mphf, in the same
+ * block format as robin_table_save. The perfect hash is stored as built,
+ * so loading it back does not search for pilots again.
+ *
+ * => Same callbacks and return value as robin_table_save.
+ */
+bool robin_table_mphf_save(const robin_table_mphf_t* mp,
+                           bool (*write_fn)(const void* buf, size_t len, void* ctx),
+                           const void* (*val_fn)(void* val, size_t* len, void* ctx),
+                           void* ctx)
+{
+    RT_ASSERT(mp != NULL);
+    RT_ASSERT(write_fn != NULL && val_fn != NULL);
+
+    robin_stream_t* s;
+    bool ok;
+
+    s = robin_stream_create(ctx);
+    if (!s) {
+        return false;
+    }
+    s->io.write_fn = write_fn;
+
+    ok = robin_save_mphf(s, mp, val_fn);
+    free(s);
+    return ok;
+}
+
+/*
+ * Read the header of a read-only table and allocate its arrays.
+ */
+static robin_table_mphf_t* robin_load_mphf_header(robin_stream_t* s,
+                                                  uint64_t (*hash_func)(const void*, size_t,
+                                                                        uint64_t),
+                                                  size_t* key_bytes)
+{
+    uint8_t header[RT_SAVE_HEADER_SIZE];
+    uint64_t count, group_count, slot_count;
+    robin_table_mphf_t* mp;
+
+    if (!robin_stream_read(s, header, sizeof(header)) ||
+        memcmp(header, RT_MPHF_MAGIC, 8) != 0 ||
+        robin_load_le32(header + 8) != RT_SAVE_VERSION) {
+        return NULL;
+    }
+    count = robin_load_le64(header + 16);
+    group_count = robin_load_le64(header + 24);
+    slot_count = robin_load_le64(header + 32);
+
+    /* Bound the allocations by the entry count */
+    if (count >= UINT32_MAX || !group_count || group_count > count + 1 ||
+        slot_count <= count || slot_count > 2 * count + 1 ||
+        robin_load_le64(header + 48) < count || robin_load_le64(header + 48) > PTRDIFF_MAX ||
+        robin_load_le64(header + 56) !=
+            hash_func(RT_SAVE_PROBE, sizeof(RT_SAVE_PROBE) - 1, robin_load_le64(header + 40))) {
+        return NULL;
+    }
+    *key_bytes = robin_load_le64(header + 48);
+
+    mp = calloc(1, sizeof(robin_table_mphf_t));
+    if (!mp) {
+        return NULL;
+    }
+    mp->count = count;
+    mp->group_count = group_count;
+    mp->slot_count = slot_count;
+    mp->seed = robin_load_le64(header + 40);
+    mp->hash_func = hash_func;
+    mp->entries = calloc(count + 1, sizeof(robin_mphf_entry_t));
+    mp->pilots = calloc(group_count, sizeof(uint32_t));
+    mp->remap = calloc(slot_count - count, sizeof(uint32_t));
+    mp->key_arena = malloc(*key_bytes ? *key_bytes : 1);
+    if (!mp->entries || !mp->pilots || !mp->remap || !mp->key_arena) {
+        robin_table_mphf_destroy(mp);
+        return NULL;
+    }
+    return mp;
+}
+
+/*
+ * Read the pilots, remap array and entries of a read-only table.
+ */
+static bool robin_load_mphf(robin_stream_t* s, robin_table_mphf_t* mp, size_t key_bytes,
+                            uint8_t** val_buf,
+                            void* (*val_fn)(const void* buf, size_t len, void* ctx))
+{
+    uint8_t* key_next = mp->key_arena;
+    size_t val_cap = 0;
+    size_t key_used = 0;
+
+    for (size_t g = 0; g < mp->group_count; ++g) {
+        if (!robin_stream_read_u32(s, mp->pilots + g)) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < mp->slot_count - mp->count; ++i) {
+        if (!robin_stream_read_u32(s, mp->remap + i) || mp->remap[i] >= mp->count) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < mp->count; ++i) {
+        robin_mphf_entry_t* entry = mp->entries + i;
+        uint64_t klen, vlen;
+
+        if (!robin_stream_read_u64(s, &klen) || !klen || klen > key_bytes - key_used ||
+            !robin_stream_read(s, key_next, klen) ||
+            !robin_stream_read_val(s, val_buf, &val_cap, &vlen)) {
+            return false;
+        }
+
+        entry->val = val_fn(*val_buf, vlen, s->ctx);
+        if (!entry->val) {
+            return false;
+        }
+        entry->key = key_next;
+        entry->klen = klen;
+
+        key_next += klen;
+        key_used += klen;
+    }
+
+    return s->pos == s->len && robin_stream_fill(s) && s->end;
+}
+
+/*
+ * Restore a read-only table serialized by robin_table_mphf_save.
+ *
+ * => The key bytes are owned by the table and freed by
+ *    robin_table_mphf_destroy.
+ * => Same callbacks, hash function requirement and return value as
+ *    robin_table_load.
+ */
+robin_table_mphf_t* robin_table_mphf_load(bool (*read_fn)(void* buf, size_t len, void* ctx),
+                                          void* (*val_fn)(const void* buf, size_t len,
+                                                          void* ctx),
+                                          void (*free_fn)(void* val, void* ctx),
+                                          void* ctx,
+                                          uint64_t (*hash_func)(const void*, size_t,
+                                                                uint64_t))
+{
+    RT_ASSERT(read_fn != NULL && val_fn != NULL);
+
+    robin_stream_t* s;
+    robin_table_mphf_t* mp;
+    uint8_t* val_buf = NULL;
+    size_t key_bytes;
+
+    s = robin_stream_create(ctx);
+    if (!s) {
+        return NULL;
+    }
+    s->io.read_fn = read_fn;
+
+    mp = robin_load_mphf_header(s, hash_func ? hash_func : RT_HASH_FUNC_DEFAULT, &key_bytes);
+    if (mp && !robin_load_mphf(s, mp, key_bytes, &val_buf, val_fn)) {
+        for (size_t i = 0; free_fn && i < mp->count; ++i) {
+            if (mp->entries[i].key) {
+                free_fn(mp->entries[i].val, ctx);
+            }
+        }
+        robin_table_mphf_destroy(mp);
+        mp = NULL;
+    }
+
+    free(val_buf);
+    free(s);
+    return mp;
+}
@@ -0,0 +1,979 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/* Default size at which the active segment is sealed */
+#define RT_KV_SEGMENT_SIZE        (64U << 20)
+
+/* Record header: checksum, key length, value length */
+#define RT_KV_RECORD_HEADER       12U
+
+/* Hint record header: key length, value length, record offset */
+#define RT_KV_HINT_HEADER         16U
+
+/* Value length of a deletion record */
+#define RT_KV_TOMBSTONE           UINT32_MAX
+
+#define RT_KV_DATA_EXT            ".data"
+#define RT_KV_HINT_EXT            ".hint"
+#define RT_KV_TMP_EXT             ".tmp"
+
+/*
+ * The store is a directory of segment files named after their 64-bit id.
+ * Every put or del appends a record to the active segment:
+ *
+ *   u32 checksum, u32 key length, u32 value length, key bytes, value bytes
+ *
+ * where a deletion has no value bytes and RT_KV_TOMBSTONE as its length.
+ * Once the active segment reaches its size limit it is sealed and a new one
+ * is started. Sealed segments never change: compaction copies their live
+ * records into one new segment, with a hint file listing the key and offset
+ * of every record, and then removes them.
+ *
+ * Active segment ids are even and advance by two, so that the output of a
+ * compaction takes the odd id between the segments it replaces and the new
+ * active segment. Replaying the segments in id order thus always applies
+ * the records in the order they were written.
+ */
+typedef struct {
+    uint64_t id;
+    int fd;
+    uint64_t size;
+    uint64_t dead;      /* Bytes of overwritten or deleted records */
+} robin_kv_segment_t;
+
+typedef struct {
+    robin_kv_segment_t* seg;
+    uint64_t off;       /* Offset of the record in its segment */
+    uint32_t klen;
+    uint32_t vlen;
+    uint8_t key[];
+} robin_kv_entry_t;
+
+struct robin_table_kv_t {
+    pthread_rwlock_t lock;              /* Index and segment list */
+    robin_table_t* index;               /* Key to robin_kv_entry_t */
+    robin_kv_segment_t** segs;          /* Sorted by id, active one last */
+    size_t seg_count;
+    size_t seg_cap;
+    uint64_t segment_size;
+    char* dir;
+    pthread_mutex_t compact_lock;       /* One compaction at a time */
+    pthread_mutex_t bg_lock;
+    pthread_cond_t bg_cond;
+    bool bg_pending;
+    bool bg_stop;
+    pthread_t bg_thread;
+};
+
+/* A record copied by a compaction, redirected once the output is complete */
+typedef struct {
+    robin_kv_segment_t* seg;
+    uint64_t old_off;
+    uint64_t new_off;
+    size_t key_off;     /* Offset of the key in the copied keys buffer */
+    uint32_t klen;
+    uint32_t vlen;
+} robin_kv_moved_t;
+
+static inline uint64_t robin_kv_record_size(uint32_t klen, uint32_t vlen)
+{
+    return RT_KV_RECORD_HEADER + (uint64_t)klen + (vlen == RT_KV_TOMBSTONE ? 0 : vlen);
+}
+
+static uint32_t robin_kv_checksum(const uint8_t* header, const void* key, uint32_t klen,
+                                  const void* val, uint32_t vlen)
+{
+    uint64_t hash = robin_table_xxh64(header + 4, 8, 0);
+
+    hash = robin_table_xxh64(key, klen, hash);
+    if (vlen != RT_KV_TOMBSTONE) {
+        hash = robin_table_xxh64(val, vlen, hash);
+    }
+    return (uint32_t)hash;
+}
+
+static inline uint32_t robin_kv_load32(const uint8_t* p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t robin_kv_load64(const uint8_t* p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*
+ * Return the malloc'ed path of a segment file.
+ */
+static char* robin_kv_path(const robin_table_kv_t* kv, uint64_t id, const char* ext,
+                           bool tmp)
+{
+    size_t len = strlen(kv->dir) + 64;
+    char* path = malloc(len);
+
+    if (path) {
+        snprintf(path, len, "%s/%016" PRIx64 "%s%s", kv->dir, id, ext, tmp ? RT_KV_TMP_EXT : "");
+    }
+    return path;
+}
+
+static robin_kv_segment_t* robin_kv_segment_open(robin_table_kv_t* kv, uint64_t id, int flags)
+{
+    robin_kv_segment_t* seg;
+    struct stat st;
+    char* path;
+
+    seg = malloc(sizeof(robin_kv_segment_t));
+    path = robin_kv_path(kv, id, RT_KV_DATA_EXT, false);
+    if (!seg || !path) {
+        free(seg);
+        free(path);
+        return NULL;
+    }
+
+    seg->fd = open(path, flags, 0644);
+    free(path);
+    if (seg->fd < 0 || fstat(seg->fd, &st) != 0) {
+        if (seg->fd >= 0) {
+            close(seg->fd);
+        }
+        free(seg);
+        return NULL;
+    }
+    seg->id = id;
+    seg->size = (uint64_t)st.st_size;
+    seg->dead = 0;
+    return seg;
+}
+
+/*
+ * Insert a segment into the list, keeping it sorted by id.
+ */
+static bool robin_kv_segment_add(robin_table_kv_t* kv, robin_kv_segment_t* seg)
+{
+    size_t i;
+
+    if (kv->seg_count == kv->seg_cap) {
+        size_t cap = kv->seg_cap ? kv->seg_cap * 2 : 8;
+        robin_kv_segment_t** segs = realloc(kv->segs, cap * sizeof(*segs));
+
+        if (!segs) {
+            return false;
+        }
+        kv->segs = segs;
+        kv->seg_cap = cap;
+    }
+
+    for (i = kv->seg_count; i > 0 && kv->segs[i - 1]->id > seg->id; --i) {
+        kv->segs[i] = kv->segs[i - 1];
+    }
+    kv->segs[i] = seg;
+    kv->seg_count++;
+    return true;
+}
+
+static inline robin_kv_segment_t* robin_kv_active(const robin_table_kv_t* kv)
+{
+    return kv->segs[kv->seg_count - 1];
+}
+
+/*
+ * Point the index entry of a key at a record, marking the record it
+ * replaces as dead. A NULL seg removes the key.
+ */
+static bool robin_kv_index(robin_table_kv_t* kv, const void* key, uint32_t klen,
+                           robin_kv_segment_t* seg, uint64_t off, uint32_t vlen)
+{
+    robin_kv_entry_t* entry = robin_table_get(kv->index, key, klen);
+
+    if (entry) {
+        entry->seg->dead += robin_kv_record_size(entry->klen, entry->vlen);
+        if (!seg) {
+            robin_table_del(kv->index, key, klen);
+            free(entry);
+            return true;
+        }
+    } else {
+        if (!seg) {
+            return true;
+        }
+        entry = malloc(sizeof(robin_kv_entry_t) + klen);
+        if (!entry) {
+            return false;
+        }
+        memcpy(entry->key, key, klen);
+        entry->klen = klen;
+        if (!robin_table_put(kv->index, entry->key, klen, entry)) {
+            free(entry);
+            return false;
+        }
+    }
+    entry->seg = seg;
+    entry->off = off;
+    entry->vlen = vlen;
+    return true;
+}
+
+/*
+ * Index the records of a data segment, stopping at the first torn or
+ * corrupt record.
+ */
+static bool robin_kv_replay(robin_table_kv_t* kv, robin_kv_segment_t* seg)
+{
+    const uint8_t* base;
+    uint64_t off = 0;
+    bool ok = true;
+
+    if (!seg->size) {
+        return true;
+    }
+    base = mmap(NULL, seg->size, PROT_READ, MAP_PRIVATE, seg->fd, 0);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    while (ok && seg->size - off >= RT_KV_RECORD_HEADER) {
+        const uint8_t* rec = base + off;
+        uint32_t klen = robin_kv_load32(rec + 4);
+        uint32_t vlen = robin_kv_load32(rec + 8);
+        uint64_t size = robin_kv_record_size(klen, vlen);
+
+        if (!klen || size > seg->size - off ||
+            robin_kv_load32(rec) != robin_kv_checksum(rec, rec + RT_KV_RECORD_HEADER, klen,
+                                                      rec + RT_KV_RECORD_HEADER + klen, vlen)) {
+            break;
+        }
+        if (vlen == RT_KV_TOMBSTONE) {
+            seg->dead += size;
+            ok = robin_kv_index(kv, rec + RT_KV_RECORD_HEADER, klen, NULL, 0, 0);
+        } else {
+            ok = robin_kv_index(kv, rec + RT_KV_RECORD_HEADER, klen, seg, off, vlen);
+        }
+        off += size;
+    }
+
+    /* Anything past the last valid record is never read */
+    seg->dead += seg->size - off;
+    munmap((void*)base, seg->size);
+    return ok;
+}
+
+/*
+ * Index the records listed by the hint file of a compacted segment. The
+ * hint file ends with the xxh64 checksum of its contents.
+ *
+ * => Return false if there is no valid hint file.
+ */
+static bool robin_kv_load_hints(robin_table_kv_t* kv, robin_kv_segment_t* seg)
+{
+    const uint8_t* base;
+    struct stat st;
+    uint64_t off = 0;
+    uint64_t size;
+    char* path;
+    bool ok;
+    int fd;
+
+    path = robin_kv_path(kv, seg->id, RT_KV_HINT_EXT, false);
+    fd = path ? open(path, O_RDONLY) : -1;
+    free(path);
+    if (fd < 0) {
+        return false;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < 8) {
+        close(fd);
+        return false;
+    }
+    size = (uint64_t)st.st_size - 8;
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    ok = robin_kv_load64(base + size) == robin_table_xxh64(base, size, 0);
+    while (ok && off < size) {
+        const uint8_t* hint = base + off;
+        uint32_t klen, vlen;
+        uint64_t rec_off;
+
+        if (size - off < RT_KV_HINT_HEADER) {
+            ok = false;
+            break;
+        }
+        klen = robin_kv_load32(hint);
+        vlen = robin_kv_load32(hint + 4);
+        rec_off = robin_kv_load64(hint + 8);
+        if (!klen || vlen == RT_KV_TOMBSTONE || klen > size - off - RT_KV_HINT_HEADER ||
+            rec_off > seg->size || robin_kv_record_size(klen, vlen) > seg->size - rec_off) {
+            ok = false;
+            break;
+        }
+        ok = robin_kv_index(kv, hint + RT_KV_HINT_HEADER, klen, seg, rec_off, vlen);
+        off += RT_KV_HINT_HEADER + klen;
+    }
+
+    munmap((void*)base, (size_t)st.st_size);
+    return ok;
+}
+
+/*
+ * Open every segment of the directory and rebuild the index, then start a
+ * new active segment.
+ */
+static bool robin_kv_recover(robin_table_kv_t* kv)
+{
+    robin_kv_segment_t* seg;
+    struct dirent* de;
+    uint64_t next_id = 0;
+    DIR* dp;
+
+    dp = opendir(kv->dir);
+    if (!dp) {
+        return false;
+    }
+    while ((de = readdir(dp)) != NULL) {
+        const size_t len = strlen(de->d_name);
+        char* end;
+        uint64_t id;
+
+        if (len != 16 + strlen(RT_KV_DATA_EXT) ||
+            strcmp(de->d_name + 16, RT_KV_DATA_EXT) != 0) {
+            continue;
+        }
+        id = strtoull(de->d_name, &end, 16);
+        if (end != de->d_name + 16) {
+            continue;
+        }
+        seg = robin_kv_segment_open(kv, id, O_RDONLY);
+        if (!seg || !robin_kv_segment_add(kv, seg)) {
+            if (seg) {
+                close(seg->fd);
+            }
+            free(seg);
+            closedir(dp);
+            return false;
+        }
+    }
+    closedir(dp);
+
+    for (size_t i = 0; i < kv->seg_count; ++i) {
+        seg = kv->segs[i];
+
+        /* Hint files only exist for compacted segments, which are never torn */
+        if (!(seg->id & 1) || !robin_kv_load_hints(kv, seg)) {
+            if (!robin_kv_replay(kv, seg)) {
+                return false;
+            }
+        }
+        next_id = (seg->id + 2) & ~(uint64_t)1;
+    }
+
+    seg = robin_kv_segment_open(kv, next_id, O_RDWR | O_CREAT | O_TRUNC);
+    if (!seg || !robin_kv_segment_add(kv, seg)) {
+        if (seg) {
+            close(seg->fd);
+        }
+        free(seg);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Seal the active segment and start a new one.
+ *
+ * => Called with the write lock held.
+ * => If wake is set, wake up the compactor once half of the sealed bytes
+ *    are dead.
+ */
+static bool robin_kv_rotate(robin_table_kv_t* kv, bool wake)
+{
+    robin_kv_segment_t* seg;
+    uint64_t sealed = 0;
+    uint64_t dead = 0;
+
+    seg = robin_kv_segment_open(kv, robin_kv_active(kv)->id + 2, O_RDWR | O_CREAT | O_TRUNC);
+    if (!seg || !robin_kv_segment_add(kv, seg)) {
+        if (seg) {
+            close(seg->fd);
+        }
+        free(seg);
+        return false;
+    }
+
+    for (size_t i = 0; i + 1 < kv->seg_count; ++i) {
+        sealed += kv->segs[i]->size;
+        dead += kv->segs[i]->dead;
+    }
+    if (wake && dead && dead * 2 >= sealed) {
+        pthread_mutex_lock(&kv->bg_lock);
+        kv->bg_pending = true;
+        pthread_cond_signal(&kv->bg_cond);
+        pthread_mutex_unlock(&kv->bg_lock);
+    }
+    return true;
+}
+
+/*
+ * Append a record to the active segment and update the index.
+ *
+ * => On failure, the record is cut off the segment again, so neither the
+ *    index nor a later replay sees it.
+ */
+static bool robin_kv_append(robin_table_kv_t* kv, const void* key, size_t klen,
+                            const void* val, uint32_t vlen)
+{
+    const uint64_t size = robin_kv_record_size((uint32_t)klen, vlen);
+    const uint32_t klen32 = (uint32_t)klen;
+    robin_kv_segment_t* seg;
+    uint32_t check;
+    uint8_t* rec;
+    bool ok;
+
+    rec = malloc(size);
+    if (!rec) {
+        return false;
+    }
+    memcpy(rec + 4, &klen32, 4);
+    memcpy(rec + 8, &vlen, 4);
+    memcpy(rec + RT_KV_RECORD_HEADER, key, klen);
+    if (vlen && vlen != RT_KV_TOMBSTONE) {
+        memcpy(rec + RT_KV_RECORD_HEADER + klen, val, vlen);
+    }
+    check = robin_kv_checksum(rec, key, klen32, rec + RT_KV_RECORD_HEADER + klen, vlen);
+    memcpy(rec, &check, 4);
+
+    pthread_rwlock_wrlock(&kv->lock);
+
+    seg = robin_kv_active(kv);
+    if (seg->size && seg->size + size > kv->segment_size) {
+        if (!robin_kv_rotate(kv, true)) {
+            pthread_rwlock_unlock(&kv->lock);
+            free(rec);
+            return false;
+        }
+        seg = robin_kv_active(kv);
+    }
+
+    ok = pwrite(seg->fd, rec, size, (off_t)seg->size) == (ssize_t)size;
+    if (ok) {
+        /* Only adding a new key to the index can fail, which changes nothing */
+        if (vlen == RT_KV_TOMBSTONE) {
+            ok = robin_kv_index(kv, key, (uint32_t)klen, NULL, 0, 0);
+            if (ok) {
+                seg->dead += size;
+            }
+        } else {
+            ok = robin_kv_index(kv, key, (uint32_t)klen, seg, seg->size, vlen);
+        }
+    }
+    if (ok) {
+        seg->size += size;
+    } else if (ftruncate(seg->fd, (off_t)seg->size) != 0) {
+        /* Should this fail too, the next record overwrites the leftover bytes */
+    }
+
+    pthread_rwlock_unlock(&kv->lock);
+    free(rec);
+    return ok;
+}
+
+static void* robin_kv_compactor(void* arg)
+{
+    robin_table_kv_t* kv = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&kv->bg_lock);
+        while (!kv->bg_pending && !kv->bg_stop) {
+            pthread_cond_wait(&kv->bg_cond, &kv->bg_lock);
+        }
+        kv->bg_pending = false;
+        if (kv->bg_stop) {
+            pthread_mutex_unlock(&kv->bg_lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&kv->bg_lock);
+
+        robin_table_kv_compact(kv);
+    }
+}
+
+static bool robin_kv_free_entry(const void* key, size_t klen, void* val, void* ctx)
+{
+    (void)key;
+    (void)klen;
+    (void)ctx;
+    free(val);
+    return true;
+}
+
+static void robin_kv_release(robin_table_kv_t* kv)
+{
+    for (size_t i = 0; i < kv->seg_count; ++i) {
+        close(kv->segs[i]->fd);
+        free(kv->segs[i]);
+    }
+    if (kv->index) {
+        robin_table_for_each(kv->index, robin_kv_free_entry, NULL);
+        robin_table_destroy(kv->index);
+    }
+    pthread_rwlock_destroy(&kv->lock);
+    pthread_mutex_destroy(&kv->compact_lock);
+    pthread_mutex_destroy(&kv->bg_lock);
+    pthread_cond_destroy(&kv->bg_cond);
+    free(kv->segs);
+    free(kv->dir);
+    free(kv);
+}
+
+/*
+ * Open the log-structured key-value store in directory dir, which must
+ * exist, rebuilding its index from the hint files of compacted segments
+ * and by replaying the other segments. A record torn by a crash ends the
+ * replay of its segment.
+ *
+ * => segment_size is the size at which the active segment is sealed, or 0
+ *    for the default.
+ * => A background thread compacts the sealed segments once half of their
+ *    bytes belong to overwritten or deleted records.
+ * => All functions may be called from any thread.
+ */
+robin_table_kv_t* robin_table_kv_open(const char* dir, size_t segment_size)
+{
+    RT_ASSERT(dir != NULL);
+
+    robin_table_kv_t* kv;
+
+    kv = calloc(1, sizeof(robin_table_kv_t));
+    if (!kv) {
+        return NULL;
+    }
+    kv->dir = malloc(strlen(dir) + 1);
+    kv->index = robin_table_create(0, NULL, 0);
+    kv->segment_size = segment_size ? segment_size : RT_KV_SEGMENT_SIZE;
+    pthread_rwlock_init(&kv->lock, NULL);
+    pthread_mutex_init(&kv->compact_lock, NULL);
+    pthread_mutex_init(&kv->bg_lock, NULL);
+    pthread_cond_init(&kv->bg_cond, NULL);
+    if (!kv->dir || !kv->index) {
+        robin_kv_release(kv);
+        return NULL;
+    }
+    strcpy(kv->dir, dir);
+
+    if (!robin_kv_recover(kv) ||
+        pthread_create(&kv->bg_thread, NULL, robin_kv_compactor, kv) != 0) {
+        robin_kv_release(kv);
+        return NULL;
+    }
+    return kv;
+}
+
+/*
+ * Stop the background compaction and close the store. Records written
+ * since the last robin_table_kv_sync are flushed by the operating system.
+ */
+void robin_table_kv_close(robin_table_kv_t* kv)
+{
+    if (!kv) {
+        return;
+    }
+
+    pthread_mutex_lock(&kv->bg_lock);
+    kv->bg_stop = true;
+    pthread_cond_signal(&kv->bg_cond);
+    pthread_mutex_unlock(&kv->bg_lock);
+    pthread_join(kv->bg_thread, NULL);
+
+    robin_kv_release(kv);
+}
+
+/*
+ * Store a copy of a value under a key.
+ *
+ * => Keys and values are limited to 4GB.
+ * => Return false on I/O or allocation failure.
+ */
+bool robin_table_kv_put(robin_table_kv_t* kv, const void* key, size_t klen, const void* val,
+                        size_t vlen)
+{
+    RT_ASSERT(kv != NULL);
+    RT_ASSERT(key != NULL && klen > 0 && klen < UINT32_MAX);
+    RT_ASSERT(val != NULL || vlen == 0);
+    RT_ASSERT(vlen < RT_KV_TOMBSTONE);
+
+    return robin_kv_append(kv, key, klen, val, (uint32_t)vlen);
+}
+
+/*
+ * Remove a key by appending a deletion record.
+ *
+ * => Return false if the key is not found, or on I/O or allocation failure.
+ */
+bool robin_table_kv_del(robin_table_kv_t* kv, const void* key, size_t klen)
+{
+    RT_ASSERT(kv != NULL);
+    RT_ASSERT(key != NULL && klen > 0 && klen < UINT32_MAX);
+
+    bool found;
+
+    pthread_rwlock_rdlock(&kv->lock);
+    found = robin_table_get(kv->index, key, klen) != NULL;
+    pthread_rwlock_unlock(&kv->lock);
+
+    return found && robin_kv_append(kv, key, klen, NULL, RT_KV_TOMBSTONE);
+}
+
+/*
+ * Read the value of a key with a single index lookup and a single pread.
+ *
+ * => At most cap bytes of the value are copied to buf, and *vlen is set to
+ *    the full length of the value.
+ * => Return false if the key is not found or on I/O failure.
+ */
+bool robin_table_kv_get(robin_table_kv_t* kv, const void* key, size_t klen, void* buf,
+                        size_t cap, size_t* vlen)
+{
+    RT_ASSERT(kv != NULL);
+    RT_ASSERT(key != NULL && klen > 0);
+    RT_ASSERT(buf != NULL || cap == 0);
+
+    robin_kv_entry_t* entry;
+    size_t len;
+    bool ok = false;
+
+    pthread_rwlock_rdlock(&kv->lock);
+
+    entry = robin_table_get(kv->index, key, klen);
+    if (entry) {
+        len = entry->vlen < cap ? entry->vlen : cap;
+        ok = !len || pread(entry->seg->fd, buf, len,
+                           (off_t)(entry->off + RT_KV_RECORD_HEADER + entry->klen)) ==
+                         (ssize_t)len;
+        if (vlen) {
+            *vlen = entry->vlen;
+        }
+    }
+
+    pthread_rwlock_unlock(&kv->lock);
+    return ok;
+}
+
+/*
+ * Return the number of live keys in the store.
+ */
+size_t robin_table_kv_count(robin_table_kv_t* kv)
+{
+    RT_ASSERT(kv != NULL);
+
+    size_t count;
+
+    pthread_rwlock_rdlock(&kv->lock);
+    count = robin_table_count(kv->index);
+    pthread_rwlock_unlock(&kv->lock);
+    return count;
+}
+
+/*
+ * Flush the records written so far to stable storage.
+ */
+bool robin_table_kv_sync(robin_table_kv_t* kv)
+{
+    RT_ASSERT(kv != NULL);
+
+    bool ok;
+
+    pthread_rwlock_rdlock(&kv->lock);
+    ok = fsync(robin_kv_active(kv)->fd) == 0;
+    pthread_rwlock_unlock(&kv->lock);
+    return ok;
+}
+
+/*
+ * Copy the live records of the sealed segments to the compaction output
+ * and its hint file, remembering where each record moved.
+ */
+static bool robin_kv_copy_live(robin_table_kv_t* kv, robin_kv_segment_t** sealed, size_t n,
+                               FILE* data, FILE* hint, robin_kv_moved_t** moved,
+                               size_t* moved_count, uint8_t** keys, uint64_t* hint_check)
+{
+    size_t moved_cap = 0, keys_len = 0, keys_cap = 0;
+    uint64_t new_off = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        robin_kv_segment_t* seg = sealed[i];
+        const uint8_t* base;
+        uint64_t off = 0;
+
+        if (!seg->size) {
+            continue;
+        }
+        base = mmap(NULL, seg->size, PROT_READ, MAP_PRIVATE, seg->fd, 0);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+
+        while (seg->size - off >= RT_KV_RECORD_HEADER) {
+            const uint8_t* rec = base + off;
+            uint32_t klen = robin_kv_load32(rec + 4);
+            uint32_t vlen = robin_kv_load32(rec + 8);
+            uint64_t size = robin_kv_record_size(klen, vlen);
+            robin_kv_entry_t* entry;
+            uint8_t hint_header[RT_KV_HINT_HEADER];
+            bool live;
+
+            /* Records past a torn one were never indexed */
+            if (!klen || size > seg->size - off) {
+                break;
+            }
+
+            pthread_rwlock_rdlock(&kv->lock);
+            entry = robin_table_get(kv->index, rec + RT_KV_RECORD_HEADER, klen);
+            live = entry && entry->seg == seg && entry->off == off;
+            pthread_rwlock_unlock(&kv->lock);
+
+            if (live) {
+                if (*moved_count == moved_cap || keys_len + klen > keys_cap) {
+                    robin_kv_moved_t* m;
+                    uint8_t* k;
+
+                    moved_cap = moved_cap ? moved_cap * 2 : 1024;
+                    keys_cap = (keys_cap + klen) * 2;
+                    m = realloc(*moved, moved_cap * sizeof(*m));
+                    if (m) {
+                        *moved = m;
+                    }
+                    k = realloc(*keys, keys_cap);
+                    if (k) {
+                        *keys = k;
+                    }
+                    if (!m || !k) {
+                        munmap((void*)base, seg->size);
+                        return false;
+                    }
+                }
+
+                memcpy(hint_header, &klen, 4);
+                memcpy(hint_header + 4, &vlen, 4);
+                memcpy(hint_header + 8, &new_off, 8);
+                *hint_check = robin_table_xxh64(hint_header, sizeof(hint_header), *hint_check);
+                *hint_check = robin_table_xxh64(rec + RT_KV_RECORD_HEADER, klen, *hint_check);
+
+                if (fwrite(rec, 1, size, data) != size ||
+                    fwrite(hint_header, 1, sizeof(hint_header), hint) != sizeof(hint_header) ||
+                    fwrite(rec + RT_KV_RECORD_HEADER, 1, klen, hint) != klen) {
+                    munmap((void*)base, seg->size);
+                    return false;
+                }
+
+                memcpy(*keys + keys_len, rec + RT_KV_RECORD_HEADER, klen);
+                (*moved)[*moved_count] = (robin_kv_moved_t){seg, off, new_off, keys_len, klen,
+                                                            vlen};
+                (*moved_count)++;
+                keys_len += klen;
+                new_off += size;
+            }
+            off += size;
+        }
+        munmap((void*)base, seg->size);
+    }
+    return true;
+}
+
+/*
+ * Write the compaction output and its hint file under temporary names,
+ * then rename them into place once they are on stable storage.
+ */
+static bool robin_kv_write_output(robin_table_kv_t* kv, uint64_t id,
+                                  robin_kv_segment_t** sealed, size_t n,
+                                  robin_kv_moved_t** moved, size_t* moved_count,
+                                  uint8_t** keys)
+{
+    char* data_tmp = robin_kv_path(kv, id, RT_KV_DATA_EXT, true);
+    char* hint_tmp = robin_kv_path(kv, id, RT_KV_HINT_EXT, true);
+    char* data_path = robin_kv_path(kv, id, RT_KV_DATA_EXT, false);
+    char* hint_path = robin_kv_path(kv, id, RT_KV_HINT_EXT, false);
+    FILE* data = data_tmp ? fopen(data_tmp, "wb") : NULL;
+    FILE* hint = hint_tmp ? fopen(hint_tmp, "wb") : NULL;
+    uint64_t hint_check = 0;
+    bool ok;
+
+    ok = data && hint && hint_path && data_path &&
+         robin_kv_copy_live(kv, sealed, n, data, hint, moved, moved_count, keys,
+                            &hint_check) &&
+         fwrite(&hint_check, 1, sizeof(hint_check), hint) == sizeof(hint_check) &&
+         fflush(data) == 0 && fflush(hint) == 0 && fsync(fileno(data)) == 0 &&
+         fsync(fileno(hint)) == 0;
+
+    ok = (!data || fclose(data) == 0) && ok;
+    ok = (!hint || fclose(hint) == 0) && ok;
+
+    /* The data file goes first: a data file without hints is replayed */
+    ok = ok && rename(data_tmp, data_path) == 0 && rename(hint_tmp, hint_path) == 0;
+    if (!ok && data_tmp && hint_tmp) {
+        remove(data_tmp);
+        remove(hint_tmp);
+    }
+
+    free(data_tmp);
+    free(hint_tmp);
+    free(data_path);
+    free(hint_path);
+    return ok;
+}
+
+/*
+ * Replace the sealed segments by the compaction output: redirect the index
+ * entries of the records that are still live and remove the old files.
+ *
+ * => Called with the write lock held.
+ */
+static void robin_kv_install(robin_table_kv_t* kv, robin_kv_segment_t* out,
+                             const robin_kv_moved_t* moved, size_t moved_count,
+                             const uint8_t* keys, size_t n)
+{
+    size_t j = 0;
+
+    for (size_t i = 0; i < moved_count; ++i) {
+        const robin_kv_moved_t* m = moved + i;
+        robin_kv_entry_t* entry = robin_table_get(kv->index, keys + m->key_off, m->klen);
+
+        if (entry && entry->seg == m->seg && entry->off == m->old_off) {
+            entry->seg = out;
+            entry->off = m->new_off;
+        } else {
+            out->dead += robin_kv_record_size(m->klen, m->vlen);
+        }
+    }
+
+    /* The sealed segments are the first n ones */
+    for (size_t i = 0; i < n; ++i) {
+        robin_kv_segment_t* seg = kv->segs[i];
+        char* path;
+
+        close(seg->fd);
+        if ((path = robin_kv_path(kv, seg->id, RT_KV_DATA_EXT, false)) != NULL) {
+            remove(path);
+            free(path);
+        }
+        if ((path = robin_kv_path(kv, seg->id, RT_KV_HINT_EXT, false)) != NULL) {
+            remove(path);
+            free(path);
+        }
+        free(seg);
+    }
+    for (size_t i = n; i < kv->seg_count; ++i) {
+        kv->segs[j++] = kv->segs[i];
+    }
+    kv->seg_count = j;
+}
+
+/*
+ * Merge all sealed segments into one compacted segment with a hint file,
+ * dropping overwritten and deleted records. Reads and writes proceed
+ * while the live records are copied; the index is only locked to check
+ * each record and to install the result.
+ *
+ * => Called by the background thread, and may be called directly.
+ * => Return false on I/O or allocation failure, leaving the store as it
+ *    was.
+ */
+bool robin_table_kv_compact(robin_table_kv_t* kv)
+{
+    RT_ASSERT(kv != NULL);
+
+    robin_kv_segment_t** sealed = NULL;
+    robin_kv_segment_t* out = NULL;
+    robin_kv_moved_t* moved = NULL;
+    uint8_t* keys = NULL;
+    size_t moved_count = 0;
+    size_t n;
+    uint64_t id;
+    bool ok;
+
+    pthread_mutex_lock(&kv->compact_lock);
+
+    /* Seal the active segment, so that the output id lies before the new one */
+    pthread_rwlock_wrlock(&kv->lock);
+    ok = robin_kv_rotate(kv, false);
+    n = kv->seg_count - 1;
+    id = robin_kv_active(kv)->id - 1;
+    sealed = ok ? malloc(n * sizeof(*sealed)) : NULL;
+    if (sealed) {
+        memcpy(sealed, kv->segs, n * sizeof(*sealed));
+    }
+    pthread_rwlock_unlock(&kv->lock);
+
+    ok = sealed && robin_kv_write_output(kv, id, sealed, n, &moved, &moved_count, &keys);
+    if (ok) {
+        out = robin_kv_segment_open(kv, id, O_RDONLY);
+        ok = out != NULL;
+    }
+
+    if (ok) {
+        pthread_rwlock_wrlock(&kv->lock);
+        ok = robin_kv_segment_add(kv, out);
+        if (ok) {
+            /* The output sorts after the sealed segments it replaces */
+            robin_kv_install(kv, out, moved, moved_count, keys, n);
+        }
+        pthread_rwlock_unlock(&kv->lock);
+        if (!ok) {
+            close(out->fd);
+            free(out);
+        }
+    }
+
+    pthread_mutex_unlock(&kv->compact_lock);
+    free(sealed);
+    free(moved);
+    free(keys);
+    return ok;
+}
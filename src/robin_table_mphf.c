@@ -0,0 +1,348 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/* Average number of keys per group */
+#define RT_MPHF_GROUP_SIZE        4U
+
+/* Extra slots per hundred keys, remapped into the free slots below count */
+#define RT_MPHF_EXTRA_PCT         1U
+
+/* Pilots tried for a group before giving up */
+#define RT_MPHF_PILOT_MAX         (1U << 24)
+
+/*
+ * The perfect hash follows the hash-and-displace scheme: keys are split
+ * into groups by their hash value, and every group gets a pilot, chosen so
+ * that the keys of the group land on free slots. The groups are placed
+ * largest first, while most slots are still free. A few more slots than
+ * keys make the last placements cheap; the keys that land on a slot past
+ * count are then moved to the slots left free below it, through the remap
+ * array, so that the table is minimal.
+ */
+static inline uint64_t robin_mphf_mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/*
+ * Map the top 32 bits of a hash value onto [0, range).
+ */
+static inline size_t robin_mphf_range(uint64_t hash, size_t range)
+{
+    return (size_t)(((hash >> 32) * (uint64_t)range) >> 32);
+}
+
+static inline size_t robin_mphf_group(const robin_table_mphf_t* mp, uint64_t hash)
+{
+    return robin_mphf_range(hash, mp->group_count);
+}
+
+static inline size_t robin_mphf_slot(const robin_table_mphf_t* mp, uint64_t hash,
+                                     uint32_t pilot)
+{
+    return robin_mphf_range(robin_mphf_mix(hash ^ robin_mphf_mix(pilot + 1)), mp->slot_count);
+}
+
+/*
+ * Find a pilot that places every key of a group on a distinct free slot.
+ *
+ * => Return false if no pilot is found.
+ */
+static bool robin_mphf_place(robin_table_mphf_t* mp, const uint64_t* hashes,
+                             const size_t* keys, size_t n, uint64_t* taken, size_t* slots,
+                             uint32_t* pilot)
+{
+    for (uint32_t p = 0; p < RT_MPHF_PILOT_MAX; ++p) {
+        size_t i;
+
+        for (i = 0; i < n; ++i) {
+            const size_t slot = robin_mphf_slot(mp, hashes[keys[i]], p);
+
+            if (taken[slot / 64] & ((uint64_t)1 << (slot % 64))) {
+                break;
+            }
+            taken[slot / 64] |= (uint64_t)1 << (slot % 64);
+            slots[i] = slot;
+        }
+        if (i == n) {
+            *pilot = p;
+            return true;
+        }
+
+        /* Release the slots taken by this attempt */
+        while (i--) {
+            taken[slots[i] / 64] &= ~((uint64_t)1 << (slots[i] % 64));
+        }
+    }
+    return false;
+}
+
+/*
+ * Place every group, largest first, and fill in the entries.
+ */
+static bool robin_mphf_build(robin_table_mphf_t* mp, const robin_bucket_t** src,
+                             const uint64_t* hashes, uint64_t* taken)
+{
+    size_t* starts;     /* Start of every group in the keys array */
+    size_t* keys;       /* Key indices sorted by group */
+    size_t* order;      /* Groups sorted by size, largest first */
+    size_t* sizes;      /* Number of groups of every size */
+    size_t slots[64];
+    size_t max_size = 0;
+    bool ok = true;
+
+    starts = calloc(mp->group_count + 1, sizeof(*starts));
+    keys = malloc((mp->count + 1) * sizeof(*keys));
+    order = malloc(mp->group_count * sizeof(*order));
+    sizes = NULL;
+    if (!starts || !keys || !order) {
+        free(starts);
+        free(keys);
+        free(order);
+        return false;
+    }
+
+    /* Counting sort of the keys by group */
+    for (size_t i = 0; i < mp->count; ++i) {
+        starts[robin_mphf_group(mp, hashes[i]) + 1]++;
+    }
+    for (size_t g = 0; g < mp->group_count; ++g) {
+        const size_t size = starts[g + 1];
+
+        max_size = size > max_size ? size : max_size;
+        starts[g + 1] += starts[g];
+    }
+    for (size_t i = 0; i < mp->count; ++i) {
+        keys[starts[robin_mphf_group(mp, hashes[i])]++] = i;
+    }
+    for (size_t g = mp->group_count; g > 0; --g) {
+        starts[g] = starts[g - 1];
+    }
+    starts[0] = 0;
+
+    /* Counting sort of the groups by decreasing size */
+    sizes = calloc(max_size + 2, sizeof(*sizes));
+    if (!sizes || max_size > sizeof(slots) / sizeof(slots[0])) {
+        ok = false;
+    }
+
+    /* Keys with equal hash values share a group, and no pilot separates them */
+    for (size_t g = 0; ok && g < mp->group_count; ++g) {
+        for (size_t i = starts[g]; ok && i < starts[g + 1]; ++i) {
+            for (size_t j = i + 1; ok && j < starts[g + 1]; ++j) {
+                ok = hashes[keys[i]] != hashes[keys[j]];
+            }
+        }
+    }
+    for (size_t g = 0; ok && g < mp->group_count; ++g) {
+        sizes[max_size - (starts[g + 1] - starts[g]) + 1]++;
+    }
+    for (size_t s = 0; ok && s <= max_size; ++s) {
+        sizes[s + 1] += sizes[s];
+    }
+    for (size_t g = 0; ok && g < mp->group_count; ++g) {
+        order[sizes[max_size - (starts[g + 1] - starts[g])]++] = g;
+    }
+
+    for (size_t i = 0; ok && i < mp->group_count; ++i) {
+        const size_t g = order[i];
+        const size_t n = starts[g + 1] - starts[g];
+
+        if (!n) {
+            break;
+        }
+        ok = robin_mphf_place(mp, hashes, keys + starts[g], n, taken, slots, mp->pilots + g);
+        for (size_t k = 0; ok && k < n; ++k) {
+            const robin_bucket_t* bucket = src[keys[starts[g] + k]];
+            robin_mphf_entry_t* entry = mp->entries + slots[k];
+
+            entry->key = bucket->key;
+            entry->val = bucket->val;
+            entry->klen = bucket->klen;
+        }
+    }
+
+    free(starts);
+    free(keys);
+    free(order);
+    free(sizes);
+    return ok;
+}
+
+/*
+ * Move the entries of the slots past count to the free slots below it.
+ */
+static void robin_mphf_remap(robin_table_mphf_t* mp, const uint64_t* taken)
+{
+    size_t free_slot = 0;
+
+    for (size_t slot = mp->count; slot < mp->slot_count; ++slot) {
+        if (!(taken[slot / 64] & ((uint64_t)1 << (slot % 64)))) {
+            continue;
+        }
+        while (taken[free_slot / 64] & ((uint64_t)1 << (free_slot % 64))) {
+            free_slot++;
+        }
+        mp->remap[slot - mp->count] = (uint32_t)free_slot;
+        mp->entries[free_slot] = mp->entries[slot];
+        free_slot++;
+    }
+}
+
+/*
+ * Build a read-only table over the current entries of a hash table, using a
+ * minimal perfect hash: each key maps to its own slot among exactly count
+ * slots, so a lookup reads the pilot of the key's group, then one slot,
+ * and compares one key. There are no empty slots and no probing.
+ *
+ * => The hash table is left unchanged; its keys must remain valid while
+ *    the read-only table is in use.
+ * => The stored hash values are reused, so no key is rehashed.
+ * => Return NULL on allocation failure, or if two keys have the same hash
+ *    value.
+ */
+robin_table_mphf_t* robin_table_freeze_mphf(const robin_table_t* rt)
+{
+    RT_ASSERT(rt != NULL);
+    RT_ASSERT(rt->count < UINT32_MAX);
+
+    robin_table_mphf_t* mp;
+    const robin_bucket_t** src;
+    uint64_t* hashes;
+    uint64_t* taken;
+    size_t n = 0;
+    bool ok;
+
+    mp = calloc(1, sizeof(robin_table_mphf_t));
+    if (!mp) {
+        return NULL;
+    }
+    mp->count = rt->count;
+    mp->group_count = rt->count / RT_MPHF_GROUP_SIZE + 1;
+    mp->slot_count = rt->count + (rt->count * RT_MPHF_EXTRA_PCT) / 100 + 1;
+    mp->seed = rt->seed;
+    mp->hash_func = rt->hash_func;
+
+    /* The extra slots are scratch space until the remap */
+    mp->entries = calloc(mp->slot_count, sizeof(robin_mphf_entry_t));
+    mp->pilots = calloc(mp->group_count, sizeof(uint32_t));
+    mp->remap = calloc(mp->slot_count - mp->count, sizeof(uint32_t));
+    taken = calloc((mp->slot_count + 63) / 64, sizeof(uint64_t));
+    src = malloc((rt->count + 1) * sizeof(*src));
+    hashes = malloc((rt->count + 1) * sizeof(*hashes));
+
+    ok = mp->entries && mp->pilots && mp->remap && taken && src && hashes;
+    for (size_t i = 0; ok && i < rt->bucket_count; ++i) {
+        if (rt->buckets[i].key) {
+            src[n] = rt->buckets + i;
+            hashes[n] = rt->buckets[i].hash;
+            n++;
+        }
+    }
+
+    ok = ok && robin_mphf_build(mp, src, hashes, taken);
+    if (ok) {
+        robin_mphf_entry_t* entries;
+
+        robin_mphf_remap(mp, taken);
+
+        /* Drop the extra slots */
+        entries = realloc(mp->entries, (mp->count + 1) * sizeof(robin_mphf_entry_t));
+        mp->entries = entries ? entries : mp->entries;
+    }
+
+    free(taken);
+    free(src);
+    free(hashes);
+    if (!ok) {
+        robin_table_mphf_destroy(mp);
+        return NULL;
+    }
+    return mp;
+}
+
+void robin_table_mphf_destroy(robin_table_mphf_t* mp)
+{
+    if (!mp) {
+        return;
+    }
+
+    free(mp->entries);
+    free(mp->pilots);
+    free(mp->remap);
+    free(mp->key_arena);
+    free(mp);
+}
+
+/*
+ * Retrieve the value associated with a key from a read-only table.
+ *
+ * => Return the value, or NULL if the key is not found.
+ */
+void* robin_table_mphf_get(const robin_table_mphf_t* mp, const void* key, size_t klen)
+{
+    RT_ASSERT(mp != NULL);
+    RT_ASSERT(key != NULL && klen != 0);
+
+    const uint64_t hash = mp->hash_func(key, klen, mp->seed);
+    const robin_mphf_entry_t* entry;
+    size_t slot;
+
+    if (!mp->count) {
+        return NULL;
+    }
+
+    slot = robin_mphf_slot(mp, hash, mp->pilots[robin_mphf_group(mp, hash)]);
+    if (slot >= mp->count) {
+        slot = mp->remap[slot - mp->count];
+    }
+
+    entry = mp->entries + slot;
+    return entry->klen == klen && memcmp(entry->key, key, klen) == 0 ? entry->val : NULL;
+}
+
+/*
+ * Return the number of entries in a read-only table.
+ */
+size_t robin_table_mphf_count(const robin_table_mphf_t* mp)
+{
+    RT_ASSERT(mp != NULL);
+
+    return mp->count;
+}
@@ -0,0 +1,432 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/* Size of a cache line, used to keep the work queues apart */
+#define RT_CACHE_LINE_SIZE        64U
+
+/* Number of keys per chunk, the unit of work that is stolen */
+#define RT_POOL_CHUNK             1024U
+
+/*
+ * A work queue is a range of chunk indices packed into one word, the first
+ * chunk in the low 32 bits and the end in the high ones, so that the owner
+ * (taking from the front) and thieves (taking from the back) can both update
+ * it with a single CAS.
+ */
+#define RT_RANGE_BEGIN(r)         ((size_t)(uint32_t)(r))
+#define RT_RANGE_END(r)           ((size_t)((r) >> 32))
+#define RT_RANGE_MAKE(b, e)       (((uint64_t)(e) << 32) | (uint32_t)(b))
+
+typedef union {
+    uint64_t range;
+    char pad[RT_CACHE_LINE_SIZE];
+} robin_pool_queue_t;
+
+typedef struct {
+    void (*fn)(void* ctx, size_t begin, size_t end);
+    void* ctx;
+    size_t n;
+} robin_pool_job_t;
+
+typedef struct {
+    robin_table_pool_t* pool;
+    size_t id;
+} robin_pool_worker_t;
+
+struct robin_table_pool_t {
+    robin_pool_queue_t* queues;    /* One per worker, plus one for the caller */
+    pthread_t* threads;
+    robin_pool_worker_t* workers;
+    size_t thread_count;
+    pthread_mutex_t submit_lock;   /* Runs one job at a time */
+    pthread_mutex_t lock;
+    pthread_cond_t start_cond;
+    pthread_cond_t done_cond;
+    const robin_pool_job_t* job;
+    uint64_t generation;           /* Incremented for every job */
+    size_t active;                 /* Workers still working on the job */
+    bool stop;
+};
+
+/*
+ * Take the first chunk of a work queue.
+ *
+ * => Return false if the queue is empty.
+ */
+static bool robin_pool_pop(robin_pool_queue_t* queue, size_t* chunk)
+{
+    uint64_t range = __atomic_load_n(&queue->range, __ATOMIC_ACQUIRE);
+
+    while (RT_RANGE_BEGIN(range) < RT_RANGE_END(range)) {
+        const uint64_t next = RT_RANGE_MAKE(RT_RANGE_BEGIN(range) + 1, RT_RANGE_END(range));
+
+        if (__atomic_compare_exchange_n(&queue->range, &range, next, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *chunk = RT_RANGE_BEGIN(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Steal the back half of another queue into the (empty) queue of the thief.
+ *
+ * => Return false if every other queue is empty.
+ */
+static bool robin_pool_steal(robin_table_pool_t* pool, size_t self)
+{
+    const size_t queue_count = pool->thread_count + 1;
+
+    for (size_t i = 1; i < queue_count; ++i) {
+        robin_pool_queue_t* victim = pool->queues + (self + i) % queue_count;
+        uint64_t range = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+
+        while (RT_RANGE_BEGIN(range) < RT_RANGE_END(range)) {
+            const size_t begin = RT_RANGE_BEGIN(range);
+            const size_t end = RT_RANGE_END(range);
+            const size_t mid = end - (end - begin + 1) / 2;
+
+            if (__atomic_compare_exchange_n(&victim->range, &range, RT_RANGE_MAKE(begin, mid),
+                                            false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                __atomic_store_n(&pool->queues[self].range, RT_RANGE_MAKE(mid, end),
+                                 __ATOMIC_RELEASE);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*
+ * Run chunks from the own queue, then steal from the others until all of
+ * them are empty.
+ */
+static void robin_pool_work(robin_table_pool_t* pool, const robin_pool_job_t* job,
+                            size_t self)
+{
+    size_t chunk;
+
+    do {
+        while (robin_pool_pop(pool->queues + self, &chunk)) {
+            const size_t begin = chunk * RT_POOL_CHUNK;
+            const size_t end = begin + RT_POOL_CHUNK < job->n ? begin + RT_POOL_CHUNK : job->n;
+
+            job->fn(job->ctx, begin, end);
+        }
+    } while (robin_pool_steal(pool, self));
+}
+
+static void* robin_pool_thread(void* arg)
+{
+    robin_pool_worker_t* worker = arg;
+    robin_table_pool_t* pool = worker->pool;
+    uint64_t generation = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        const robin_pool_job_t* job;
+
+        while (!pool->stop && pool->generation == generation) {
+            pthread_cond_wait(&pool->start_cond, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        generation = pool->generation;
+        job = pool->job;
+        pthread_mutex_unlock(&pool->lock);
+
+        robin_pool_work(pool, job, worker->id);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/*
+ * Initialize the locks and condition variables of the pool, destroying the
+ * ones already initialized if one of them fails.
+ */
+static bool robin_pool_init_sync(robin_table_pool_t* pool)
+{
+    if (pthread_mutex_init(&pool->submit_lock, NULL)) {
+        return false;
+    }
+    if (pthread_mutex_init(&pool->lock, NULL)) {
+        pthread_mutex_destroy(&pool->submit_lock);
+        return false;
+    }
+    if (pthread_cond_init(&pool->start_cond, NULL)) {
+        pthread_mutex_destroy(&pool->lock);
+        pthread_mutex_destroy(&pool->submit_lock);
+        return false;
+    }
+    if (pthread_cond_init(&pool->done_cond, NULL)) {
+        pthread_cond_destroy(&pool->start_cond);
+        pthread_mutex_destroy(&pool->lock);
+        pthread_mutex_destroy(&pool->submit_lock);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Construct a pool of worker threads for the parallel batch operations.
+ *
+ * => The calling thread of a parallel operation works along, so a pool with
+ *    thread_count workers runs it on up to thread_count + 1 threads.
+ * => The threads live until robin_table_pool_destroy; no thread is started
+ *    by the library otherwise.
+ */
+robin_table_pool_t* robin_table_pool_create(size_t thread_count)
+{
+    robin_table_pool_t* pool;
+    void* queues;
+
+    pool = calloc(1, sizeof(robin_table_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+
+    if (posix_memalign(&queues, RT_CACHE_LINE_SIZE,
+                       (thread_count + 1) * sizeof(robin_pool_queue_t))) {
+        free(pool);
+        return NULL;
+    }
+    pool->queues = queues;
+    memset(pool->queues, 0, (thread_count + 1) * sizeof(robin_pool_queue_t));
+
+    pool->threads = calloc(thread_count + 1, sizeof(pthread_t));
+    pool->workers = calloc(thread_count + 1, sizeof(robin_pool_worker_t));
+    if (!pool->threads || !pool->workers || !robin_pool_init_sync(pool)) {
+        free(pool->threads);
+        free(pool->workers);
+        free(pool->queues);
+        free(pool);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+        if (pthread_create(&pool->threads[i], NULL, robin_pool_thread, &pool->workers[i])) {
+            robin_table_pool_destroy(pool);
+            return NULL;
+        }
+        ++pool->thread_count;
+    }
+    return pool;
+}
+
+/*
+ * Stop the worker threads and free the memory associated with the pool.
+ *
+ * => No parallel operation may be running on the pool.
+ */
+void robin_table_pool_destroy(robin_table_pool_t* pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->thread_count; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->submit_lock);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool->queues);
+    free(pool);
+}
+
+/*
+ * Split n items into chunks, spread them evenly over the work queues and
+ * run fn on every chunk, with idle threads stealing from busy ones.
+ */
+static void robin_pool_run(robin_table_pool_t* pool, void (*fn)(void*, size_t, size_t),
+                           void* ctx, size_t n)
+{
+    const size_t chunk_count = (n + RT_POOL_CHUNK - 1) / RT_POOL_CHUNK;
+    const size_t queue_count = pool->thread_count + 1;
+    robin_pool_job_t job = {fn, ctx, n};
+
+    RT_ASSERT(chunk_count <= UINT32_MAX);
+
+    /* Not worth waking up the workers */
+    if (chunk_count <= 1 || !pool->thread_count) {
+        fn(ctx, 0, n);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->submit_lock);
+    for (size_t i = 0; i < queue_count; ++i) {
+        pool->queues[i].range = RT_RANGE_MAKE(i * chunk_count / queue_count,
+                                              (i + 1) * chunk_count / queue_count);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->job = &job;
+    pool->active = pool->thread_count;
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    robin_pool_work(pool, &job, pool->thread_count);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pool->job = NULL;
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->submit_lock);
+}
+
+typedef struct {
+    robin_bucket_t* entries;
+    robin_bucket_t* tmp;
+    int (*cmp)(const void*, size_t, const void*, size_t);
+} robin_pool_sort_t;
+
+static void robin_pool_sort_chunk(void* ctx, size_t begin, size_t end)
+{
+    robin_pool_sort_t* sort = ctx;
+    robin_bucket_t* sorted = robin_table_export_sort(sort->entries + begin, sort->tmp + begin,
+                                                     end - begin, 1, sort->cmp);
+
+    if (sorted != sort->entries + begin) {
+        memcpy(sort->entries + begin, sorted, (end - begin) * sizeof(*sorted));
+    }
+}
+
+/*
+ * Sort every chunk of the entries in place on the threads of the pool, using
+ * tmp (of the same size) as scratch space.
+ *
+ * => Return the length of the sorted runs, which start at multiples of it.
+ */
+RT_INTERNAL size_t robin_pool_sort_runs(robin_table_pool_t* pool, robin_bucket_t* entries,
+                                        robin_bucket_t* tmp, size_t n,
+                                        int (*cmp)(const void*, size_t, const void*, size_t))
+{
+    robin_pool_sort_t sort = {entries, tmp, cmp};
+
+    robin_pool_run(pool, robin_pool_sort_chunk, &sort, n);
+    return RT_POOL_CHUNK;
+}
+
+typedef struct {
+    robin_table_t* rt;
+    robin_table_sharded_t* st;
+    const void* const* keys;
+    const size_t* klens;
+    void* const* vals;
+    void** vals_out;
+    bool failed;
+} robin_pool_batch_t;
+
+static void robin_pool_get_chunk(void* ctx, size_t begin, size_t end)
+{
+    robin_pool_batch_t* batch = ctx;
+
+    robin_table_get_batch(batch->rt, batch->keys + begin, batch->klens + begin, end - begin,
+                          batch->vals_out + begin);
+}
+
+static void robin_pool_sharded_put_chunk(void* ctx, size_t begin, size_t end)
+{
+    robin_pool_batch_t* batch = ctx;
+
+    if (!robin_table_sharded_put_batch(batch->st, batch->keys + begin, batch->klens + begin,
+                                       batch->vals + begin, end - begin,
+                                       batch->vals_out + begin)) {
+        __atomic_store_n(&batch->failed, true, __ATOMIC_RELAXED);
+    }
+}
+
+/*
+ * Retrieve the values of a batch of keys on the threads of the pool;
+ * vals_out[i] receives the value of the i-th key, or NULL.
+ *
+ * => The hash table must not be modified during the call.
+ */
+void robin_table_get_batch_parallel(robin_table_pool_t* pool, robin_table_t* rt,
+                                    const void* const* keys, const size_t* klens, size_t n,
+                                    void** vals_out)
+{
+    RT_ASSERT(pool != NULL);
+    RT_ASSERT(rt != NULL);
+
+    robin_pool_batch_t batch = {rt, NULL, keys, klens, NULL, vals_out, false};
+
+    robin_pool_run(pool, robin_pool_get_chunk, &batch, n);
+}
+
+/*
+ * Add a batch of entries to a sharded hash table on the threads of the pool;
+ * vals_out[i] receives the result robin_table_put would return for the i-th
+ * key.
+ *
+ * => The order in which duplicate keys of the batch are added is unspecified.
+ * => Return false on allocation failure, in which case only part of the
+ *    batch may have been added.
+ */
+bool robin_table_sharded_put_batch_parallel(robin_table_pool_t* pool,
+                                            robin_table_sharded_t* st,
+                                            const void* const* keys, const size_t* klens,
+                                            void* const* vals, size_t n, void** vals_out)
+{
+    RT_ASSERT(pool != NULL);
+    RT_ASSERT(st != NULL);
+
+    robin_pool_batch_t batch = {NULL, st, keys, klens, vals, vals_out, false};
+
+    robin_pool_run(pool, robin_pool_sharded_put_chunk, &batch, n);
+    return !batch.failed;
+}
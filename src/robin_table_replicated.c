@@ -0,0 +1,311 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/* Size of a cache line, used to keep the replicas apart */
+#define RT_CACHE_LINE_SIZE        64U
+
+/* Number of entries of the operation log; MUST be a power of two */
+#define RT_LOG_SIZE               1024U
+
+typedef enum {
+    RT_LOG_PUT,
+    RT_LOG_DEL
+} robin_log_op_t;
+
+typedef struct {
+    robin_log_op_t op;
+    const void* key;
+    size_t klen;
+    uint64_t hash;
+    void* val;
+} robin_log_entry_t;
+
+typedef struct {
+    pthread_mutex_t lock;   /* Held while applying the log */
+    robin_table_t* rt;      /* In SWMR mode: lookups take no lock */
+    uint64_t applied;       /* Log position up to which the replica is current */
+    size_t readers;         /* Lookups running on the replica without the lock */
+} robin_replica_data_t;
+
+typedef union {
+    robin_replica_data_t data;
+    char pad[RT_CACHE_LINE_SIZE *
+             ((sizeof(robin_replica_data_t) + RT_CACHE_LINE_SIZE - 1) / RT_CACHE_LINE_SIZE)];
+} robin_replica_t;
+
+struct robin_table_replicated_t {
+    robin_replica_t* replicas;
+    size_t replica_count;
+    uint64_t seed;
+    uint64_t (*hash_func)(const void*, size_t, uint64_t);
+    pthread_mutex_t write_lock;    /* Orders the writes in the log */
+    char pad[RT_CACHE_LINE_SIZE];
+    uint64_t tail;                 /* Log position of the next write */
+    robin_log_entry_t log[RT_LOG_SIZE];
+};
+
+/*
+ * Apply the log entries a replica has not seen yet.
+ */
+static void robin_replica_sync(robin_table_replicated_t* rr, robin_replica_data_t* replica)
+{
+    const uint64_t tail = __atomic_load_n(&rr->tail, __ATOMIC_ACQUIRE);
+
+    pthread_mutex_lock(&replica->lock);
+    for (uint64_t pos = replica->applied; pos < tail; ++pos) {
+        const robin_log_entry_t* entry = &rr->log[pos & (RT_LOG_SIZE - 1)];
+
+        if (entry->op == RT_LOG_PUT) {
+            robin_table_put_hashed(replica->rt, entry->key, entry->klen, entry->hash,
+                                   entry->val);
+        } else {
+            robin_table_del_hashed(replica->rt, entry->key, entry->klen, entry->hash);
+        }
+    }
+
+    /* The writer may reuse the log entries once they are marked applied */
+    if (replica->applied < tail) {
+        __atomic_store_n(&replica->applied, tail, __ATOMIC_RELEASE);
+
+        /*
+         * Free the bucket arrays replaced by growing once no lookup is running
+         * on the replica; lookups that start later see the new array.
+         */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (!__atomic_load_n(&replica->readers, __ATOMIC_SEQ_CST)) {
+            robin_table_swmr_reclaim(replica->rt);
+        }
+    }
+    pthread_mutex_unlock(&replica->lock);
+}
+
+/*
+ * Construct a replicated hash table with one replica per core (or NUMA
+ * node), each sized for the given number of entries.
+ */
+robin_table_replicated_t* robin_table_replicated_create(size_t replica_count, size_t count,
+                                                        uint64_t (*hash_func)(const void*,
+                                                                              size_t,
+                                                                              uint64_t),
+                                                        uint64_t seed)
+{
+    robin_table_replicated_t* rr;
+    void* mem;
+
+    RT_ASSERT(replica_count != 0);
+
+    if (posix_memalign(&mem, RT_CACHE_LINE_SIZE, sizeof(robin_table_replicated_t))) {
+        return NULL;
+    }
+    rr = mem;
+    memset(rr, 0, sizeof(*rr));
+    rr->hash_func = hash_func ? hash_func : RT_HASH_FUNC_DEFAULT;
+    rr->seed = seed;
+
+    if (posix_memalign(&mem, RT_CACHE_LINE_SIZE, replica_count * sizeof(robin_replica_t))) {
+        free(rr);
+        return NULL;
+    }
+    rr->replicas = mem;
+
+    if (pthread_mutex_init(&rr->write_lock, NULL)) {
+        free(rr->replicas);
+        free(rr);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < replica_count; ++i) {
+        robin_replica_data_t* replica = &rr->replicas[i].data;
+
+        replica->applied = 0;
+        replica->readers = 0;
+        replica->rt = robin_table_create(count, rr->hash_func, seed);
+        if (!replica->rt || pthread_mutex_init(&replica->lock, NULL)) {
+            robin_table_destroy(replica->rt);
+            robin_table_replicated_destroy(rr);
+            return NULL;
+        }
+        robin_table_swmr_enable(replica->rt);
+        ++rr->replica_count;
+    }
+    return rr;
+}
+
+/*
+ * Free the memory associated with the replicated hash table.
+ *
+ * => No other thread may be using the hash table.
+ */
+void robin_table_replicated_destroy(robin_table_replicated_t* rr)
+{
+    if (!rr) {
+        return;
+    }
+
+    for (size_t i = 0; i < rr->replica_count; ++i) {
+        robin_replica_data_t* replica = &rr->replicas[i].data;
+
+        pthread_mutex_destroy(&replica->lock);
+        robin_table_destroy(replica->rt);
+    }
+    pthread_mutex_destroy(&rr->write_lock);
+    free(rr->replicas);
+    free(rr);
+}
+
+/*
+ * Internal function to apply a write to the local replica and append it to
+ * the log; no-op writes are not logged.
+ *
+ * => The write lock orders all writes, and the local replica is brought up
+ *    to date under it, so the result is exact.
+ * => If the log is full, the writer brings the lagging replicas up to date.
+ */
+static void* robin_table_replicated_write(robin_table_replicated_t* rr, size_t replica_id,
+                                          robin_log_op_t op, const void* key, size_t klen,
+                                          void* val)
+{
+    RT_ASSERT(rr != NULL);
+    RT_ASSERT(replica_id < rr->replica_count);
+    RT_ASSERT(key != NULL && klen != 0);
+
+    const uint64_t hash = rr->hash_func(key, klen, rr->seed);
+    robin_replica_data_t* local = &rr->replicas[replica_id].data;
+    robin_log_entry_t* entry;
+    void* existing;
+    uint64_t tail;
+
+    pthread_mutex_lock(&rr->write_lock);
+    robin_replica_sync(rr, local);
+
+    existing = robin_table_get_hashed(local->rt, key, klen, hash);
+    if ((op == RT_LOG_PUT) == (existing != NULL)) {
+        pthread_mutex_unlock(&rr->write_lock);
+        return existing;
+    }
+
+    tail = rr->tail;
+    for (size_t i = 0; i < rr->replica_count; ++i) {
+        robin_replica_data_t* replica = &rr->replicas[i].data;
+
+        if (tail - __atomic_load_n(&replica->applied, __ATOMIC_ACQUIRE) >= RT_LOG_SIZE) {
+            robin_replica_sync(rr, replica);
+        }
+    }
+
+    entry = &rr->log[tail & (RT_LOG_SIZE - 1)];
+    entry->op = op;
+    entry->key = key;
+    entry->klen = klen;
+    entry->hash = hash;
+    entry->val = val;
+    __atomic_store_n(&rr->tail, tail + 1, __ATOMIC_RELEASE);
+
+    robin_replica_sync(rr, local);
+    pthread_mutex_unlock(&rr->write_lock);
+    return op == RT_LOG_PUT ? val : existing;
+}
+
+/*
+ * Add a new entry through the given replica; any thread may write through
+ * any replica.
+ *
+ * => Same semantics as robin_table_put.
+ */
+void* robin_table_replicated_put(robin_table_replicated_t* rr, size_t replica_id,
+                                 const void* key, size_t klen, void* val)
+{
+    RT_ASSERT(val != NULL);
+
+    return robin_table_replicated_write(rr, replica_id, RT_LOG_PUT, key, klen, val);
+}
+
+/*
+ * Remove an entry with the specified key through the given replica.
+ *
+ * => Return the associated value, or NULL, if the entry is not found.
+ */
+void* robin_table_replicated_del(robin_table_replicated_t* rr, size_t replica_id,
+                                 const void* key, size_t klen)
+{
+    return robin_table_replicated_write(rr, replica_id, RT_LOG_DEL, key, klen, NULL);
+}
+
+/*
+ * Retrieve the value associated with a given key from the given replica,
+ * which is first brought up to date with the log.
+ *
+ * => When the replica is current, the lookup only touches the log position
+ *    and the replica itself, without locks; it counts itself in the reader
+ *    counter of the replica so that replaced bucket arrays are not freed
+ *    under it.
+ */
+void* robin_table_replicated_get(robin_table_replicated_t* rr, size_t replica_id,
+                                 const void* key, size_t klen)
+{
+    RT_ASSERT(rr != NULL);
+    RT_ASSERT(replica_id < rr->replica_count);
+
+    robin_replica_data_t* replica = &rr->replicas[replica_id].data;
+    void* val;
+
+    if (__atomic_load_n(&replica->applied, __ATOMIC_ACQUIRE) !=
+        __atomic_load_n(&rr->tail, __ATOMIC_ACQUIRE)) {
+        robin_replica_sync(rr, replica);
+    }
+
+    __atomic_fetch_add(&replica->readers, 1, __ATOMIC_SEQ_CST);
+    val = robin_table_get_swmr(replica->rt, key, klen);
+    __atomic_fetch_sub(&replica->readers, 1, __ATOMIC_RELEASE);
+    return val;
+}
+
+/*
+ * Return the number of entries, as seen by the given replica.
+ */
+size_t robin_table_replicated_count(robin_table_replicated_t* rr, size_t replica_id)
+{
+    RT_ASSERT(rr != NULL);
+    RT_ASSERT(replica_id < rr->replica_count);
+
+    robin_replica_data_t* replica = &rr->replicas[replica_id].data;
+    size_t count;
+
+    robin_replica_sync(rr, replica);
+    pthread_mutex_lock(&replica->lock);
+    count = robin_table_count(replica->rt);
+    pthread_mutex_unlock(&replica->lock);
+    return count;
+}
@@ -0,0 +1,417 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+/* Size of a cache line, used to keep shard locks apart */
+#define RT_CACHE_LINE_SIZE        64U
+
+/* Number of keys ahead to prefetch in batch operations */
+#define RT_PREFETCH_DISTANCE      8U
+
+typedef struct {
+    pthread_mutex_t lock;
+    robin_table_t* rt;
+} robin_shard_data_t;
+
+/* Pad every shard to a whole number of cache lines to avoid false sharing */
+typedef union {
+    robin_shard_data_t data;
+    char pad[RT_CACHE_LINE_SIZE *
+             ((sizeof(robin_shard_data_t) + RT_CACHE_LINE_SIZE - 1) / RT_CACHE_LINE_SIZE)];
+} robin_shard_t;
+
+struct robin_table_sharded_t {
+    robin_shard_t* shards;
+    size_t shard_count;
+    unsigned shard_bits;
+    uint64_t seed;
+    uint64_t (*hash_func)(const void*, size_t, uint64_t);
+};
+
+/*
+ * Select the shard of a hash value from its top bits; the inner hash tables
+ * index their buckets with the low bits of the same hash value.
+ */
+static inline robin_shard_t* robin_table_sharded_shard(const robin_table_sharded_t* st,
+                                                       uint64_t hash)
+{
+    return st->shards + (st->shard_bits ? hash >> (64 - st->shard_bits) : 0);
+}
+
+/*
+ * Construct a new sharded hash table with the given number of shards, each
+ * an independently locked hash table sized for its share of count entries.
+ *
+ * => The number of shards is rounded up to the next power of two.
+ */
+robin_table_sharded_t* robin_table_sharded_create(size_t shard_count, size_t count,
+                                                  uint64_t (*hash_func)(const void*, size_t,
+                                                                        uint64_t),
+                                                  uint64_t seed)
+{
+    robin_table_sharded_t* st;
+    void* shards;
+
+    RT_ASSERT(shard_count != 0);
+
+    st = malloc(sizeof(robin_table_sharded_t));
+    if (!st) {
+        return NULL;
+    }
+
+    st->shard_bits = 0;
+    while (((size_t)1 << st->shard_bits) < shard_count) {
+        ++st->shard_bits;
+    }
+    st->shard_count = (size_t)1 << st->shard_bits;
+    st->hash_func = hash_func ? hash_func : RT_HASH_FUNC_DEFAULT;
+    st->seed = seed;
+
+    if (posix_memalign(&shards, RT_CACHE_LINE_SIZE, st->shard_count * sizeof(robin_shard_t))) {
+        free(st);
+        return NULL;
+    }
+    st->shards = shards;
+
+    for (size_t i = 0; i < st->shard_count; ++i) {
+        robin_shard_data_t* shard = &st->shards[i].data;
+
+        shard->rt = robin_table_create(count / st->shard_count, st->hash_func, seed);
+        if (!shard->rt || pthread_mutex_init(&shard->lock, NULL)) {
+            robin_table_destroy(shard->rt);
+            st->shard_count = i;
+            robin_table_sharded_destroy(st);
+            return NULL;
+        }
+    }
+    return st;
+}
+
+/*
+ * Free the memory associated with the sharded hash table.
+ */
+void robin_table_sharded_destroy(robin_table_sharded_t* st)
+{
+    if (!st) {
+        return;
+    }
+
+    for (size_t i = 0; i < st->shard_count; ++i) {
+        robin_shard_data_t* shard = &st->shards[i].data;
+
+        pthread_mutex_destroy(&shard->lock);
+        robin_table_destroy(shard->rt);
+    }
+    free(st->shards);
+    memset(st, 0, sizeof(*st));
+    free(st);
+}
+
+/*
+ * Add a new entry in the shard selected by the hash value of the key.
+ *
+ * => Same semantics as robin_table_put.
+ */
+void* robin_table_sharded_put(robin_table_sharded_t* st, const void* key, size_t klen,
+                              void* val)
+{
+    RT_ASSERT(st != NULL);
+
+    const uint64_t hash = st->hash_func(key, klen, st->seed);
+    robin_shard_data_t* shard = &robin_table_sharded_shard(st, hash)->data;
+
+    pthread_mutex_lock(&shard->lock);
+    val = robin_table_put_hashed(shard->rt, key, klen, hash, val);
+    pthread_mutex_unlock(&shard->lock);
+    return val;
+}
+
+/*
+ * Retrieve the value associated with a given key, or NULL if no entry exists.
+ */
+void* robin_table_sharded_get(robin_table_sharded_t* st, const void* key, size_t klen)
+{
+    RT_ASSERT(st != NULL);
+
+    const uint64_t hash = st->hash_func(key, klen, st->seed);
+    robin_shard_data_t* shard = &robin_table_sharded_shard(st, hash)->data;
+    void* val;
+
+    pthread_mutex_lock(&shard->lock);
+    val = robin_table_get_hashed(shard->rt, key, klen, hash);
+    pthread_mutex_unlock(&shard->lock);
+    return val;
+}
+
+/*
+ * Remove an entry with the specified key from the sharded hash table.
+ *
+ * => Return the associated value, or NULL, if the entry is not found.
+ */
+void* robin_table_sharded_del(robin_table_sharded_t* st, const void* key, size_t klen)
+{
+    RT_ASSERT(st != NULL);
+
+    const uint64_t hash = st->hash_func(key, klen, st->seed);
+    robin_shard_data_t* shard = &robin_table_sharded_shard(st, hash)->data;
+    void* val;
+
+    pthread_mutex_lock(&shard->lock);
+    val = robin_table_del_hashed(shard->rt, key, klen, hash);
+    pthread_mutex_unlock(&shard->lock);
+    return val;
+}
+
+typedef enum {
+    RT_BATCH_PUT,
+    RT_BATCH_GET,
+    RT_BATCH_DEL
+} robin_batch_op_t;
+
+/*
+ * Internal function to run a batch of operations grouped per shard, so that
+ * every shard lock is taken at most once per batch.
+ *
+ * => Keys of the same shard are processed in their original order.
+ */
+static bool robin_table_sharded_batch(robin_table_sharded_t* st, robin_batch_op_t op,
+                                      const void* const* keys, const size_t* klens,
+                                      void* const* vals, size_t n, void** vals_out)
+{
+    uint64_t* hashes;
+    size_t* order;
+    size_t* offsets;
+
+    RT_ASSERT(st != NULL);
+    RT_ASSERT(keys != NULL && klens != NULL && vals_out != NULL);
+
+    hashes = malloc(n * sizeof(*hashes) + n * sizeof(*order) +
+                    (st->shard_count + 1) * sizeof(*offsets));
+    if (!hashes) {
+        return false;
+    }
+    order = (size_t*)(hashes + n);
+    offsets = order + n;
+    memset(offsets, 0, (st->shard_count + 1) * sizeof(*offsets));
+
+    /* Hash every key once and count the keys per shard */
+    robin_table_hash_keys(st->hash_func, keys, klens, n, st->seed, hashes);
+    for (size_t i = 0; i < n; ++i) {
+        ++offsets[robin_table_sharded_shard(st, hashes[i]) - st->shards + 1];
+    }
+    for (size_t i = 0; i < st->shard_count; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    /* Stable counting sort of the key indices by shard */
+    for (size_t i = 0; i < n; ++i) {
+        order[offsets[robin_table_sharded_shard(st, hashes[i]) - st->shards]++] = i;
+    }
+
+    for (size_t i = 0, begin = 0; i < st->shard_count; ++i) {
+        robin_shard_data_t* shard = &st->shards[i].data;
+        const size_t end = offsets[i];
+
+        if (begin == end) {
+            continue;
+        }
+
+        pthread_mutex_lock(&shard->lock);
+        for (size_t j = begin; j < end; ++j) {
+            const size_t k = order[j];
+
+            if (j + RT_PREFETCH_DISTANCE < end) {
+                const size_t p = order[j + RT_PREFETCH_DISTANCE];
+                __builtin_prefetch(shard->rt->buckets + (hashes[p] & shard->rt->mask));
+            }
+
+            switch (op) {
+            case RT_BATCH_PUT:
+                vals_out[k] = robin_table_put_hashed(shard->rt, keys[k], klens[k], hashes[k],
+                                                     vals[k]);
+                break;
+            case RT_BATCH_GET:
+                vals_out[k] = robin_table_get_hashed(shard->rt, keys[k], klens[k], hashes[k]);
+                break;
+            case RT_BATCH_DEL:
+                vals_out[k] = robin_table_del_hashed(shard->rt, keys[k], klens[k], hashes[k]);
+                break;
+            }
+        }
+        pthread_mutex_unlock(&shard->lock);
+        begin = end;
+    }
+
+    free(hashes);
+    return true;
+}
+
+/*
+ * Add a batch of entries; vals_out[i] receives the result robin_table_put
+ * would return for the i-th key.
+ *
+ * => Return false on allocation failure, in which case nothing is added.
+ */
+bool robin_table_sharded_put_batch(robin_table_sharded_t* st, const void* const* keys,
+                                   const size_t* klens, void* const* vals, size_t n,
+                                   void** vals_out)
+{
+    RT_ASSERT(vals != NULL);
+
+    return robin_table_sharded_batch(st, RT_BATCH_PUT, keys, klens, vals, n, vals_out);
+}
+
+/*
+ * Retrieve the values of a batch of keys into vals_out (NULL if not found).
+ *
+ * => Return false on allocation failure.
+ */
+bool robin_table_sharded_get_batch(robin_table_sharded_t* st, const void* const* keys,
+                                   const size_t* klens, size_t n, void** vals_out)
+{
+    return robin_table_sharded_batch(st, RT_BATCH_GET, keys, klens, NULL, n, vals_out);
+}
+
+/*
+ * Remove a batch of keys; vals_out[i] receives the removed value, or NULL.
+ *
+ * => Return false on allocation failure, in which case nothing is removed.
+ */
+bool robin_table_sharded_del_batch(robin_table_sharded_t* st, const void* const* keys,
+                                   const size_t* klens, size_t n, void** vals_out)
+{
+    return robin_table_sharded_batch(st, RT_BATCH_DEL, keys, klens, NULL, n, vals_out);
+}
+
+/*
+ * Return the number of entries across all shards.
+ */
+size_t robin_table_sharded_count(robin_table_sharded_t* st)
+{
+    RT_ASSERT(st != NULL);
+
+    size_t count = 0;
+
+    for (size_t i = 0; i < st->shard_count; ++i) {
+        robin_shard_data_t* shard = &st->shards[i].data;
+
+        pthread_mutex_lock(&shard->lock);
+        count += robin_table_count(shard->rt);
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return count;
+}
+
+/*
+ * Return the maximum probe sequence length across all shards.
+ */
+size_t robin_table_sharded_psl_max(robin_table_sharded_t* st)
+{
+    RT_ASSERT(st != NULL);
+
+    size_t max_psl = 0;
+
+    for (size_t i = 0; i < st->shard_count; ++i) {
+        robin_shard_data_t* shard = &st->shards[i].data;
+
+        pthread_mutex_lock(&shard->lock);
+        if (robin_table_count(shard->rt)) {
+            size_t psl = robin_table_psl_max(shard->rt);
+            if (psl > max_psl) {
+                max_psl = psl;
+            }
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return max_psl;
+}
+
+/*
+ * Compute the mean and the variance of the probe sequence lengths across
+ * all shards by combining the per-shard statistics.
+ */
+static void robin_table_sharded_psl_stats(robin_table_sharded_t* st, double* mean,
+                                          double* variance)
+{
+    double count = 0;
+    double sum = 0;
+    double sum_sq = 0;
+
+    for (size_t i = 0; i < st->shard_count; ++i) {
+        robin_shard_data_t* shard = &st->shards[i].data;
+
+        pthread_mutex_lock(&shard->lock);
+        if (robin_table_count(shard->rt)) {
+            double n = (double)robin_table_count(shard->rt);
+            double m = robin_table_psl_mean(shard->rt);
+
+            count += n;
+            sum += n * m;
+            sum_sq += n * (robin_table_psl_variance(shard->rt) + m * m);
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+
+    RT_ASSERT(count != 0);
+
+    *mean = sum / count;
+    *variance = sum_sq / count - *mean * *mean;
+}
+
+/*
+ * Compute the average probe sequence length across all shards.
+ */
+double robin_table_sharded_psl_mean(robin_table_sharded_t* st)
+{
+    RT_ASSERT(st != NULL);
+
+    double mean;
+    double variance;
+
+    robin_table_sharded_psl_stats(st, &mean, &variance);
+    return mean;
+}
+
+/*
+ * Compute the variance of the probe sequence lengths across all shards.
+ */
+double robin_table_sharded_psl_variance(robin_table_sharded_t* st)
+{
+    RT_ASSERT(st != NULL);
+
+    double mean;
+    double variance;
+
+    robin_table_sharded_psl_stats(st, &mean, &variance);
+    return variance;
+}
@@ -0,0 +1,514 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "robin_table.h"
+#include "robin_table_internal.h"
+
+#define RT_SHM_MAGIC              "ROBINSHM"
+#define RT_SHM_VERSION            1U
+
+/*
+ * The shared region holds the header, the bucket array and the data area.
+ * Buckets refer to the key bytes, followed by the value bytes, by their
+ * offset from the start of the region, so that every process can map the
+ * region at its own address. The data area is only appended to: bytes
+ * written once are never modified, which lets readers use them without
+ * copying.
+ */
+typedef struct {
+    uint64_t magic;             /* RT_SHM_MAGIC, stored last by the creator */
+    uint32_t version;
+    uint32_t hash_id;
+    uint64_t seed;
+    uint64_t size;
+    uint64_t bucket_count;
+    uint64_t capacity;          /* Maximum number of entries */
+    uint64_t data_off;
+    uint64_t data_size;
+    uint64_t data_used;
+    uint64_t count;
+    uint64_t seq;               /* Sequence counter, odd while writing */
+} robin_shm_header_t;
+
+typedef struct {
+    uint64_t hash;
+    uint64_t off;               /* 0 if the bucket is empty */
+    uint32_t klen;
+    uint32_t vlen;
+} robin_shm_bucket_t;
+
+struct robin_table_shm_t {
+    uint8_t* base;
+    size_t size;
+    robin_shm_header_t* header;
+    robin_shm_bucket_t* buckets;
+    size_t mask;
+    bool writer;
+    uint64_t (*hash_func)(const void*, size_t, uint64_t);
+};
+
+/*
+ * Return the magic as a word, so that it can be stored and loaded atomically.
+ */
+static inline uint64_t robin_shm_magic(void)
+{
+    uint64_t magic;
+
+    memcpy(&magic, RT_SHM_MAGIC, sizeof(magic));
+    return magic;
+}
+
+/*
+ * Create a hash table in the POSIX shared memory object name (see
+ * shm_open), which must not exist yet. The calling process is the single
+ * writer; other processes attach with robin_table_shm_attach and read it
+ * in place.
+ *
+ * => The hash table holds up to count entries, whose keys and values take
+ *    up to data_bytes in total. It is never resized.
+ * => Function pointers differ between processes, so the hash function is
+ *    one of the built-in ones, chosen by hash_id.
+ * => Return NULL if the object exists or cannot be created and mapped.
+ */
+robin_table_shm_t* robin_table_shm_create(const char* name, size_t count, size_t data_bytes,
+                                          robin_table_hash_id_t hash_id, uint64_t seed)
+{
+    RT_ASSERT(name != NULL);
+    RT_ASSERT(robin_table_hash_func(hash_id) != NULL);
+
+    robin_table_shm_t* sh;
+    robin_shm_header_t* header;
+    size_t bucket_count = RT_BUCKET_COUNT_MIN;
+    size_t size;
+    void* base;
+    int fd;
+
+    while ((bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100 < count) {
+        bucket_count <<= 1;
+    }
+    size = sizeof(robin_shm_header_t) + bucket_count * sizeof(robin_shm_bucket_t) + data_bytes;
+
+    sh = malloc(sizeof(robin_table_shm_t));
+    if (!sh) {
+        return NULL;
+    }
+
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        free(sh);
+        return NULL;
+    }
+
+    /* The new object reads as zeros: every bucket starts empty */
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        free(sh);
+        return NULL;
+    }
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        free(sh);
+        return NULL;
+    }
+
+    header = base;
+    header->version = RT_SHM_VERSION;
+    header->hash_id = hash_id;
+    header->seed = seed;
+    header->size = size;
+    header->bucket_count = bucket_count;
+    header->capacity = (bucket_count * RT_LOAD_FACTOR_PCT_MAX) / 100;
+    header->data_off = sizeof(robin_shm_header_t) + bucket_count * sizeof(robin_shm_bucket_t);
+    header->data_size = data_bytes;
+
+    /* Readers load the magic first, with acquire semantics */
+    __atomic_store_n(&header->magic, robin_shm_magic(), __ATOMIC_RELEASE);
+
+    sh->base = base;
+    sh->size = size;
+    sh->header = header;
+    sh->buckets = (robin_shm_bucket_t*)(sh->base + sizeof(robin_shm_header_t));
+    sh->mask = bucket_count - 1;
+    sh->writer = true;
+    sh->hash_func = robin_table_hash_func(hash_id);
+    return sh;
+}
+
+/*
+ * Check the header of a mapped hash table against its size: the bucket
+ * array and the data area must lie within the region.
+ *
+ * => The magic is loaded first: once it is seen, the other fields written
+ *    before it by the creator are visible.
+ */
+static bool robin_shm_check(const robin_shm_header_t* header, size_t size)
+{
+    uint64_t bucket_count;
+
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != robin_shm_magic()) {
+        return false;
+    }
+    bucket_count = header->bucket_count;
+
+    return header->version == RT_SHM_VERSION && header->size == size &&
+           robin_table_hash_func((robin_table_hash_id_t)header->hash_id) &&
+           bucket_count && !(bucket_count & (bucket_count - 1)) &&
+           header->data_off >= sizeof(*header) && header->data_off <= size &&
+           bucket_count <= (header->data_off - sizeof(*header)) / sizeof(robin_shm_bucket_t) &&
+           header->data_size <= size - header->data_off;
+}
+
+/*
+ * Attach read-only to a hash table created by robin_table_shm_create in
+ * any process. Lookups read the shared memory in place.
+ *
+ * => Return NULL if the object does not exist or is not a hash table.
+ */
+robin_table_shm_t* robin_table_shm_attach(const char* name)
+{
+    RT_ASSERT(name != NULL);
+
+    robin_table_shm_t* sh;
+    robin_shm_header_t* header;
+    struct stat st;
+    void* base;
+    int fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(robin_shm_header_t)) {
+        close(fd);
+        return NULL;
+    }
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    header = base;
+    sh = malloc(sizeof(robin_table_shm_t));
+    if (!sh || !robin_shm_check(header, (size_t)st.st_size)) {
+        munmap(base, (size_t)st.st_size);
+        free(sh);
+        return NULL;
+    }
+
+    sh->base = base;
+    sh->size = (size_t)st.st_size;
+    sh->header = header;
+    sh->buckets = (robin_shm_bucket_t*)(sh->base + sizeof(robin_shm_header_t));
+    sh->mask = header->bucket_count - 1;
+    sh->writer = false;
+    sh->hash_func = robin_table_hash_func((robin_table_hash_id_t)header->hash_id);
+    return sh;
+}
+
+/*
+ * Unmap the hash table. The shared memory object remains until it is
+ * removed with robin_table_shm_unlink.
+ */
+void robin_table_shm_detach(robin_table_shm_t* sh)
+{
+    if (!sh) {
+        return;
+    }
+
+    munmap(sh->base, sh->size);
+    free(sh);
+}
+
+/*
+ * Remove the shared memory object; processes still attached keep their
+ * mapping.
+ */
+bool robin_table_shm_unlink(const char* name)
+{
+    RT_ASSERT(name != NULL);
+
+    return shm_unlink(name) == 0;
+}
+
+/*
+ * Open a write section: readers that overlap with it retry.
+ */
+static inline void robin_shm_write_begin(robin_shm_header_t* header)
+{
+    __atomic_store_n(&header->seq, header->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void robin_shm_write_end(robin_shm_header_t* header)
+{
+    __atomic_store_n(&header->seq, header->seq + 1, __ATOMIC_RELEASE);
+}
+
+static inline void robin_shm_store(robin_shm_bucket_t* bucket, const robin_shm_bucket_t* src)
+{
+    __atomic_store_n(&bucket->hash, src->hash, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket->off, src->off, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket->klen, src->klen, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket->vlen, src->vlen, __ATOMIC_RELAXED);
+}
+
+/*
+ * Find the bucket of a key on the writer side, or return SIZE_MAX.
+ */
+static size_t robin_shm_find(const robin_table_shm_t* sh, const void* key, size_t klen,
+                             uint64_t hash)
+{
+    size_t idx = hash & sh->mask;
+
+    for (size_t psl = 0;; ++psl) {
+        const robin_shm_bucket_t* bucket = sh->buckets + idx;
+
+        if (!bucket->off || psl > ((idx - bucket->hash) & sh->mask)) {
+            return SIZE_MAX;
+        }
+        if (bucket->hash == hash && bucket->klen == klen &&
+            memcmp(sh->base + bucket->off, key, klen) == 0) {
+            return idx;
+        }
+        idx = (idx + 1) & sh->mask;
+    }
+}
+
+/*
+ * Insert a copy of a key and its value bytes.
+ *
+ * => Only the creating process may call this function.
+ * => If the key exists, the existing value is kept.
+ * => Return a pointer to the stored value bytes in the shared memory, or
+ *    NULL if the hash table or its data area is full.
+ */
+const void* robin_table_shm_put(robin_table_shm_t* sh, const void* key, size_t klen,
+                                const void* val, size_t vlen)
+{
+    RT_ASSERT(sh != NULL && sh->writer);
+    RT_ASSERT(key != NULL && klen > 0 && klen <= UINT32_MAX);
+    RT_ASSERT(val != NULL || vlen == 0);
+    RT_ASSERT(vlen <= UINT32_MAX);
+
+    robin_shm_header_t* header = sh->header;
+    const uint64_t hash = sh->hash_func(key, klen, header->seed);
+    robin_shm_bucket_t entry;
+    size_t idx, psl;
+
+    idx = robin_shm_find(sh, key, klen, hash);
+    if (idx != SIZE_MAX) {
+        return sh->base + sh->buckets[idx].off + klen;
+    }
+    if (header->count >= header->capacity || klen + vlen > header->data_size - header->data_used) {
+        return NULL;
+    }
+
+    /* The bytes are invisible to readers until a bucket refers to them */
+    entry.hash = hash;
+    entry.off = header->data_off + header->data_used;
+    entry.klen = (uint32_t)klen;
+    entry.vlen = (uint32_t)vlen;
+    memcpy(sh->base + entry.off, key, klen);
+    if (vlen) {
+        memcpy(sh->base + entry.off + klen, val, vlen);
+    }
+    header->data_used += klen + vlen;
+
+    robin_shm_write_begin(header);
+
+    idx = hash & sh->mask;
+    for (psl = 0;; ++psl) {
+        robin_shm_bucket_t* bucket = sh->buckets + idx;
+        size_t bpsl;
+
+        if (!bucket->off) {
+            robin_shm_store(bucket, &entry);
+            break;
+        }
+
+        /* Robin Hood: take the slot of a richer entry and carry it on */
+        bpsl = (idx - bucket->hash) & sh->mask;
+        if (bpsl < psl) {
+            robin_shm_bucket_t tmp = *bucket;
+
+            robin_shm_store(bucket, &entry);
+            entry = tmp;
+            psl = bpsl;
+        }
+        idx = (idx + 1) & sh->mask;
+    }
+    __atomic_store_n(&header->count, header->count + 1, __ATOMIC_RELAXED);
+
+    robin_shm_write_end(header);
+    return sh->base + header->data_off + header->data_used - vlen;
+}
+
+/*
+ * Remove a key. The space taken by its key and value bytes is not reused.
+ *
+ * => Only the creating process may call this function.
+ * => Return false if the key is not found.
+ */
+bool robin_table_shm_del(robin_table_shm_t* sh, const void* key, size_t klen)
+{
+    RT_ASSERT(sh != NULL && sh->writer);
+    RT_ASSERT(key != NULL && klen > 0);
+
+    robin_shm_header_t* header = sh->header;
+    const robin_shm_bucket_t empty = {0, 0, 0, 0};
+    size_t idx, next;
+
+    idx = robin_shm_find(sh, key, klen, sh->hash_func(key, klen, header->seed));
+    if (idx == SIZE_MAX) {
+        return false;
+    }
+
+    robin_shm_write_begin(header);
+
+    /* Backward shift the following entries */
+    for (next = (idx + 1) & sh->mask;
+         sh->buckets[next].off && ((next - sh->buckets[next].hash) & sh->mask);
+         next = (next + 1) & sh->mask) {
+        robin_shm_store(sh->buckets + idx, sh->buckets + next);
+        idx = next;
+    }
+    robin_shm_store(sh->buckets + idx, &empty);
+    __atomic_store_n(&header->count, header->count - 1, __ATOMIC_RELAXED);
+
+    robin_shm_write_end(header);
+    return true;
+}
+
+/*
+ * Internal function to look up a key during one read attempt.
+ *
+ * => Return false if a write overlapped with the attempt.
+ */
+static bool robin_shm_get0(const robin_table_shm_t* sh, const void* key, size_t klen,
+                           uint64_t hash, uint64_t seq, const void** val, size_t* vlen)
+{
+    const robin_shm_header_t* header = sh->header;
+    size_t idx = hash & sh->mask;
+
+    *val = NULL;
+
+    /* Bound the probe: a torn read must never loop forever */
+    for (size_t psl = 0; psl <= sh->mask; ++psl) {
+        const robin_shm_bucket_t* bucket = sh->buckets + idx;
+        const uint64_t off = __atomic_load_n(&bucket->off, __ATOMIC_RELAXED);
+        const uint64_t bhash = __atomic_load_n(&bucket->hash, __ATOMIC_RELAXED);
+
+        if (!off || psl > ((idx - bhash) & sh->mask)) {
+            break;
+        }
+
+        if (bhash == hash && __atomic_load_n(&bucket->klen, __ATOMIC_RELAXED) == klen) {
+            const uint32_t len = __atomic_load_n(&bucket->vlen, __ATOMIC_RELAXED);
+
+            /* Validate before reading the data area */
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&header->seq, __ATOMIC_RELAXED) != seq) {
+                return false;
+            }
+
+            /* A damaged bucket must not make the lookup read past the region */
+            if (off > sh->size || klen + len > sh->size - off) {
+                break;
+            }
+
+            /* Data bytes are never modified once a bucket refers to them */
+            if (memcmp(sh->base + off, key, klen) == 0) {
+                *val = sh->base + off + klen;
+                *vlen = len;
+                return true;
+            }
+        }
+
+        idx = (idx + 1) & sh->mask;
+    }
+
+    /* Validate the miss */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&header->seq, __ATOMIC_RELAXED) == seq;
+}
+
+/*
+ * Look up a key without taking a lock, from the writer or any attached
+ * process, while the writer may be modifying the hash table.
+ *
+ * => Return a pointer to the value bytes in the shared memory and set
+ *    *vlen (if not NULL), or return NULL if the key is not found. The
+ *    bytes stay valid while the hash table is mapped.
+ */
+const void* robin_table_shm_get(const robin_table_shm_t* sh, const void* key, size_t klen,
+                                size_t* vlen)
+{
+    RT_ASSERT(sh != NULL);
+    RT_ASSERT(key != NULL && klen > 0);
+
+    const uint64_t hash = sh->hash_func(key, klen, sh->header->seed);
+    const void* val;
+    size_t len = 0;
+
+    while (1) {
+        const uint64_t seq = __atomic_load_n(&sh->header->seq, __ATOMIC_ACQUIRE);
+
+        /* Retry while a write is in progress or overlapped with the lookup */
+        if (!(seq & 1) && robin_shm_get0(sh, key, klen, hash, seq, &val, &len)) {
+            if (val && vlen) {
+                *vlen = len;
+            }
+            return val;
+        }
+    }
+}
+
+/*
+ * Return the number of entries in the hash table.
+ *
+ * => Readers may see a count that a concurrent put or delete is about to
+ *    change.
+ */
+size_t robin_table_shm_count(const robin_table_shm_t* sh)
+{
+    RT_ASSERT(sh != NULL);
+
+    return __atomic_load_n(&sh->header->count, __ATOMIC_RELAXED);
+}
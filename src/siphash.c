@@ -11,12 +11,14 @@
  * with this software. If not, see
  * <http://creativecommons.org/publicdomain/zero/1.0/>.
  *
- * default: SipHash-2-4
+ * SipHash-2-4 and SipHash-1-3
  */
 
 #include <stddef.h>
 #include <stdint.h>
 
+#include "hashstream.h"
+
 #define ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
 
 #define SIPROUND                                                                         \
@@ -34,29 +36,19 @@
         v2 += v1;                                                                        \
         v1 = ROTL(v1, 17);                                                               \
         v1 ^= v2;                                                                        \
+        v2 = ROTL(v2, 32);                                                               \
     } while (0)
 
-static uint64_t siphash(const uint8_t* in, size_t len, uint64_t seed)
+static inline uint64_t sip_read64(const uint8_t* p)
 {
-    uint64_t v0 = 0x736f6d6570736575ULL ^ seed;
-    uint64_t v1 = 0x646f72616e646f6dULL ^ (seed >> 32);
-    uint64_t v2 = 0x6c7967656e657261ULL ^ seed;
-    uint64_t v3 = 0x7465646279746573ULL ^ (seed >> 32);
-    uint64_t m;
-    const uint8_t* end = in + len - (len % sizeof(uint64_t));
-    const uint8_t* curr = in;
-
-    for (; curr != end; curr += 8) {
-        m = ((uint64_t)curr[0]) | ((uint64_t)curr[1] << 8) | ((uint64_t)curr[2] << 16) |
-            ((uint64_t)curr[3] << 24) | ((uint64_t)curr[4] << 32) |
-            ((uint64_t)curr[5] << 40) | ((uint64_t)curr[6] << 48) |
-            ((uint64_t)curr[7] << 56);
-        v3 ^= m;
-        SIPROUND;
-        SIPROUND;
-        v0 ^= m;
-    }
+    return ((uint64_t)p[0]) | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) |
+           ((uint64_t)p[3] << 24) | ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) |
+           ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
 
+/* Last block: the len % 8 bytes at curr, with the length in the top byte */
+static inline uint64_t sip_tail(const uint8_t* curr, size_t len)
+{
     uint64_t b = len << 56;
     switch (len % 8) {
     case 7:
@@ -81,20 +73,118 @@ static uint64_t siphash(const uint8_t* in, size_t len, uint64_t seed)
         b |= ((uint64_t)curr[0]);
     }
 
-    v3 ^= b;
-    SIPROUND;
-    SIPROUND;
-    v0 ^= b;
-    v2 ^= 0xff;
-    SIPROUND;
-    SIPROUND;
-    SIPROUND;
-    SIPROUND;
+    return b;
+}
+
+/*
+ * SipHash-c-d with the 128-bit key (k0, k1). The round counts are constants
+ * at every call site, so the round loops are unrolled.
+ */
+#define SIP_INIT(k0, k1)                                                                 \
+    uint64_t v0 = 0x736f6d6570736575ULL ^ (k0);                                          \
+    uint64_t v1 = 0x646f72616e646f6dULL ^ (k1);                                          \
+    uint64_t v2 = 0x6c7967656e657261ULL ^ (k0);                                          \
+    uint64_t v3 = 0x7465646279746573ULL ^ (k1)
+
+#define SIP_COMPRESS(m, crounds)                                                         \
+    do {                                                                                 \
+        v3 ^= (m);                                                                       \
+        for (int r_ = 0; r_ < (crounds); ++r_) {                                         \
+            SIPROUND;                                                                    \
+        }                                                                                \
+        v0 ^= (m);                                                                       \
+    } while (0)
+
+#define SIP_FINALIZE(b, crounds, drounds)                                                \
+    do {                                                                                 \
+        SIP_COMPRESS(b, crounds);                                                        \
+        v2 ^= 0xff;                                                                      \
+        for (int r_ = 0; r_ < (drounds); ++r_) {                                         \
+            SIPROUND;                                                                    \
+        }                                                                                \
+    } while (0)
+
+static inline uint64_t siphash(const uint8_t* in, size_t len, uint64_t k0, uint64_t k1,
+                               const int crounds, const int drounds)
+{
+    SIP_INIT(k0, k1);
+    const uint8_t* end = in + len - (len % sizeof(uint64_t));
+    const uint8_t* curr = in;
+
+    for (; curr != end; curr += 8) {
+        SIP_COMPRESS(sip_read64(curr), crounds);
+    }
+    SIP_FINALIZE(sip_tail(curr, len), crounds, drounds);
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/*
+ * SipHash over fragments: 8-byte words are read from the fragments in place
+ * and only words spanning two fragments, and the tail, are gathered.
+ */
+static inline uint64_t siphash_frags(const robin_table_frag_t* frags, size_t nfrags,
+                                     size_t len, uint64_t k0, uint64_t k1,
+                                     const int crounds, const int drounds)
+{
+    SIP_INIT(k0, k1);
+    uint8_t buf[8];
+    robin_frag_cursor_t cur;
+    size_t nwords = len / 8;
+
+    robin_frag_init(&cur, frags, nfrags);
+    while (nwords) {
+        size_t n = nwords;
+        const uint8_t* curr = robin_frag_next(&cur, 8, &n, buf);
+
+        for (nwords -= n; n; --n, curr += 8) {
+            SIP_COMPRESS(sip_read64(curr), crounds);
+        }
+    }
+    SIP_FINALIZE(sip_tail(robin_frag_tail(frags, nfrags, len % 8, buf), len), crounds,
+                 drounds);
 
     return v0 ^ v1 ^ v2 ^ v3;
 }
 
+/*
+ * The 64-bit seed of the hash table functions is expanded to the 128-bit
+ * key (seed, seed >> 32).
+ */
 uint64_t robin_table_siphash(const void* key, size_t klen, uint64_t seed)
 {
-    return siphash((const uint8_t*)key, klen, seed);
+    return siphash((const uint8_t*)key, klen, seed, seed >> 32, 2, 4);
+}
+
+uint64_t robin_table_siphash13(const void* key, size_t klen, uint64_t seed)
+{
+    return siphash((const uint8_t*)key, klen, seed, seed >> 32, 1, 3);
+}
+
+/*
+ * SipHash-2-4 and SipHash-1-3 with a full 128-bit key of 16 bytes, read as
+ * two little-endian words as in the reference implementation.
+ */
+uint64_t robin_table_siphash_key128(const void* key, size_t klen, const void* k)
+{
+    return siphash((const uint8_t*)key, klen, sip_read64(k), sip_read64((const uint8_t*)k + 8),
+                   2, 4);
+}
+
+uint64_t robin_table_siphash13_key128(const void* key, size_t klen, const void* k)
+{
+    return siphash((const uint8_t*)key, klen, sip_read64(k), sip_read64((const uint8_t*)k + 8),
+                   1, 3);
+}
+
+uint64_t robin_siphash_frags(const robin_table_frag_t* frags, size_t nfrags, size_t len,
+                             uint64_t seed)
+{
+    return siphash_frags(frags, nfrags, len, seed, seed >> 32, 2, 4);
+}
+
+uint64_t robin_siphash13_frags(const robin_table_frag_t* frags, size_t nfrags, size_t len,
+                               uint64_t seed)
+{
+    return siphash_frags(frags, nfrags, len, seed, seed >> 32, 1, 3);
 }
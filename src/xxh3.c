@@ -0,0 +1,670 @@
+/*
+ * xxHash - Fast Hash algorithm
+ * Copyright (C) 2012-2020 Yann Collet
+ * Copyright (C) 2019-2020 Devin Hussey (easyaspi314)
+ *
+ * BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * You can contact the author at:
+ * - xxHash homepage: http://www.xxhash.com
+ * - xxHash source repository : https://github.com/Cyan4973/xxHash
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hashstream.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define RT_XXH3_X86
+#endif
+
+/*
+ * XXH3 (64-bit) with a seed, returning the same values as XXH3_64bits_withSeed
+ * of the reference implementation. Keys up to 240 bytes take one of the
+ * scalar short-key paths; longer keys run the stripe accumulator, which is
+ * vectorized with SSE2 and, when the CPU supports it, with AVX2 (selected
+ * once, on the first call).
+ */
+
+#define XXH3_SECRET_SIZE            192
+#define XXH3_SECRET_SIZE_MIN        136
+#define XXH3_STRIPE_LEN             64
+#define XXH3_SECRET_CONSUME_RATE    8
+#define XXH3_ACC_NB                 8
+#define XXH3_MIDSIZE_MAX            240
+#define XXH3_MIDSIZE_STARTOFFSET    3
+#define XXH3_MIDSIZE_LASTOFFSET     17
+#define XXH3_SECRET_LASTACC_START   7
+#define XXH3_SECRET_MERGEACCS_START 11
+
+static uint32_t const XXH3_PRIME32_1 = 0x9E3779B1U;
+static uint32_t const XXH3_PRIME32_2 = 0x85EBCA77U;
+static uint32_t const XXH3_PRIME32_3 = 0xC2B2AE3DU;
+
+static uint64_t const XXH3_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static uint64_t const XXH3_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static uint64_t const XXH3_PRIME64_3 = 0x165667B19E3779F9ULL;
+static uint64_t const XXH3_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static uint64_t const XXH3_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static uint8_t const XXH3_kSecret[XXH3_SECRET_SIZE] __attribute__((aligned(64))) = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+typedef void (*XXH3_accumulate_fn)(uint64_t* acc, uint8_t const* input, uint8_t const* secret,
+                                   size_t nbStripes);
+typedef void (*XXH3_scramble_fn)(uint64_t* acc, uint8_t const* secret);
+
+static inline uint64_t XXH3_rotl64(uint64_t const value, uint32_t const amt)
+{
+    return (value << amt) | (value >> (64 - amt));
+}
+
+/* Little-endian reads, which are plain loads on little-endian hosts */
+static inline uint32_t XXH3_read32(uint8_t const* const p)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+#else
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+#endif
+}
+
+static inline uint64_t XXH3_read64(uint8_t const* const p)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+#else
+    return (uint64_t)XXH3_read32(p) | ((uint64_t)XXH3_read32(p + 4) << 32);
+#endif
+}
+
+#if !defined(__SSE2__)
+static inline void XXH3_write64(uint8_t* const p, uint64_t const v)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+#endif
+
+static inline uint32_t XXH3_swap32(uint32_t const x)
+{
+    return ((x << 24) & 0xff000000U) | ((x << 8) & 0x00ff0000U) | ((x >> 8) & 0x0000ff00U) |
+           ((x >> 24) & 0x000000ffU);
+}
+
+static inline uint64_t XXH3_swap64(uint64_t const x)
+{
+    return ((uint64_t)XXH3_swap32((uint32_t)x) << 32) | XXH3_swap32((uint32_t)(x >> 32));
+}
+
+static inline uint64_t XXH3_mul128_fold64(uint64_t const lhs, uint64_t const rhs)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t const product = (__uint128_t)lhs * rhs;
+
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+    uint64_t const lo_lo = (lhs & 0xFFFFFFFFU) * (rhs & 0xFFFFFFFFU);
+    uint64_t const hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFFU);
+    uint64_t const lo_hi = (lhs & 0xFFFFFFFFU) * (rhs >> 32);
+    uint64_t const hi_hi = (lhs >> 32) * (rhs >> 32);
+    uint64_t const cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFU) + lo_hi;
+    uint64_t const upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    uint64_t const lower = (cross << 32) | (lo_lo & 0xFFFFFFFFU);
+
+    return lower ^ upper;
+#endif
+}
+
+static inline uint64_t XXH3_xxh64_avalanche(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= XXH3_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH3_PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+static inline uint64_t XXH3_avalanche(uint64_t hash)
+{
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9ULL;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+static inline uint64_t XXH3_rrmxmx(uint64_t hash, uint64_t const len)
+{
+    hash ^= XXH3_rotl64(hash, 49) ^ XXH3_rotl64(hash, 24);
+    hash *= 0x9FB21C651E98DF25ULL;
+    hash ^= (hash >> 35) + len;
+    hash *= 0x9FB21C651E98DF25ULL;
+    return hash ^ (hash >> 28);
+}
+
+static inline uint64_t XXH3_len_1to3(uint8_t const* input, size_t const len,
+                                     uint8_t const* secret, uint64_t const seed)
+{
+    uint32_t const combined = ((uint32_t)input[0] << 16) | ((uint32_t)input[len >> 1] << 24) |
+                              (uint32_t)input[len - 1] | ((uint32_t)len << 8);
+    uint64_t const bitflip = (XXH3_read32(secret) ^ XXH3_read32(secret + 4)) + seed;
+
+    return XXH3_xxh64_avalanche((uint64_t)combined ^ bitflip);
+}
+
+static inline uint64_t XXH3_len_4to8(uint8_t const* input, size_t const len,
+                                     uint8_t const* secret, uint64_t seed)
+{
+    uint64_t bitflip;
+    uint64_t input64;
+
+    seed ^= (uint64_t)XXH3_swap32((uint32_t)seed) << 32;
+    bitflip = (XXH3_read64(secret + 8) ^ XXH3_read64(secret + 16)) - seed;
+    input64 = XXH3_read32(input + len - 4) + ((uint64_t)XXH3_read32(input) << 32);
+    return XXH3_rrmxmx(input64 ^ bitflip, len);
+}
+
+static inline uint64_t XXH3_len_9to16(uint8_t const* input, size_t const len,
+                                      uint8_t const* secret, uint64_t const seed)
+{
+    uint64_t const bitflip1 = (XXH3_read64(secret + 24) ^ XXH3_read64(secret + 32)) + seed;
+    uint64_t const bitflip2 = (XXH3_read64(secret + 40) ^ XXH3_read64(secret + 48)) - seed;
+    uint64_t const input_lo = XXH3_read64(input) ^ bitflip1;
+    uint64_t const input_hi = XXH3_read64(input + len - 8) ^ bitflip2;
+    uint64_t const acc = len + XXH3_swap64(input_lo) + input_hi +
+                         XXH3_mul128_fold64(input_lo, input_hi);
+
+    return XXH3_avalanche(acc);
+}
+
+static inline uint64_t XXH3_len_0to16(uint8_t const* input, size_t const len,
+                                      uint8_t const* secret, uint64_t const seed)
+{
+    if (len > 8) {
+        return XXH3_len_9to16(input, len, secret, seed);
+    }
+    if (len >= 4) {
+        return XXH3_len_4to8(input, len, secret, seed);
+    }
+    if (len) {
+        return XXH3_len_1to3(input, len, secret, seed);
+    }
+    return XXH3_xxh64_avalanche(seed ^ (XXH3_read64(secret + 56) ^ XXH3_read64(secret + 64)));
+}
+
+static inline uint64_t XXH3_mix16B(uint8_t const* input, uint8_t const* secret,
+                                   uint64_t const seed)
+{
+    uint64_t const input_lo = XXH3_read64(input);
+    uint64_t const input_hi = XXH3_read64(input + 8);
+
+    return XXH3_mul128_fold64(input_lo ^ (XXH3_read64(secret) + seed),
+                              input_hi ^ (XXH3_read64(secret + 8) - seed));
+}
+
+static inline uint64_t XXH3_len_17to128(uint8_t const* input, size_t const len,
+                                        uint8_t const* secret, uint64_t const seed)
+{
+    uint64_t acc = len * XXH3_PRIME64_1;
+
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += XXH3_mix16B(input + 48, secret + 96, seed);
+                acc += XXH3_mix16B(input + len - 64, secret + 112, seed);
+            }
+            acc += XXH3_mix16B(input + 32, secret + 64, seed);
+            acc += XXH3_mix16B(input + len - 48, secret + 80, seed);
+        }
+        acc += XXH3_mix16B(input + 16, secret + 32, seed);
+        acc += XXH3_mix16B(input + len - 32, secret + 48, seed);
+    }
+    acc += XXH3_mix16B(input + 0, secret + 0, seed);
+    acc += XXH3_mix16B(input + len - 16, secret + 16, seed);
+    return XXH3_avalanche(acc);
+}
+
+static inline uint64_t XXH3_len_129to240(uint8_t const* input, size_t const len,
+                                         uint8_t const* secret, uint64_t const seed)
+{
+    size_t const nbRounds = len / 16;
+    uint64_t acc = len * XXH3_PRIME64_1;
+    uint64_t acc_end;
+
+    for (size_t i = 0; i < 8; ++i) {
+        acc += XXH3_mix16B(input + 16 * i, secret + 16 * i, seed);
+    }
+    acc_end = XXH3_mix16B(input + len - 16,
+                          secret + XXH3_SECRET_SIZE_MIN - XXH3_MIDSIZE_LASTOFFSET, seed);
+    acc = XXH3_avalanche(acc);
+    for (size_t i = 8; i < nbRounds; ++i) {
+        acc_end += XXH3_mix16B(input + 16 * i,
+                               secret + 16 * (i - 8) + XXH3_MIDSIZE_STARTOFFSET, seed);
+    }
+    return XXH3_avalanche(acc + acc_end);
+}
+
+/*
+ * Stripe accumulator: every 64-byte stripe is keyed by a sliding window of
+ * the secret and folded into eight 64-bit lanes, and the lanes are
+ * scrambled after each block of 16 stripes.
+ */
+#if !defined(__SSE2__)
+
+static void XXH3_accumulate_scalar(uint64_t* acc, uint8_t const* input, uint8_t const* secret,
+                                   size_t nbStripes)
+{
+    for (size_t n = 0; n < nbStripes; ++n) {
+        uint8_t const* const in = input + n * XXH3_STRIPE_LEN;
+        uint8_t const* const key = secret + n * XXH3_SECRET_CONSUME_RATE;
+
+        for (size_t i = 0; i < XXH3_ACC_NB; ++i) {
+            uint64_t const data_val = XXH3_read64(in + 8 * i);
+            uint64_t const data_key = data_val ^ XXH3_read64(key + 8 * i);
+
+            acc[i ^ 1] += data_val;
+            acc[i] += (data_key & 0xFFFFFFFFU) * (data_key >> 32);
+        }
+    }
+}
+
+static void XXH3_scramble_scalar(uint64_t* acc, uint8_t const* secret)
+{
+    for (size_t i = 0; i < XXH3_ACC_NB; ++i) {
+        uint64_t acc64 = acc[i];
+
+        acc64 ^= acc64 >> 47;
+        acc64 ^= XXH3_read64(secret + 8 * i);
+        acc64 *= XXH3_PRIME32_1;
+        acc[i] = acc64;
+    }
+}
+
+#else
+
+static void XXH3_accumulate_sse2(uint64_t* acc, uint8_t const* input, uint8_t const* secret,
+                                 size_t nbStripes)
+{
+    __m128i* const xacc = (__m128i*)acc;
+
+    for (size_t n = 0; n < nbStripes; ++n) {
+        __m128i const* const in = (__m128i const*)(input + n * XXH3_STRIPE_LEN);
+        __m128i const* const key = (__m128i const*)(secret + n * XXH3_SECRET_CONSUME_RATE);
+
+        for (size_t i = 0; i < XXH3_STRIPE_LEN / sizeof(__m128i); ++i) {
+            __m128i const data_vec = _mm_loadu_si128(in + i);
+            __m128i const data_key = _mm_xor_si128(data_vec, _mm_loadu_si128(key + i));
+            __m128i const data_key_lo = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+            __m128i const product = _mm_mul_epu32(data_key, data_key_lo);
+            __m128i const data_swap = _mm_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+
+            xacc[i] = _mm_add_epi64(product, _mm_add_epi64(xacc[i], data_swap));
+        }
+    }
+}
+
+static void XXH3_scramble_sse2(uint64_t* acc, uint8_t const* secret)
+{
+    __m128i* const xacc = (__m128i*)acc;
+    __m128i const* const key = (__m128i const*)secret;
+    __m128i const prime32 = _mm_set1_epi32((int)XXH3_PRIME32_1);
+
+    for (size_t i = 0; i < XXH3_STRIPE_LEN / sizeof(__m128i); ++i) {
+        __m128i const data_vec = _mm_xor_si128(xacc[i], _mm_srli_epi64(xacc[i], 47));
+        __m128i const data_key = _mm_xor_si128(data_vec, _mm_loadu_si128(key + i));
+        __m128i const data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i const prod_lo = _mm_mul_epu32(data_key, prime32);
+        __m128i const prod_hi = _mm_mul_epu32(data_key_hi, prime32);
+
+        xacc[i] = _mm_add_epi64(prod_lo, _mm_slli_epi64(prod_hi, 32));
+    }
+}
+
+#endif /* __SSE2__ */
+
+#ifdef RT_XXH3_X86
+
+__attribute__((target("avx2"))) static void XXH3_accumulate_avx2(uint64_t* acc,
+                                                                 uint8_t const* input,
+                                                                 uint8_t const* secret,
+                                                                 size_t nbStripes)
+{
+    __m256i* const xacc = (__m256i*)acc;
+
+    for (size_t n = 0; n < nbStripes; ++n) {
+        __m256i const* const in = (__m256i const*)(input + n * XXH3_STRIPE_LEN);
+        __m256i const* const key = (__m256i const*)(secret + n * XXH3_SECRET_CONSUME_RATE);
+
+        for (size_t i = 0; i < XXH3_STRIPE_LEN / sizeof(__m256i); ++i) {
+            __m256i const data_vec = _mm256_loadu_si256(in + i);
+            __m256i const data_key = _mm256_xor_si256(data_vec, _mm256_loadu_si256(key + i));
+            __m256i const data_key_lo =
+                _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+            __m256i const product = _mm256_mul_epu32(data_key, data_key_lo);
+            __m256i const data_swap =
+                _mm256_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+
+            xacc[i] = _mm256_add_epi64(product, _mm256_add_epi64(xacc[i], data_swap));
+        }
+    }
+}
+
+__attribute__((target("avx2"))) static void XXH3_scramble_avx2(uint64_t* acc,
+                                                               uint8_t const* secret)
+{
+    __m256i* const xacc = (__m256i*)acc;
+    __m256i const* const key = (__m256i const*)secret;
+    __m256i const prime32 = _mm256_set1_epi32((int)XXH3_PRIME32_1);
+
+    for (size_t i = 0; i < XXH3_STRIPE_LEN / sizeof(__m256i); ++i) {
+        __m256i const data_vec = _mm256_xor_si256(xacc[i], _mm256_srli_epi64(xacc[i], 47));
+        __m256i const data_key = _mm256_xor_si256(data_vec, _mm256_loadu_si256(key + i));
+        __m256i const data_key_hi = _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        __m256i const prod_lo = _mm256_mul_epu32(data_key, prime32);
+        __m256i const prod_hi = _mm256_mul_epu32(data_key_hi, prime32);
+
+        xacc[i] = _mm256_add_epi64(prod_lo, _mm256_slli_epi64(prod_hi, 32));
+    }
+}
+
+#endif /* RT_XXH3_X86 */
+
+#define XXH3_INIT_ACC                                                                   \
+    {                                                                                   \
+        XXH3_PRIME32_3, XXH3_PRIME64_1, XXH3_PRIME64_2, XXH3_PRIME64_3,                 \
+        XXH3_PRIME64_4, XXH3_PRIME32_2, XXH3_PRIME64_5, XXH3_PRIME32_1                  \
+    }
+
+static inline uint64_t XXH3_mergeAccs(uint64_t const* acc, uint8_t const* secret,
+                                      size_t const len)
+{
+    uint64_t result = len * XXH3_PRIME64_1;
+
+    for (size_t i = 0; i < 4; ++i) {
+        uint8_t const* const key = secret + XXH3_SECRET_MERGEACCS_START + 16 * i;
+
+        result += XXH3_mul128_fold64(acc[2 * i] ^ XXH3_read64(key),
+                                     acc[2 * i + 1] ^ XXH3_read64(key + 8));
+    }
+    return XXH3_avalanche(result);
+}
+
+static inline uint64_t XXH3_hashLong(uint8_t const* input, size_t const len,
+                                     uint8_t const* secret, XXH3_accumulate_fn accumulate,
+                                     XXH3_scramble_fn scramble)
+{
+    uint64_t acc[XXH3_ACC_NB] __attribute__((aligned(32))) = XXH3_INIT_ACC;
+    size_t const nbStripesPerBlock =
+        (XXH3_SECRET_SIZE - XXH3_STRIPE_LEN) / XXH3_SECRET_CONSUME_RATE;
+    size_t const block_len = XXH3_STRIPE_LEN * nbStripesPerBlock;
+    size_t const nb_blocks = (len - 1) / block_len;
+    size_t const nbStripes = ((len - 1) - block_len * nb_blocks) / XXH3_STRIPE_LEN;
+
+    for (size_t n = 0; n < nb_blocks; ++n) {
+        accumulate(acc, input + n * block_len, secret, nbStripesPerBlock);
+        scramble(acc, secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN);
+    }
+
+    /* Last partial block, then the last stripe, which may overlap it */
+    accumulate(acc, input + nb_blocks * block_len, secret, nbStripes);
+    accumulate(acc, input + len - XXH3_STRIPE_LEN,
+               secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - XXH3_SECRET_LASTACC_START, 1);
+
+    return XXH3_mergeAccs(acc, secret, len);
+}
+
+/*
+ * XXH3 over a key longer than 240 bytes made of fragments: the stripes are
+ * read in place, except those spanning fragments and the last (overlapping)
+ * stripe, which are gathered.
+ */
+static inline uint64_t XXH3_hashLong_frags(robin_table_frag_t const* frags, size_t nfrags,
+                                           size_t const len, uint8_t const* secret,
+                                           XXH3_accumulate_fn accumulate,
+                                           XXH3_scramble_fn scramble)
+{
+    uint64_t acc[XXH3_ACC_NB] __attribute__((aligned(32))) = XXH3_INIT_ACC;
+    size_t const nbStripesPerBlock =
+        (XXH3_SECRET_SIZE - XXH3_STRIPE_LEN) / XXH3_SECRET_CONSUME_RATE;
+    size_t const nbStripes = (len - 1) / XXH3_STRIPE_LEN;
+    uint8_t buf[XXH3_STRIPE_LEN];
+    robin_frag_cursor_t cur;
+
+    robin_frag_init(&cur, frags, nfrags);
+    for (size_t k = 0; k < nbStripes;) {
+        size_t const offset = k % nbStripesPerBlock;
+        size_t n = nbStripesPerBlock - offset;
+        uint8_t const* input;
+
+        n = n < nbStripes - k ? n : nbStripes - k;
+        input = robin_frag_next(&cur, XXH3_STRIPE_LEN, &n, buf);
+        accumulate(acc, input, secret + offset * XXH3_SECRET_CONSUME_RATE, n);
+        k += n;
+        if (k % nbStripesPerBlock == 0) {
+            scramble(acc, secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN);
+        }
+    }
+
+    accumulate(acc, robin_frag_tail(frags, nfrags, XXH3_STRIPE_LEN, buf),
+               secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - XXH3_SECRET_LASTACC_START, 1);
+
+    return XXH3_mergeAccs(acc, secret, len);
+}
+
+/*
+ * Derive the secret of a seed: the seed is added to the low and subtracted
+ * from the high 64-bit word of every 16 bytes of the default secret.
+ */
+static inline void XXH3_init_secret(uint8_t* secret, uint64_t const seed)
+{
+#if defined(__SSE2__)
+    __m128i const seed_vec = _mm_set_epi64x((long long)(0U - seed), (long long)seed);
+
+    for (size_t i = 0; i < XXH3_SECRET_SIZE; i += 16) {
+        __m128i const key = _mm_load_si128((__m128i const*)(XXH3_kSecret + i));
+
+        _mm_store_si128((__m128i*)(secret + i), _mm_add_epi64(key, seed_vec));
+    }
+#else
+    for (size_t i = 0; i < XXH3_SECRET_SIZE; i += 16) {
+        XXH3_write64(secret + i, XXH3_read64(XXH3_kSecret + i) + seed);
+        XXH3_write64(secret + i + 8, XXH3_read64(XXH3_kSecret + i + 8) - seed);
+    }
+#endif
+}
+
+/*
+ * XXH3 over a key longer than 240 bytes. A non-zero seed uses a secret
+ * derived from the default one, built on the stack.
+ */
+static inline uint64_t XXH3_hashLong_withSeed(uint8_t const* input, size_t const len,
+                                              uint64_t const seed,
+                                              XXH3_accumulate_fn accumulate,
+                                              XXH3_scramble_fn scramble)
+{
+    uint8_t secret[XXH3_SECRET_SIZE] __attribute__((aligned(32)));
+
+    if (seed == 0) {
+        return XXH3_hashLong(input, len, XXH3_kSecret, accumulate, scramble);
+    }
+    XXH3_init_secret(secret, seed);
+    return XXH3_hashLong(input, len, secret, accumulate, scramble);
+}
+
+static inline uint64_t XXH3_hashLong_frags_withSeed(robin_table_frag_t const* frags,
+                                                    size_t nfrags, size_t const len,
+                                                    uint64_t const seed,
+                                                    XXH3_accumulate_fn accumulate,
+                                                    XXH3_scramble_fn scramble)
+{
+    uint8_t secret[XXH3_SECRET_SIZE] __attribute__((aligned(32)));
+
+    if (seed == 0) {
+        return XXH3_hashLong_frags(frags, nfrags, len, XXH3_kSecret, accumulate, scramble);
+    }
+    XXH3_init_secret(secret, seed);
+    return XXH3_hashLong_frags(frags, nfrags, len, secret, accumulate, scramble);
+}
+
+#if defined(__SSE2__)
+#define XXH3_accumulate_default XXH3_accumulate_sse2
+#define XXH3_scramble_default   XXH3_scramble_sse2
+#else
+#define XXH3_accumulate_default XXH3_accumulate_scalar
+#define XXH3_scramble_default   XXH3_scramble_scalar
+#endif
+
+static uint64_t XXH3_hashLong_default(uint8_t const* input, size_t len, uint64_t seed)
+{
+    return XXH3_hashLong_withSeed(input, len, seed, XXH3_accumulate_default,
+                                  XXH3_scramble_default);
+}
+
+static uint64_t XXH3_hashLong_frags_default(robin_table_frag_t const* frags, size_t nfrags,
+                                            size_t len, uint64_t seed)
+{
+    return XXH3_hashLong_frags_withSeed(frags, nfrags, len, seed, XXH3_accumulate_default,
+                                        XXH3_scramble_default);
+}
+
+#ifdef RT_XXH3_X86
+
+__attribute__((target("avx2"))) static uint64_t XXH3_hashLong_avx2(uint8_t const* input,
+                                                                   size_t len, uint64_t seed)
+{
+    return XXH3_hashLong_withSeed(input, len, seed, XXH3_accumulate_avx2, XXH3_scramble_avx2);
+}
+
+__attribute__((target("avx2"))) static uint64_t
+XXH3_hashLong_frags_avx2(robin_table_frag_t const* frags, size_t nfrags, size_t len,
+                         uint64_t seed)
+{
+    return XXH3_hashLong_frags_withSeed(frags, nfrags, len, seed, XXH3_accumulate_avx2,
+                                        XXH3_scramble_avx2);
+}
+
+typedef uint64_t (*XXH3_hashLong_fn)(uint8_t const*, size_t, uint64_t);
+
+static uint64_t XXH3_hashLong_first(uint8_t const* input, size_t len, uint64_t seed);
+
+/* Resolved on the first call; racing calls store the same function */
+static XXH3_hashLong_fn XXH3_hashLong_impl = XXH3_hashLong_first;
+
+static uint64_t XXH3_hashLong_first(uint8_t const* input, size_t len, uint64_t seed)
+{
+    XXH3_hashLong_fn fn;
+
+    __builtin_cpu_init();
+    fn = __builtin_cpu_supports("avx2") ? XXH3_hashLong_avx2 : XXH3_hashLong_default;
+    __atomic_store_n(&XXH3_hashLong_impl, fn, __ATOMIC_RELAXED);
+    return fn(input, len, seed);
+}
+
+static uint64_t XXH3_hashLong_64b(uint8_t const* input, size_t len, uint64_t seed)
+{
+    return __atomic_load_n(&XXH3_hashLong_impl, __ATOMIC_RELAXED)(input, len, seed);
+}
+
+typedef uint64_t (*XXH3_hashLong_frags_fn)(robin_table_frag_t const*, size_t, size_t, uint64_t);
+
+static uint64_t XXH3_hashLong_frags_first(robin_table_frag_t const* frags, size_t nfrags,
+                                          size_t len, uint64_t seed);
+
+static XXH3_hashLong_frags_fn XXH3_hashLong_frags_impl = XXH3_hashLong_frags_first;
+
+static uint64_t XXH3_hashLong_frags_first(robin_table_frag_t const* frags, size_t nfrags,
+                                          size_t len, uint64_t seed)
+{
+    XXH3_hashLong_frags_fn fn;
+
+    __builtin_cpu_init();
+    fn = __builtin_cpu_supports("avx2") ? XXH3_hashLong_frags_avx2
+                                        : XXH3_hashLong_frags_default;
+    __atomic_store_n(&XXH3_hashLong_frags_impl, fn, __ATOMIC_RELAXED);
+    return fn(frags, nfrags, len, seed);
+}
+
+static uint64_t XXH3_hashLong_frags_64b(robin_table_frag_t const* frags, size_t nfrags,
+                                        size_t len, uint64_t seed)
+{
+    return __atomic_load_n(&XXH3_hashLong_frags_impl, __ATOMIC_RELAXED)(frags, nfrags, len,
+                                                                        seed);
+}
+
+#else
+
+#define XXH3_hashLong_64b       XXH3_hashLong_default
+#define XXH3_hashLong_frags_64b XXH3_hashLong_frags_default
+
+#endif /* RT_XXH3_X86 */
+
+uint64_t robin_table_xxh3(const void* key, size_t klen, uint64_t seed)
+{
+    uint8_t const* const input = (uint8_t const*)key;
+
+    if (klen <= 16) {
+        return XXH3_len_0to16(input, klen, XXH3_kSecret, seed);
+    }
+    if (klen <= 128) {
+        return XXH3_len_17to128(input, klen, XXH3_kSecret, seed);
+    }
+    if (klen <= XXH3_MIDSIZE_MAX) {
+        return XXH3_len_129to240(input, klen, XXH3_kSecret, seed);
+    }
+    return XXH3_hashLong_64b(input, klen, seed);
+}
+
+/* XXH3 over fragments of a key longer than 240 bytes */
+uint64_t robin_xxh3_frags(const robin_table_frag_t* frags, size_t nfrags, size_t len,
+                          uint64_t seed)
+{
+    return XXH3_hashLong_frags_64b(frags, nfrags, len, seed);
+}
@@ -33,6 +33,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "hashstream.h"
+
 static uint64_t const PRIME64_1 = 0x9E3779B185EBCA87ULL;
 static uint64_t const PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
 static uint64_t const PRIME64_3 = 0x165667B19E3779F9ULL;
@@ -84,6 +86,38 @@ static uint64_t XXH64_avalanche(uint64_t hash)
     return hash;
 }
 
+static uint64_t XXH64_finalize(uint64_t hash, uint8_t const* const data, size_t offset,
+                               size_t remaining)
+{
+    while (remaining >= 8) {
+        hash ^= XXH64_round(0, XXH_read64(data, offset));
+        hash = XXH_rotl64(hash, 27);
+        hash *= PRIME64_1;
+        hash += PRIME64_4;
+        offset += 8;
+        remaining -= 8;
+    }
+
+    if (remaining >= 4) {
+        hash ^= (uint64_t)XXH_read32(data, offset) * PRIME64_1;
+        hash = XXH_rotl64(hash, 23);
+        hash *= PRIME64_2;
+        hash += PRIME64_3;
+        offset += 4;
+        remaining -= 4;
+    }
+
+    while (remaining != 0) {
+        hash ^= (uint64_t)data[offset] * PRIME64_5;
+        hash = XXH_rotl64(hash, 11);
+        hash *= PRIME64_1;
+        ++offset;
+        --remaining;
+    }
+
+    return XXH64_avalanche(hash);
+}
+
 static uint64_t XXH64(void const* const input, size_t const length, uint64_t const seed)
 {
     uint8_t const* const data = (uint8_t const*)input;
@@ -126,36 +160,61 @@ static uint64_t XXH64(void const* const input, size_t const length, uint64_t con
 
     hash += (uint64_t)length;
 
-    while (remaining >= 8) {
-        hash ^= XXH64_round(0, XXH_read64(data, offset));
-        hash = XXH_rotl64(hash, 27);
-        hash *= PRIME64_1;
-        hash += PRIME64_4;
-        offset += 8;
-        remaining -= 8;
-    }
-
-    if (remaining >= 4) {
-        hash ^= (uint64_t)XXH_read32(data, offset) * PRIME64_1;
-        hash = XXH_rotl64(hash, 23);
-        hash *= PRIME64_2;
-        hash += PRIME64_3;
-        offset += 4;
-        remaining -= 4;
-    }
-
-    while (remaining != 0) {
-        hash ^= (uint64_t)data[offset] * PRIME64_5;
-        hash = XXH_rotl64(hash, 11);
-        hash *= PRIME64_1;
-        ++offset;
-        --remaining;
-    }
-
-    return XXH64_avalanche(hash);
+    return XXH64_finalize(hash, data, offset, remaining);
 }
 
 uint64_t robin_table_xxh64(const void* key, size_t klen, uint64_t seed)
 {
     return XXH64(key, klen, seed);
 }
+
+/*
+ * XXH64 over fragments: the 32-byte stripes are read from the fragments in
+ * place, and the tail (under 32 bytes) is gathered if it spans fragments.
+ */
+uint64_t robin_xxh64_frags(const robin_table_frag_t* frags, size_t nfrags, size_t len,
+                           uint64_t seed)
+{
+    uint8_t buf[32];
+    uint64_t hash;
+    size_t remaining = len % 32;
+
+    if (len >= 32) {
+        robin_frag_cursor_t cur;
+        size_t nstripes = len / 32;
+        uint64_t acc1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t acc2 = seed + PRIME64_2;
+        uint64_t acc3 = seed + 0;
+        uint64_t acc4 = seed - PRIME64_1;
+
+        robin_frag_init(&cur, frags, nfrags);
+        while (nstripes) {
+            size_t n = nstripes;
+            uint8_t const* data = robin_frag_next(&cur, 32, &n, buf);
+            size_t offset = 0;
+
+            nstripes -= n;
+            while (n--) {
+                acc1 = XXH64_round(acc1, XXH_read64(data, offset));
+                acc2 = XXH64_round(acc2, XXH_read64(data, offset + 8));
+                acc3 = XXH64_round(acc3, XXH_read64(data, offset + 16));
+                acc4 = XXH64_round(acc4, XXH_read64(data, offset + 24));
+                offset += 32;
+            }
+        }
+
+        hash = XXH_rotl64(acc1, 1) + XXH_rotl64(acc2, 7) + XXH_rotl64(acc3, 12) +
+               XXH_rotl64(acc4, 18);
+
+        hash = XXH64_mergeRound(hash, acc1);
+        hash = XXH64_mergeRound(hash, acc2);
+        hash = XXH64_mergeRound(hash, acc3);
+        hash = XXH64_mergeRound(hash, acc4);
+    } else {
+        hash = seed + PRIME64_5;
+    }
+
+    hash += (uint64_t)len;
+
+    return XXH64_finalize(hash, robin_frag_tail(frags, nfrags, remaining, buf), 0, remaining);
+}
@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Fixture shared by the tests: random 64-bit keys, and the work range of a
+ * thread in the multi-threaded tests.
+ */
+
+#ifndef RTEST_KEYS_H
+#define RTEST_KEYS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef struct {
+    void* table;
+    uint64_t* keys;
+    size_t begin;
+    size_t end;
+    size_t failed;
+} test_worker_t;
+
+static inline uint64_t* test_alloc_keys(size_t count)
+{
+    uint64_t* keys;
+
+    keys = malloc(count * sizeof(*keys));
+    if (!keys) {
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = 0;
+        for (int j = 0; j < 4; ++j) {
+            keys[i] = (keys[i] << 16) | (random() & 0xFFFF);
+        }
+    }
+    return keys;
+}
+
+#endif /* RTEST_KEYS_H */
@@ -22,17 +22,30 @@
  * SOFTWARE.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "rtest.h"
 #include "robin_table.h"
+#include "robin_table_inline.h"
 
 #define TEST_NUM_ENTRIES    1000000UL  /* 1M */
 #define TEST_STR_LEN        32U
+#define TEST_NUM_THREADS    4U
+#define TEST_LONG_KEY       3000U
+#define TEST_FLOOD_KEYS     10000U
+#define TEST_NUM_ABANDON    1000U
+#define TEST_FLOOD_PSL      32U        /* Smallest default flood guard PSL */
+#define TEST_STREAM_ENTRY   (4 + 64)   /* First saved entry: block length, header */
 
 #define KEY_INT(k)          (k), sizeof(*(k))
 #define KEY_STR(k)          (k), TEST_STR_LEN + 1
+#define KEY_STR_LIT(k)      (k), sizeof(k) - 1
 
 typedef struct {
     size_t count;
@@ -211,6 +224,50 @@ TEST_ADD(test_get_int, uint64_t** keys, test_rt_options_t rt_opt)
     robin_table_destroy(rt);
 }
 
+TEST_ADD(test_u32_keys, test_rt_options_t rt_opt)
+{
+    robin_table_t* rt;
+    uint32_t* keys;
+    void* res;
+
+    rt = robin_table_create(rt_opt.count, robin_table_hash_u32, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    keys = malloc(rt_opt.count * sizeof(*keys));
+    if (!keys) {
+        exit(EXIT_FAILURE);
+    }
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        keys[i] = (uint32_t)(i * 2654435761U);
+        res = robin_table_put(rt, KEY_INT(&keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_get(rt, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    for (size_t i = 0; i < rt_opt.count; i += 2) {
+        res = robin_table_del(rt, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_count(rt) == rt_opt.count / 2);
+    ASSERT(robin_table_get(rt, KEY_INT(&keys[0])) == NULL);
+    ASSERT(robin_table_get(rt, KEY_INT(&keys[1])) == temp_val);
+
+    /* Keys of another length still work, hashed with rapidhash */
+    ASSERT(robin_table_put(rt, KEY_STR_LIT("lorem ipsum"), temp_val) == temp_val);
+    ASSERT(robin_table_get(rt, KEY_STR_LIT("lorem ipsum")) == temp_val);
+
+    free(keys);
+    robin_table_destroy(rt);
+}
+
 TEST_ADD(test_del_str, char** keys, test_rt_options_t rt_opt)
 {
     robin_table_t* rt;
@@ -298,7 +355,7 @@ TEST_ADD(test_iterate_str, char** keys, test_rt_options_t rt_opt)
     while (robin_table_iter_next(iter)) {
         const char* key = iter->key;
         char* val = iter->val;
-        ASSERT_LOOP(key != NULL && val != NULL, 2);
+        ASSERT_LOOP(key != NULL && iter->klen == TEST_STR_LEN + 1 && val != NULL, 2);
         ++iter_count;
     }
     TEST_LOOP_END(2);
@@ -336,7 +393,7 @@ TEST_ADD(test_iterate_int, uint64_t** keys, test_rt_options_t rt_opt)
     while (robin_table_iter_next(iter)) {
         const uint64_t* key = iter->key;
         char* val = iter->val;
-        ASSERT_LOOP(key != NULL && val != NULL, 2);
+        ASSERT_LOOP(key != NULL && iter->klen == sizeof(*key) && val != NULL, 2);
         ++iter_count;
     }
     TEST_LOOP_END(2);
@@ -347,105 +404,1227 @@ TEST_ADD(test_iterate_int, uint64_t** keys, test_rt_options_t rt_opt)
     robin_table_destroy(rt);
 }
 
-TEST_ADD(test_consistency, uint64_t** keys, test_rt_options_t rt_opt)
+static bool test_count_entry(const void* key, size_t klen, void* val, void* ctx)
 {
-    char* new_val = "ipsum";
+    size_t* count = ctx;
+
+    (void)klen;
+    if (key && val) {
+        ++*count;
+    }
+    return true;
+}
+
+static bool test_stop_entry(const void* key, size_t klen, void* val, void* ctx)
+{
+    size_t* count = ctx;
+
+    (void)key;
+    (void)klen;
+    (void)val;
+    return ++*count < 10;
+}
+
+TEST_ADD(test_get_batch, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    const void** batch_keys;
+    size_t* batch_klens;
+    void** vals_out;
+    robin_table_t* rt;
+
+    rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    batch_keys = malloc(rt_opt.count * sizeof(*batch_keys));
+    batch_klens = malloc(rt_opt.count * sizeof(*batch_klens));
+    vals_out = malloc(rt_opt.count * sizeof(*vals_out));
+    if (!batch_keys || !batch_klens || !vals_out) {
+        exit(EXIT_FAILURE);
+    }
+
+    /* Only the first half is present */
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        if (i < rt_opt.count / 2) {
+            robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+        }
+        batch_keys[i] = keys[i];
+        batch_klens[i] = sizeof(*keys[i]);
+    }
+
+    TEST_TIMER_START();
+    robin_table_get_batch(rt, batch_keys, batch_klens, rt_opt.count, vals_out);
+    TEST_TIMER_END();
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        ASSERT_LOOP(vals_out[i] == (i < rt_opt.count / 2 ? temp_val : NULL), 1);
+    }
+    TEST_LOOP_END(1);
+
+    free(batch_keys);
+    free(batch_klens);
+    free(vals_out);
+    robin_table_destroy(rt);
+}
+
+TEST_ADD(test_get_frags, char** keys, test_rt_options_t rt_opt)
+{
+    const size_t klen = sizeof(uint32_t) + TEST_STR_LEN;
+    robin_table_frag_t frags[3];
     robin_table_t* rt;
+    uint8_t* data;
+    uint8_t* xs;
+    uint8_t* last;
     void* res;
 
     rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
     ASSERT(rt != NULL);
 
+    /* Composite keys (index, string), stored contiguously in the table */
+    data = malloc(rt_opt.count * klen);
+    if (!data) {
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        uint32_t idx = (uint32_t)i;
+
+        memcpy(data + i * klen, &idx, sizeof(idx));
+        memcpy(data + i * klen + sizeof(idx), keys[i], TEST_STR_LEN);
+        robin_table_put(rt, data + i * klen, klen, keys[i]);
+    }
+
+    /* Looked up and deleted from their fields, with the string split in two */
     TEST_TIMER_START();
     TEST_LOOP_START(1);
     for (size_t i = 0; i < rt_opt.count; ++i) {
-        res = robin_table_put(rt, KEY_INT(keys[i]), temp_val);
-        ASSERT_LOOP(res == temp_val, 1);
+        uint32_t idx = (uint32_t)i;
+        size_t split = i % TEST_STR_LEN;
+
+        frags[0] = (robin_table_frag_t){&idx, sizeof(idx)};
+        frags[1] = (robin_table_frag_t){keys[i], split};
+        frags[2] = (robin_table_frag_t){keys[i] + split, TEST_STR_LEN - split};
+        res = robin_table_get_frags(rt, frags, 3);
+        ASSERT_LOOP(res == keys[i], 1);
+
+        if (i % 2) {
+            res = robin_table_del_frags(rt, frags, 3);
+            ASSERT_LOOP(res == keys[i], 1);
+            res = robin_table_get_frags(rt, frags, 3);
+            ASSERT_LOOP(res == NULL, 1);
+        }
+    }
+    TEST_LOOP_END(1);
+    TEST_TIMER_END();
 
-        res = robin_table_get(rt, KEY_INT(keys[i]));
+    ASSERT(robin_table_count(rt) == rt_opt.count - rt_opt.count / 2);
+
+    /* A different composite key of the same length */
+    frags[0] = (robin_table_frag_t){keys[0], TEST_STR_LEN};
+    frags[1] = (robin_table_frag_t){keys[0], sizeof(uint32_t)};
+    ASSERT(robin_table_get_frags(rt, frags, 2) == NULL);
+    ASSERT(robin_table_del_frags(rt, frags, 2) == NULL);
+    robin_table_destroy(rt);
+
+    /* Long keys, hashed and compared in place, differing only in their last byte */
+    rt = robin_table_create(0, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    xs = data + 128 * TEST_LONG_KEY;
+    last = xs + TEST_LONG_KEY;
+
+    memset(data, 'x', 129 * TEST_LONG_KEY);
+    for (size_t i = 0; i < 256; ++i) {
+        last[i] = (uint8_t)i;
+    }
+    for (size_t i = 0; i < 128; ++i) {
+        data[(i + 1) * TEST_LONG_KEY - 1] = (uint8_t)i;
+        robin_table_put(rt, data + i * TEST_LONG_KEY, TEST_LONG_KEY, keys[i]);
+    }
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < 256; ++i) {
+        frags[0] = (robin_table_frag_t){xs, TEST_LONG_KEY / 3};
+        frags[1] = (robin_table_frag_t){xs, TEST_LONG_KEY - TEST_LONG_KEY / 3 - 1};
+        frags[2] = (robin_table_frag_t){last + i, 1};
+        res = robin_table_get_frags(rt, frags, 3);
+        ASSERT_LOOP(res == (i < 128 ? keys[i] : NULL), 2);
+        res = robin_table_del_frags(rt, frags, 3);
+        ASSERT_LOOP(res == (i < 128 ? keys[i] : NULL), 2);
+    }
+    TEST_LOOP_END(2);
+    ASSERT(robin_table_count(rt) == 0);
+
+    free(data);
+    robin_table_destroy(rt);
+}
+
+TEST_ADD(test_for_each, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    robin_table_t* rt;
+    robin_table_iter_t iter;
+    size_t iter_count;
+    void* res;
+
+    rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_put(rt, KEY_INT(keys[i]), temp_val);
         ASSERT_LOOP(res == temp_val, 1);
     }
     TEST_LOOP_END(1);
 
-    TEST_LOOP_START(2);
+    /* Stack allocated iterator */
+    iter_count = 0;
+    robin_table_iter_init(&iter, rt);
+    while (robin_table_iter_next(&iter)) {
+        ++iter_count;
+    }
+    ASSERT(iter_count == TEST_NUM_ENTRIES);
+    ASSERT(iter.key == NULL && iter.klen == 0 && iter.val == NULL);
+
+    TEST_TIMER_START();
+    iter_count = 0;
+    ASSERT(robin_table_for_each(rt, test_count_entry, &iter_count) == true);
+    ASSERT(iter_count == TEST_NUM_ENTRIES);
+
+    iter_count = 0;
+    ASSERT(robin_table_for_each_inline(rt, test_count_entry, &iter_count) == true);
+    ASSERT(iter_count == TEST_NUM_ENTRIES);
+    TEST_TIMER_END();
+
+    iter_count = 0;
+    ASSERT(robin_table_for_each(rt, test_stop_entry, &iter_count) == false);
+    ASSERT(iter_count == 10);
+
+    robin_table_destroy(rt);
+}
+
+TEST_ADD(test_iter_erase, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    char* odd_val = "ipsum";
+    robin_table_t* rt;
+    robin_table_iter_t iter;
+    size_t iter_count;
+    size_t erase_count;
+    size_t abandon_count = 0;
+    double load;
+    void* res;
+
+    rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    TEST_LOOP_START(1);
     for (size_t i = 0; i < rt_opt.count; ++i) {
-        /* Remove odd entries */
-        if (i % 2 != 0) {
-            res = robin_table_del(rt, KEY_INT(keys[i]));
-            ASSERT_LOOP(res == temp_val, 2);
+        res = robin_table_put(rt, KEY_INT(keys[i]), i % 2 ? odd_val : temp_val);
+        ASSERT_LOOP(res != NULL, 1);
+    }
+    TEST_LOOP_END(1);
 
-            res = robin_table_get(rt, KEY_INT(keys[i]));
-            ASSERT_LOOP(res == NULL, 2);
-        } else {
-            /* Try overwriting existing entries */
-            res = robin_table_put(rt, KEY_INT(keys[i]), new_val);
-            ASSERT_LOOP(res == temp_val, 2);
+    iter_count = 0;
+    erase_count = 0;
 
-            res = robin_table_get(rt, KEY_INT(keys[i]));
-            ASSERT_LOOP(res == temp_val, 2);
+    /* Purge odd entries while iterating */
+    TEST_TIMER_START();
+    TEST_LOOP_START(2);
+    robin_table_iter_init_mut(&iter, rt);
+    while (robin_table_iter_next(&iter)) {
+        ++iter_count;
+        if (iter.val == odd_val) {
+            ASSERT_LOOP(robin_table_iter_erase(&iter) == odd_val, 2);
+            ++erase_count;
         }
     }
     TEST_LOOP_END(2);
+    TEST_TIMER_END();
 
-    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES / 2);
+    ASSERT(iter_count == TEST_NUM_ENTRIES);
+    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES - erase_count);
 
     TEST_LOOP_START(3);
     for (size_t i = 0; i < rt_opt.count; ++i) {
-        /* Re-insert into deleted slots */
-        if (i % 2 != 0) {
-            res = robin_table_get(rt, KEY_INT(keys[i]));
-            ASSERT_LOOP(res == NULL, 3);
+        res = robin_table_get(rt, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == (i % 2 ? NULL : temp_val), 3);
+    }
+    TEST_LOOP_END(3);
 
-            res = robin_table_put(rt, KEY_INT(keys[i]), new_val);
-            ASSERT_LOOP(res == new_val, 3);
+    /* Erase everything, which triggers a single deferred shrink */
+    robin_table_iter_init_mut(&iter, rt);
+    while (robin_table_iter_next(&iter)) {
+        robin_table_iter_erase(&iter);
+    }
+    ASSERT(robin_table_count(rt) == 0);
+    robin_table_destroy(rt);
 
-            res = robin_table_get(rt, KEY_INT(keys[i]));
-            ASSERT_LOOP(res == new_val, 3);
-        } else {
-            res = robin_table_get(rt, KEY_INT(keys[i]));
-            ASSERT_LOOP(res == temp_val, 3);
-        }
+    /* An abandoned traversal skips the shrink, the next deletion applies it */
+    rt = robin_table_create(0, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+    for (size_t i = 0; i < TEST_NUM_ABANDON; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), temp_val);
     }
-    TEST_LOOP_END(3);
-    TEST_TIMER_END();
+    load = robin_table_load_factor(rt);
 
-    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES);
+    robin_table_iter_init_mut(&iter, rt);
+    while (robin_table_iter_next(&iter) && robin_table_count(rt) > TEST_NUM_ABANDON / 10) {
+        robin_table_iter_erase(&iter);
+    }
+    ASSERT(robin_table_count(rt) == TEST_NUM_ABANDON / 10);
+    ASSERT(robin_table_load_factor(rt) < load / 5);
+    load = robin_table_load_factor(rt);
+
+    robin_table_iter_init(&iter, rt);
+    ASSERT(robin_table_iter_next(&iter));
+    ASSERT(robin_table_del(rt, iter.key, iter.klen) == temp_val);
+    ASSERT(robin_table_load_factor(rt) > load * 1.5);
+
+    robin_table_iter_init(&iter, rt);
+    while (robin_table_iter_next(&iter)) {
+        ++abandon_count;
+    }
+    ASSERT(abandon_count == TEST_NUM_ABANDON / 10 - 1);
     robin_table_destroy(rt);
 }
 
-TEST_ADD(test_clear, uint64_t** keys, test_rt_options_t rt_opt)
+static bool test_keep_entry(const void* key, size_t klen, void* val, void* ctx)
+{
+    (void)key;
+    (void)klen;
+    return val != ctx;
+}
+
+TEST_ADD(test_retain, uint64_t** keys, test_rt_options_t rt_opt)
 {
+    char* drop_val = "ipsum";
     robin_table_t* rt;
+    size_t removed;
     void* res;
 
     rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
     ASSERT(rt != NULL);
 
+    /* Mark about 40% of the entries for removal */
     TEST_LOOP_START(1);
     for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_put(rt, KEY_INT(keys[i]), i % 5 < 2 ? drop_val : temp_val);
+        ASSERT_LOOP(res != NULL, 1);
+    }
+    TEST_LOOP_END(1);
+
+    TEST_TIMER_START();
+    removed = robin_table_retain(rt, test_keep_entry, drop_val);
+    TEST_TIMER_END();
+
+    ASSERT(removed == (TEST_NUM_ENTRIES / 5) * 2);
+    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES - removed);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_get(rt, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == (i % 5 < 2 ? NULL : temp_val), 2);
+    }
+    TEST_LOOP_END(2);
+
+    /* Drop everything else, which shrinks the hash table in one step */
+    removed = robin_table_retain(rt, test_keep_entry, temp_val);
+    ASSERT(removed == TEST_NUM_ENTRIES - (TEST_NUM_ENTRIES / 5) * 2);
+    ASSERT(robin_table_count(rt) == 0);
+
+    robin_table_destroy(rt);
+}
+
+static void test_mark_entry(const void* key, size_t klen, void* val, void* ctx)
+{
+    robin_table_t* seen = ctx;
+
+    robin_table_put(seen, key, klen, val);
+}
+
+TEST_ADD(test_scan, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    const size_t scan_count = rt_opt.count / 10;
+    robin_table_t* rt;
+    robin_table_t* seen;
+    size_t cursor;
+    size_t next;
+    size_t calls;
+    void* res;
+
+    /* Start small so the hash table resizes while the scan is in progress */
+    rt = robin_table_create(0, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+    seen = robin_table_create(scan_count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(seen != NULL);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < scan_count * 2; ++i) {
         res = robin_table_put(rt, KEY_INT(keys[i]), temp_val);
         ASSERT_LOOP(res == temp_val, 1);
     }
     TEST_LOOP_END(1);
 
-    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES);
-
+    /*
+     * The first half of the keys is present for the whole scan; the second
+     * half is deleted (shrinking the hash table) and then re-inserted
+     * together with new keys (expanding the hash table) between calls.
+     */
     TEST_TIMER_START();
-    ASSERT(robin_table_clear(rt, false) == true);
+    cursor = 0;
+    calls = 0;
+    next = scan_count;
+    do {
+        cursor = robin_table_scan(rt, cursor, 16, test_mark_entry, seen);
+
+        for (size_t j = 0; j < 64; ++j, ++next) {
+            if (next < scan_count * 2) {
+                robin_table_del(rt, KEY_INT(keys[next]));
+            } else if (next < scan_count * 5) {
+                robin_table_put(rt, KEY_INT(keys[next - scan_count]), temp_val);
+            }
+        }
+        ++calls;
+    } while (cursor != 0);
     TEST_TIMER_END();
 
-    ASSERT(robin_table_count(rt) == 0);
+    ASSERT(calls > 1);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < scan_count; ++i) {
+        res = robin_table_get(seen, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == temp_val, 2);
+    }
+    TEST_LOOP_END(2);
+
+    robin_table_destroy(seen);
     robin_table_destroy(rt);
 }
 
-TEST_MAIN(
-    test_rt_options_t rt_opt; 
-    char** keys_str; 
-    uint64_t** keys_int;
+static int test_cmp_int(const void* key1, size_t klen1, const void* key2, size_t klen2)
+{
+    const uint64_t a = *(const uint64_t*)key1;
+    const uint64_t b = *(const uint64_t*)key2;
 
-    rt_opt.count = TEST_NUM_ENTRIES; 
-    rt_opt.hash_func = robin_table_rapidhash;
-    rt_opt.seed = RT_RAPID_SEED;
+    (void)klen1;
+    (void)klen2;
+    return (a > b) - (a < b);
+}
+
+TEST_ADD(test_export, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    robin_table_t* rt;
+    const void** keys_out;
+    size_t* klens_out;
+    void** vals_out;
+    size_t n;
+    void* res;
+
+    rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    keys_out = malloc(rt_opt.count * sizeof(*keys_out));
+    klens_out = malloc(rt_opt.count * sizeof(*klens_out));
+    vals_out = malloc(rt_opt.count * sizeof(*vals_out));
+    if (!keys_out || !klens_out || !vals_out) {
+        exit(EXIT_FAILURE);
+    }
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    TEST_TIMER_START();
+    n = robin_table_export(rt, keys_out, klens_out, vals_out, rt_opt.count);
+    TEST_TIMER_END();
+
+    ASSERT(n == TEST_NUM_ENTRIES);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT_LOOP(klens_out[i] == sizeof(uint64_t) && vals_out[i] == temp_val, 2);
+        res = robin_table_get(rt, keys_out[i], klens_out[i]);
+        ASSERT_LOOP(res == temp_val, 2);
+    }
+    TEST_LOOP_END(2);
+
+    /* Partial export */
+    ASSERT(robin_table_export(rt, keys_out, NULL, NULL, 100) == 100);
+
+    ASSERT(robin_table_export_sorted(rt, keys_out, NULL, vals_out, rt_opt.count, test_cmp_int,
+                                     &n) == true);
+    ASSERT(n == TEST_NUM_ENTRIES);
+
+    TEST_LOOP_START(3);
+    for (size_t i = 1; i < n; ++i) {
+        ASSERT_LOOP(*(const uint64_t*)keys_out[i - 1] < *(const uint64_t*)keys_out[i], 3);
+    }
+    TEST_LOOP_END(3);
+
+    ASSERT(robin_table_export_sorted(rt, keys_out, NULL, NULL, 10, NULL, &n) == true);
+    ASSERT(n == 10);
+
+    free(keys_out);
+    free(klens_out);
+    free(vals_out);
+    robin_table_destroy(rt);
+}
+
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+    size_t pos;
+    uint64_t val;
+    size_t vals_live;   /* Values loaded and not freed */
+} test_stream_t;
+
+static uint64_t test_load_le64(const uint8_t* p)
+{
+    uint64_t v = 0;
+
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static void test_store_le64(uint8_t* p, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+/*
+ * Recompute the chained block checksums of a saved stream edited in place,
+ * so that only the checks on its contents can reject it.
+ */
+static void test_stream_reseal(test_stream_t* stream)
+{
+    uint64_t check = 0;
+
+    for (size_t off = 0; off < stream->len;) {
+        const uint8_t* p = stream->data + off;
+        const size_t len = p[0] | (p[1] << 8) | ((size_t)p[2] << 16) | ((size_t)p[3] << 24);
+
+        check = robin_table_xxh64(p + 4, len, check);
+        test_store_le64(stream->data + off + 4 + len, check);
+        off += 4 + len + 8;
+    }
+    stream->pos = 0;
+}
+
+static bool test_stream_write(const void* buf, size_t len, void* ctx)
+{
+    test_stream_t* stream = ctx;
+
+    if (stream->len + len > stream->cap) {
+        stream->cap = (stream->len + len) * 2;
+        stream->data = realloc(stream->data, stream->cap);
+        if (!stream->data) {
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(stream->data + stream->len, buf, len);
+    stream->len += len;
+    return true;
+}
+
+static bool test_stream_read(void* buf, size_t len, void* ctx)
+{
+    test_stream_t* stream = ctx;
+
+    if (len > stream->len - stream->pos) {
+        return false;
+    }
+    memcpy(buf, stream->data + stream->pos, len);
+    stream->pos += len;
+    return true;
+}
+
+static const void* test_save_val(void* val, size_t* len, void* ctx)
+{
+    test_stream_t* stream = ctx;
+
+    stream->val = (uint64_t)(uintptr_t)val;
+    *len = sizeof(stream->val);
+    return &stream->val;
+}
+
+static void* test_load_val(const void* buf, size_t len, void* ctx)
+{
+    test_stream_t* stream = ctx;
+    uint64_t val;
+
+    if (len != sizeof(val)) {
+        return NULL;
+    }
+    memcpy(&val, buf, sizeof(val));
+    stream->vals_live++;
+    return (void*)(uintptr_t)val;
+}
+
+static void test_free_val(void* val, void* ctx)
+{
+    test_stream_t* stream = ctx;
+
+    (void)val;
+    stream->vals_live--;
+}
+
+TEST_ADD(test_save_load, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    robin_table_t* rt;
+    robin_table_t* loaded;
+    test_stream_t stream = {NULL, 0, 0, 0, 0, 0};
+    uint64_t idx;
+    void* res;
+
+    rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_put(rt, KEY_INT(keys[i]), (void*)(uintptr_t)(i + 1));
+        ASSERT_LOOP(res == (void*)(uintptr_t)(i + 1), 1);
+    }
+    TEST_LOOP_END(1);
+
+    ASSERT(robin_table_save(rt, test_stream_write, test_save_val, &stream));
+
+    TEST_TIMER_START();
+    loaded = robin_table_load(test_stream_read, test_load_val, test_free_val, &stream,
+                              rt_opt.hash_func);
+    TEST_TIMER_END();
+
+    ASSERT(loaded != NULL);
+    ASSERT(robin_table_count(loaded) == rt_opt.count);
+    ASSERT(stream.vals_live == rt_opt.count);
+    stream.vals_live = 0;
+    ASSERT(robin_table_psl_max(loaded) == robin_table_psl_max(rt));
+
+    /* Drop the original so the loaded keys are known to be owned copies */
+    robin_table_destroy(rt);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_get(loaded, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == (void*)(uintptr_t)(i + 1), 2);
+    }
+    TEST_LOOP_END(2);
+
+    /* The loaded hash table stays fully usable */
+    ASSERT(robin_table_del(loaded, KEY_INT(keys[0])) == (void*)(uintptr_t)1);
+    ASSERT(robin_table_get(loaded, KEY_INT(keys[0])) == NULL);
+    robin_table_destroy(loaded);
+
+    /* A corrupt or truncated stream is rejected, freeing the loaded values */
+    stream.data[stream.len / 2] ^= 1;
+    stream.pos = 0;
+    ASSERT(robin_table_load(test_stream_read, test_load_val, test_free_val, &stream,
+                            rt_opt.hash_func) == NULL);
+    ASSERT(stream.vals_live == 0);
+    stream.data[stream.len / 2] ^= 1;
+    stream.len -= 12;
+    stream.pos = 0;
+    ASSERT(robin_table_load(test_stream_read, test_load_val, test_free_val, &stream,
+                            rt_opt.hash_func) == NULL);
+    ASSERT(stream.vals_live == 0);
+
+    /* So is a mismatched hash function */
+    stream.len += 12;
+    stream.pos = 0;
+    ASSERT(robin_table_load(test_stream_read, test_load_val, NULL, &stream,
+                            robin_table_xxh64) == NULL);
+
+    /* So is a bucket layout that breaks the Robin Hood invariant */
+    rt = robin_table_create(0, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+    for (size_t i = 0; i < 8; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+    }
+    stream.len = 0;
+    stream.pos = 0;
+    ASSERT(robin_table_save(rt, test_stream_write, test_save_val, &stream));
+    robin_table_destroy(rt);
+
+    /* Move the first entry five buckets past its home, behind an empty bucket */
+    idx = test_load_le64(stream.data + TEST_STREAM_ENTRY);
+    test_store_le64(stream.data + TEST_STREAM_ENTRY + 8, idx - 5);
+    test_stream_reseal(&stream);
+    ASSERT(robin_table_load(test_stream_read, test_load_val, NULL, &stream,
+                            rt_opt.hash_func) == NULL);
+
+    free(stream.data);
+}
+
+/* Hashes every key to the same value */
+static uint64_t test_equal_hash(const void* key, size_t klen, uint64_t seed)
+{
+    (void)key;
+    (void)klen;
+    (void)seed;
+    return 42;
+}
+
+TEST_ADD(test_mphf, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    robin_table_t* rt;
+    robin_table_mphf_t* mp;
+    robin_table_mphf_t* loaded;
+    test_stream_t stream = {NULL, 0, 0, 0, 0, 0};
+    uint64_t missing = 0;
+    void* res;
+
+    rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), (void*)(uintptr_t)(i + 1));
+    }
+
+    TEST_TIMER_START();
+    mp = robin_table_freeze_mphf(rt);
+    TEST_TIMER_END();
+
+    ASSERT(mp != NULL);
+    ASSERT(robin_table_mphf_count(mp) == rt_opt.count);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_mphf_get(mp, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == (void*)(uintptr_t)(i + 1), 1);
+    }
+    TEST_LOOP_END(1);
+
+    /* Keys outside the set land on some slot and fail the compare */
+    while (robin_table_get(rt, KEY_INT(&missing))) {
+        missing++;
+    }
+    ASSERT(robin_table_mphf_get(mp, KEY_INT(&missing)) == NULL);
+
+    ASSERT(robin_table_mphf_save(mp, test_stream_write, test_save_val, &stream));
+    robin_table_mphf_destroy(mp);
+    robin_table_destroy(rt);
+
+    loaded = robin_table_mphf_load(test_stream_read, test_load_val, test_free_val, &stream,
+                                   rt_opt.hash_func);
+    ASSERT(loaded != NULL);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_mphf_get(loaded, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == (void*)(uintptr_t)(i + 1), 2);
+    }
+    TEST_LOOP_END(2);
+
+    robin_table_mphf_destroy(loaded);
+
+    /* A truncated stream is rejected, freeing the loaded values */
+    stream.len -= 12;
+    stream.pos = 0;
+    stream.vals_live = 0;
+    ASSERT(robin_table_mphf_load(test_stream_read, test_load_val, test_free_val, &stream,
+                                 rt_opt.hash_func) == NULL);
+    ASSERT(stream.vals_live == 0);
+
+    /* Keys with equal hash values are rejected up front */
+    rt = robin_table_create(0, test_equal_hash, rt_opt.seed);
+    ASSERT(rt != NULL);
+    for (size_t i = 0; i < 8; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+    }
+    ASSERT(robin_table_freeze_mphf(rt) == NULL);
+    robin_table_destroy(rt);
+
+    /* Empty table */
+    rt = robin_table_create(0, rt_opt.hash_func, rt_opt.seed);
+    mp = robin_table_freeze_mphf(rt);
+    ASSERT(mp != NULL && robin_table_mphf_count(mp) == 0);
+    ASSERT(robin_table_mphf_get(mp, KEY_INT(keys[0])) == NULL);
+    robin_table_mphf_destroy(mp);
+    robin_table_destroy(rt);
+
+    free(stream.data);
+}
+
+static bool test_count_image_entry(const void* key, size_t klen, const void* val,
+                                   size_t vlen, void* ctx)
+{
+    (void)key;
+    (void)val;
+    *(size_t*)ctx += (klen == sizeof(uint64_t) && vlen == sizeof(uint64_t));
+    return true;
+}
+
+TEST_ADD(test_image, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    robin_table_t* rt;
+    robin_table_image_t* img;
+    robin_table_image_t* img2;
+    test_stream_t stream = {NULL, 0, 0, 0, 0, 0};
+    const char* path = "t_robin_table.img";
+    struct stat st;
+    const void* res;
+    uint64_t val;
+    size_t vlen;
+    size_t n = 0;
+
+    rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), (void*)(uintptr_t)(i + 1));
+    }
+
+    ASSERT(robin_table_write_image(rt, path, test_save_val, &stream));
+    robin_table_destroy(rt);
+
+    TEST_TIMER_START();
+    img = robin_table_open_mmap(path, rt_opt.hash_func);
+    TEST_TIMER_END();
+
+    ASSERT(img != NULL);
+    ASSERT(robin_table_image_count(img) == rt_opt.count);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_image_get(img, KEY_INT(keys[i]), &vlen);
+        ASSERT_LOOP(res != NULL && vlen == sizeof(val), 1);
+        memcpy(&val, res, sizeof(val));
+        ASSERT_LOOP(val == i + 1, 1);
+    }
+    TEST_LOOP_END(1);
+
+    val = 0;
+    ASSERT(robin_table_image_get(img, KEY_INT(&val), NULL) == NULL);
+
+    ASSERT(robin_table_image_for_each(img, test_count_image_entry, &n));
+    ASSERT(n == rt_opt.count);
+
+    /* Several mappings of the same image */
+    img2 = robin_table_open_mmap(path, rt_opt.hash_func);
+    ASSERT(img2 != NULL);
+    ASSERT(robin_table_image_get(img2, KEY_INT(keys[0]), NULL) != NULL);
+    robin_table_image_close(img2);
+
+    /* A mismatched hash function is rejected */
+    ASSERT(robin_table_open_mmap(path, robin_table_xxh64) == NULL);
+
+    /* Rewriting the image replaces the file, leaving existing mappings intact */
+    rt = robin_table_create(0, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+    ASSERT(robin_table_write_image(rt, path, test_save_val, &stream));
+    robin_table_destroy(rt);
+    ASSERT(stat(path, &st) == 0 && (st.st_mode & 0777) == 0644);
+
+    img2 = robin_table_open_mmap(path, rt_opt.hash_func);
+    ASSERT(img2 != NULL);
+    ASSERT(robin_table_image_count(img2) == 0);
+    robin_table_image_close(img2);
+
+    res = robin_table_image_get(img, KEY_INT(keys[0]), &vlen);
+    ASSERT(res != NULL && vlen == sizeof(val));
+    memcpy(&val, res, sizeof(val));
+    ASSERT(val == 1);
+
+    robin_table_image_close(img);
+    remove(path);
+}
+
+typedef struct {
+    robin_table_t* rt;
+    uint64_t** keys;
+    size_t count;
+    size_t misses;
+    int* stop;
+} test_swmr_reader_t;
+
+static void* test_swmr_reader(void* arg)
+{
+    test_swmr_reader_t* reader = arg;
+
+    while (!__atomic_load_n(reader->stop, __ATOMIC_ACQUIRE)) {
+        for (size_t i = 0; i < reader->count; ++i) {
+            if (robin_table_get_swmr(reader->rt, KEY_INT(reader->keys[i])) != temp_val) {
+                ++reader->misses;
+            }
+        }
+    }
+    return NULL;
+}
+
+TEST_ADD(test_swmr, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    const size_t stable_count = rt_opt.count / 100;
+    test_swmr_reader_t readers[TEST_NUM_THREADS];
+    pthread_t threads[TEST_NUM_THREADS];
+    robin_table_t* rt;
+    int stop = 0;
+    void* res;
+
+    /* Start small so the writer resizes while readers are running */
+    rt = robin_table_create(0, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+    robin_table_swmr_enable(rt);
+
+    for (size_t i = 0; i < stable_count; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+    }
+
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        readers[t].rt = rt;
+        readers[t].keys = keys;
+        readers[t].count = stable_count;
+        readers[t].misses = 0;
+        readers[t].stop = &stop;
+        ASSERT(pthread_create(&threads[t], NULL, test_swmr_reader, &readers[t]) == 0);
+    }
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = stable_count; i < rt_opt.count; ++i) {
+        res = robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    for (size_t i = stable_count; i < rt_opt.count; ++i) {
+        res = robin_table_del(rt, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+    TEST_TIMER_END();
+
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        ASSERT(readers[t].misses == 0);
+    }
+
+    ASSERT(robin_table_count(rt) == stable_count);
+    ASSERT(robin_table_get_swmr(rt, KEY_INT(keys[rt_opt.count - 1])) == NULL);
+
+    robin_table_swmr_reclaim(rt);
+    robin_table_destroy(rt);
+}
+
+typedef struct {
+    robin_table_snapshot_t* snap;
+    size_t mismatches;
+    int* stop;
+} test_snapshot_reader_t;
+
+static void* test_snapshot_reader(void* arg)
+{
+    test_snapshot_reader_t* reader = arg;
+
+    while (!__atomic_load_n(reader->stop, __ATOMIC_ACQUIRE)) {
+        size_t count = 0;
+
+        if (!robin_table_snapshot_for_each(reader->snap, test_count_entry, &count) ||
+            count != robin_table_snapshot_count(reader->snap)) {
+            ++reader->mismatches;
+        }
+    }
+    return NULL;
+}
+
+TEST_ADD(test_snapshot, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    const size_t half = rt_opt.count / 2;
+    test_snapshot_reader_t readers[TEST_NUM_THREADS];
+    pthread_t threads[TEST_NUM_THREADS];
+    robin_table_snapshot_t* snap;
+    robin_table_snapshot_t* snap2;
+    robin_table_snapshot_t* snap3;
+    robin_table_t* rt;
+    size_t count = 0;
+    int stop = 0;
+    void* res;
+
+    rt = robin_table_create(0, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    for (size_t i = 0; i < half; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+    }
+
+    snap = robin_table_snapshot(rt);
+    ASSERT(snap != NULL);
+    ASSERT(robin_table_snapshot_count(snap) == half);
+
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        readers[t].snap = snap;
+        readers[t].mismatches = 0;
+        readers[t].stop = &stop;
+        ASSERT(pthread_create(&threads[t], NULL, test_snapshot_reader, &readers[t]) == 0);
+    }
+
+    /* Modify pages in place, then grow the hash table */
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < half / 2; ++i) {
+        res = robin_table_del(rt, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    snap2 = robin_table_snapshot(rt);
+    ASSERT(snap2 != NULL);
+
+    TEST_LOOP_START(2);
+    for (size_t i = half; i < rt_opt.count; ++i) {
+        res = robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 2);
+    }
+    TEST_LOOP_END(2);
+    TEST_TIMER_END();
+
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        ASSERT(readers[t].mismatches == 0);
+    }
+
+    /* The first write after the last snapshot is released drops the COW state */
+    snap3 = robin_table_snapshot(rt);
+    ASSERT(snap3 != NULL);
+    robin_table_snapshot_release(snap3);
+    res = robin_table_del(rt, KEY_INT(keys[half / 2]));
+    ASSERT(res == temp_val);
+    res = robin_table_put(rt, KEY_INT(keys[half / 2]), temp_val);
+    ASSERT(res == temp_val);
+
+    /* Both snapshots outlive the hash table */
+    robin_table_destroy(rt);
+
+    TEST_LOOP_START(3);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_snapshot_get(snap, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == (i < half ? temp_val : NULL), 3);
+
+        res = robin_table_snapshot_get(snap2, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == (i >= half / 2 && i < half ? temp_val : NULL), 3);
+    }
+    TEST_LOOP_END(3);
+
+    ASSERT(robin_table_snapshot_for_each(snap2, test_count_entry, &count) == true);
+    ASSERT(count == half - half / 2);
+
+    robin_table_snapshot_release(snap);
+    robin_table_snapshot_release(snap2);
+}
+
+TEST_ADD(test_consistency, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    char* new_val = "ipsum";
+    robin_table_t* rt;
+    void* res;
+
+    rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+
+        res = robin_table_get(rt, KEY_INT(keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        /* Remove odd entries */
+        if (i % 2 != 0) {
+            res = robin_table_del(rt, KEY_INT(keys[i]));
+            ASSERT_LOOP(res == temp_val, 2);
+
+            res = robin_table_get(rt, KEY_INT(keys[i]));
+            ASSERT_LOOP(res == NULL, 2);
+        } else {
+            /* Try overwriting existing entries */
+            res = robin_table_put(rt, KEY_INT(keys[i]), new_val);
+            ASSERT_LOOP(res == temp_val, 2);
+
+            res = robin_table_get(rt, KEY_INT(keys[i]));
+            ASSERT_LOOP(res == temp_val, 2);
+        }
+    }
+    TEST_LOOP_END(2);
+
+    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES / 2);
+
+    TEST_LOOP_START(3);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        /* Re-insert into deleted slots */
+        if (i % 2 != 0) {
+            res = robin_table_get(rt, KEY_INT(keys[i]));
+            ASSERT_LOOP(res == NULL, 3);
+
+            res = robin_table_put(rt, KEY_INT(keys[i]), new_val);
+            ASSERT_LOOP(res == new_val, 3);
+
+            res = robin_table_get(rt, KEY_INT(keys[i]));
+            ASSERT_LOOP(res == new_val, 3);
+        } else {
+            res = robin_table_get(rt, KEY_INT(keys[i]));
+            ASSERT_LOOP(res == temp_val, 3);
+        }
+    }
+    TEST_LOOP_END(3);
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES);
+    robin_table_destroy(rt);
+}
+
+TEST_ADD(test_clear, uint64_t** keys, test_rt_options_t rt_opt)
+{
+    robin_table_t* rt;
+    void* res;
+
+    rt = robin_table_create(rt_opt.count, rt_opt.hash_func, rt_opt.seed);
+    ASSERT(rt != NULL);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < rt_opt.count; ++i) {
+        res = robin_table_put(rt, KEY_INT(keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES);
+
+    TEST_TIMER_START();
+    ASSERT(robin_table_clear(rt, false) == true);
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_count(rt) == 0);
+    robin_table_destroy(rt);
+}
+
+/* Collides every key under the default seed, like keys crafted against it */
+static uint64_t test_seeded_weak_hash(const void* key, size_t klen, uint64_t seed)
+{
+    const uint64_t hash = robin_table_rapidhash(key, klen, seed);
+
+    return seed == RT_RAPID_SEED ? hash & ~(uint64_t)0xffff : hash;
+}
+
+/* Collides every key whatever the seed */
+static uint64_t test_unseeded_weak_hash(const void* key, size_t klen, uint64_t seed)
+{
+    (void)seed;
+    return robin_table_rapidhash(key, klen, RT_RAPID_SEED) & ~(uint64_t)0xffff;
+}
+
+/* Return true if the hash table no longer hashes the keys to colliding values */
+static bool test_hash_spread(const robin_table_t* rt, uint64_t** keys)
+{
+    uint64_t low = 0;
+
+    for (size_t i = 0; i < 16; ++i) {
+        low |= robin_table_hash(rt, KEY_INT(keys[i])) & 0xffff;
+    }
+    return low != 0;
+}
+
+static void test_count_reseed(robin_table_t* rt, size_t psl, void* ctx)
+{
+    size_t* reseeds = ctx;
+
+    (void)rt;
+    (void)psl;
+    ++*reseeds;
+}
+
+TEST_ADD(test_flood_guard, uint64_t** keys)
+{
+    robin_table_t* rt;
+    size_t reseeds = 0;
+
+    /* A fresh seed is enough against keys crafted for the default seed */
+    rt = robin_table_create(0, test_seeded_weak_hash, RT_RAPID_SEED);
+    ASSERT(rt != NULL);
+    robin_table_flood_guard(rt, 0, NULL, test_count_reseed, &reseeds);
+
+    TEST_TIMER_START();
+    for (size_t i = 0; i < TEST_FLOOD_KEYS; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), keys[i]);
+    }
+    TEST_TIMER_END();
+
+    ASSERT(reseeds == 1);
+    ASSERT(test_hash_spread(rt, keys));
+    ASSERT(robin_table_psl_max(rt) < TEST_FLOOD_PSL);
+    ASSERT(robin_table_count(rt) == TEST_FLOOD_KEYS);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_FLOOD_KEYS; ++i) {
+        ASSERT_LOOP(robin_table_get(rt, KEY_INT(keys[i])) == keys[i], 1);
+    }
+    TEST_LOOP_END(1);
+    robin_table_destroy(rt);
+
+    /* Keys that collide under any seed need the keyed hash function */
+    reseeds = 0;
+    rt = robin_table_create(0, test_unseeded_weak_hash, RT_RAPID_SEED);
+    ASSERT(rt != NULL);
+    robin_table_flood_guard(rt, 0, robin_table_siphash13, test_count_reseed, &reseeds);
+
+    for (size_t i = 0; i < TEST_FLOOD_KEYS; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), keys[i]);
+    }
+
+    ASSERT(reseeds == 1);
+    ASSERT(test_hash_spread(rt, keys));
+    ASSERT(robin_table_psl_max(rt) < TEST_FLOOD_PSL);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < TEST_FLOOD_KEYS; ++i) {
+        ASSERT_LOOP(robin_table_get(rt, KEY_INT(keys[i])) == keys[i], 2);
+    }
+    TEST_LOOP_END(2);
+    robin_table_destroy(rt);
+
+    /* Without one, the guard backs off instead of reseeding on every insertion */
+    reseeds = 0;
+    rt = robin_table_create(0, test_unseeded_weak_hash, RT_RAPID_SEED);
+    ASSERT(rt != NULL);
+    robin_table_flood_guard(rt, 0, NULL, test_count_reseed, &reseeds);
+
+    for (size_t i = 0; i < TEST_FLOOD_KEYS; ++i) {
+        robin_table_put(rt, KEY_INT(keys[i]), keys[i]);
+    }
+
+    ASSERT(reseeds > 0 && reseeds < 32);
+
+    TEST_LOOP_START(3);
+    for (size_t i = 0; i < TEST_FLOOD_KEYS; ++i) {
+        ASSERT_LOOP(robin_table_get(rt, KEY_INT(keys[i])) == keys[i], 3);
+    }
+    TEST_LOOP_END(3);
+    robin_table_destroy(rt);
+}
+
+TEST_MAIN(
+    test_rt_options_t rt_opt; 
+    test_rt_options_t rt_opt_u64;
+    char** keys_str; 
+    uint64_t** keys_int;
+
+    rt_opt.count = TEST_NUM_ENTRIES; 
+    rt_opt.hash_func = robin_table_rapidhash;
+    rt_opt.seed = RT_RAPID_SEED;
+
+    rt_opt_u64 = rt_opt;
+    rt_opt_u64.hash_func = robin_table_hash_u64;
 
     keys_str = test_alloc_keys_str(); 
     keys_int = test_alloc_keys_int();
@@ -459,10 +1638,26 @@ TEST_MAIN(
     TEST_RUN(test_get_int, keys_int, rt_opt);
     TEST_RUN(test_del_str, keys_str, rt_opt); 
     TEST_RUN(test_del_int, keys_int, rt_opt);
+    TEST_RUN(test_get_int, keys_int, rt_opt_u64);
+    TEST_RUN(test_del_int, keys_int, rt_opt_u64);
+    TEST_RUN(test_u32_keys, rt_opt);
     TEST_RUN(test_iterate_str, keys_str, rt_opt); 
     TEST_RUN(test_iterate_int, keys_int, rt_opt); 
+    TEST_RUN(test_get_batch, keys_int, rt_opt);
+    TEST_RUN(test_get_frags, keys_str, rt_opt);
+    TEST_RUN(test_for_each, keys_int, rt_opt);
+    TEST_RUN(test_iter_erase, keys_int, rt_opt);
+    TEST_RUN(test_retain, keys_int, rt_opt);
+    TEST_RUN(test_scan, keys_int, rt_opt);
+    TEST_RUN(test_export, keys_int, rt_opt);
+    TEST_RUN(test_save_load, keys_int, rt_opt);
+    TEST_RUN(test_image, keys_int, rt_opt);
+    TEST_RUN(test_mphf, keys_int, rt_opt);
+    TEST_RUN(test_swmr, keys_int, rt_opt);
+    TEST_RUN(test_snapshot, keys_int, rt_opt);
     TEST_RUN(test_consistency, keys_int, rt_opt);
     TEST_RUN(test_clear, keys_int, rt_opt);
+    TEST_RUN(test_flood_guard, keys_int);
 
     test_free_keys(keys_str, keys_int);
 )
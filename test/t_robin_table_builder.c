@@ -0,0 +1,214 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "rtest.h"
+#include "rtest_keys.h"
+#include "robin_table.h"
+
+#define TEST_NUM_ENTRIES    1000000UL  /* 1M */
+#define TEST_NUM_SHARED     1000U      /* Keys every thread adds */
+#define TEST_NUM_THREADS    8U
+#define TEST_NUM_DUP_KEYS   1000U      /* Keys added over and over */
+#define TEST_NUM_DUP_ROUNDS 200U
+
+#define KEY_INT(k)          (k), sizeof(*(k))
+
+static char* temp_val = "lorem";  /* Placeholder value */
+
+TEST_ADD(test_builder_freeze, uint64_t* keys)
+{
+    robin_table_builder_t* rb;
+    robin_table_t* rt;
+    void* res;
+
+    rb = robin_table_builder_create(TEST_NUM_ENTRIES, robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(rb != NULL);
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_builder_put(rb, KEY_INT(&keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    /* Duplicate keys keep the existing value */
+    ASSERT(robin_table_builder_put(rb, KEY_INT(&keys[0]), "ipsum") == temp_val);
+
+    rt = robin_table_freeze(rb);
+    TEST_TIMER_END();
+    ASSERT(rt != NULL);
+    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_get(rt, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 2);
+    }
+    TEST_LOOP_END(2);
+
+    /* The frozen hash table is an ordinary one */
+    ASSERT(robin_table_del(rt, KEY_INT(&keys[0])) == temp_val);
+    ASSERT(robin_table_count(rt) == TEST_NUM_ENTRIES - 1);
+    robin_table_destroy(rt);
+}
+
+static void* test_builder_worker(void* arg)
+{
+    test_worker_t* worker = arg;
+
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        if (robin_table_builder_put(worker->table, KEY_INT(&worker->keys[i]), temp_val) !=
+            temp_val) {
+            ++worker->failed;
+        }
+
+        /* Race with the other threads on the shared keys */
+        if (i % 1000 == 0) {
+            for (size_t j = 0; j < TEST_NUM_SHARED; ++j) {
+                robin_table_builder_put(worker->table, KEY_INT(&worker->keys[j]), temp_val);
+            }
+        }
+    }
+    return NULL;
+}
+
+TEST_ADD(test_builder_threads, uint64_t* keys)
+{
+    test_worker_t workers[TEST_NUM_THREADS];
+    pthread_t threads[TEST_NUM_THREADS];
+    robin_table_builder_t* rb;
+    robin_table_t* rt;
+    const size_t per_thread = (TEST_NUM_ENTRIES - TEST_NUM_SHARED) / TEST_NUM_THREADS;
+
+    /* Duplicates do not use up capacity */
+    rb = robin_table_builder_create(TEST_NUM_SHARED + TEST_NUM_THREADS * per_thread,
+                                    robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(rb != NULL);
+
+    TEST_TIMER_START();
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        workers[t].table = rb;
+        workers[t].keys = keys;
+        workers[t].begin = TEST_NUM_SHARED + t * per_thread;
+        workers[t].end = TEST_NUM_SHARED + (t + 1) * per_thread;
+        workers[t].failed = 0;
+        ASSERT(pthread_create(&threads[t], NULL, test_builder_worker, &workers[t]) == 0);
+    }
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        ASSERT(workers[t].failed == 0);
+    }
+    rt = robin_table_freeze(rb);
+    TEST_TIMER_END();
+    ASSERT(rt != NULL);
+
+    ASSERT(robin_table_count(rt) == TEST_NUM_SHARED + TEST_NUM_THREADS * per_thread);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_SHARED + TEST_NUM_THREADS * per_thread; ++i) {
+        ASSERT_LOOP(robin_table_get(rt, KEY_INT(&keys[i])) == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    /* No duplicate survives: every shared key is removed by one delete */
+    TEST_LOOP_START(2);
+    for (size_t j = 0; j < TEST_NUM_SHARED; ++j) {
+        ASSERT_LOOP(robin_table_del(rt, KEY_INT(&keys[j])) == temp_val, 2);
+        ASSERT_LOOP(robin_table_get(rt, KEY_INT(&keys[j])) == NULL, 2);
+    }
+    TEST_LOOP_END(2);
+
+    robin_table_destroy(rt);
+}
+
+static void* test_builder_dup_worker(void* arg)
+{
+    test_worker_t* worker = arg;
+
+    for (size_t round = 0; round < TEST_NUM_DUP_ROUNDS; ++round) {
+        for (size_t i = worker->begin; i < worker->end; ++i) {
+            if (robin_table_builder_put(worker->table, KEY_INT(&worker->keys[i]), temp_val) !=
+                temp_val) {
+                ++worker->failed;
+            }
+        }
+    }
+    return NULL;
+}
+
+TEST_ADD(test_builder_duplicates, uint64_t* keys)
+{
+    test_worker_t workers[TEST_NUM_THREADS];
+    pthread_t threads[TEST_NUM_THREADS];
+    robin_table_builder_t* rb;
+    robin_table_t* rt;
+
+    /* Far more puts than capacity, all but TEST_NUM_DUP_KEYS of them duplicates */
+    rb = robin_table_builder_create(TEST_NUM_DUP_KEYS, robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(rb != NULL);
+
+    TEST_TIMER_START();
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        workers[t].table = rb;
+        workers[t].keys = keys;
+        workers[t].begin = 0;
+        workers[t].end = TEST_NUM_DUP_KEYS;
+        workers[t].failed = 0;
+        ASSERT(pthread_create(&threads[t], NULL, test_builder_dup_worker, &workers[t]) == 0);
+    }
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        ASSERT(workers[t].failed == 0);
+    }
+    rt = robin_table_freeze(rb);
+    TEST_TIMER_END();
+    ASSERT(rt != NULL);
+    ASSERT(robin_table_count(rt) == TEST_NUM_DUP_KEYS);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_DUP_KEYS; ++i) {
+        ASSERT_LOOP(robin_table_get(rt, KEY_INT(&keys[i])) == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    robin_table_destroy(rt);
+}
+
+TEST_MAIN(
+    uint64_t* keys;
+
+    srandom(42);
+    keys = test_alloc_keys(TEST_NUM_ENTRIES);
+
+    TEST_RUN(test_builder_freeze, keys);
+    TEST_RUN(test_builder_threads, keys);
+    TEST_RUN(test_builder_duplicates, keys);
+
+    free(keys);
+)
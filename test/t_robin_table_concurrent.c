@@ -0,0 +1,218 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "rtest.h"
+#include "rtest_keys.h"
+#include "robin_table.h"
+
+#define TEST_NUM_ENTRIES    1000000UL  /* 1M */
+#define TEST_NUM_THREADS    8U
+#define TEST_MAX_THREADS    128U  /* Slots of a concurrent hash table */
+
+#define KEY_INT(k)          (k), sizeof(*(k))
+
+static char* temp_val = "lorem";  /* Placeholder value */
+
+TEST_ADD(test_concurrent_put_get_del, uint64_t* keys)
+{
+    robin_table_concurrent_t* ct;
+    void* res;
+
+    ct = robin_table_concurrent_create(0, robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(ct != NULL);
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_concurrent_put(ct, KEY_INT(&keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_concurrent_get(ct, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    ASSERT(robin_table_concurrent_count(ct) == TEST_NUM_ENTRIES);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_concurrent_del(ct, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 2);
+    }
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_concurrent_get(ct, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == NULL, 2);
+    }
+    TEST_LOOP_END(2);
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_concurrent_count(ct) == 0);
+    robin_table_concurrent_destroy(ct);
+}
+
+/*
+ * Every thread inserts its own range of keys, reads them back and deletes
+ * every other one, while the other threads grow the same table.
+ */
+static void* test_concurrent_worker(void* arg)
+{
+    test_worker_t* worker = arg;
+
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        if (robin_table_concurrent_put(worker->table, KEY_INT(&worker->keys[i]), temp_val) !=
+            temp_val) {
+            ++worker->failed;
+        }
+    }
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        if (robin_table_concurrent_get(worker->table, KEY_INT(&worker->keys[i])) != temp_val) {
+            ++worker->failed;
+        }
+    }
+    for (size_t i = worker->begin; i < worker->end; i += 2) {
+        if (robin_table_concurrent_del(worker->table, KEY_INT(&worker->keys[i])) != temp_val) {
+            ++worker->failed;
+        }
+    }
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        void* expected = (i - worker->begin) % 2 ? temp_val : NULL;
+
+        if (robin_table_concurrent_get(worker->table, KEY_INT(&worker->keys[i])) != expected) {
+            ++worker->failed;
+        }
+    }
+    return NULL;
+}
+
+TEST_ADD(test_concurrent_threads, uint64_t* keys)
+{
+    test_worker_t workers[TEST_NUM_THREADS];
+    pthread_t threads[TEST_NUM_THREADS];
+    robin_table_concurrent_t* ct;
+    const size_t per_thread = TEST_NUM_ENTRIES / TEST_NUM_THREADS;
+
+    ct = robin_table_concurrent_create(0, robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(ct != NULL);
+
+    TEST_TIMER_START();
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        workers[t].table = ct;
+        workers[t].keys = keys;
+        workers[t].begin = t * per_thread;
+        workers[t].end = (t + 1) * per_thread;
+        workers[t].failed = 0;
+        ASSERT(pthread_create(&threads[t], NULL, test_concurrent_worker, &workers[t]) == 0);
+    }
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        ASSERT(workers[t].failed == 0);
+    }
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_concurrent_count(ct) == TEST_NUM_THREADS * (per_thread / 2));
+
+    /* The table is still usable from the main thread */
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_THREADS * per_thread; ++i) {
+        void* expected = (i % per_thread) % 2 ? temp_val : NULL;
+        ASSERT_LOOP(robin_table_concurrent_get(ct, KEY_INT(&keys[i])) == expected, 1);
+    }
+    TEST_LOOP_END(1);
+
+    robin_table_concurrent_destroy(ct);
+}
+
+typedef struct {
+    robin_table_concurrent_t* table;
+    pthread_barrier_t registered;
+    pthread_barrier_t done;
+    size_t failed;
+} test_slots_t;
+
+/*
+ * Hold a slot of the table until the main thread has tried to register.
+ */
+static void* test_concurrent_slot_holder(void* arg)
+{
+    test_slots_t* slots = arg;
+
+    if (!robin_table_concurrent_register(slots->table)) {
+        __atomic_fetch_add(&slots->failed, 1, __ATOMIC_RELAXED);
+    }
+    pthread_barrier_wait(&slots->registered);
+    pthread_barrier_wait(&slots->done);
+    return NULL;
+}
+
+TEST_ADD(test_concurrent_register, uint64_t* keys)
+{
+    pthread_t threads[TEST_MAX_THREADS];
+    test_slots_t slots;
+
+    slots.table = robin_table_concurrent_create(0, robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(slots.table != NULL);
+    slots.failed = 0;
+    ASSERT(pthread_barrier_init(&slots.registered, NULL, TEST_MAX_THREADS + 1) == 0);
+    ASSERT(pthread_barrier_init(&slots.done, NULL, TEST_MAX_THREADS + 1) == 0);
+
+    for (size_t t = 0; t < TEST_MAX_THREADS; ++t) {
+        ASSERT(pthread_create(&threads[t], NULL, test_concurrent_slot_holder, &slots) == 0);
+    }
+    pthread_barrier_wait(&slots.registered);
+    ASSERT(slots.failed == 0);
+
+    /* All slots are taken */
+    ASSERT(robin_table_concurrent_register(slots.table) == false);
+
+    pthread_barrier_wait(&slots.done);
+    for (size_t t = 0; t < TEST_MAX_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    /* Exited threads freed their slots */
+    ASSERT(robin_table_concurrent_register(slots.table) == true);
+    ASSERT(robin_table_concurrent_put(slots.table, KEY_INT(&keys[0]), temp_val) == temp_val);
+
+    pthread_barrier_destroy(&slots.registered);
+    pthread_barrier_destroy(&slots.done);
+    robin_table_concurrent_destroy(slots.table);
+}
+
+TEST_MAIN(
+    uint64_t* keys;
+
+    srandom(42);
+    keys = test_alloc_keys(TEST_NUM_ENTRIES);
+
+    TEST_RUN(test_concurrent_put_get_del, keys);
+    TEST_RUN(test_concurrent_threads, keys);
+    TEST_RUN(test_concurrent_register, keys);
+
+    free(keys);
+)
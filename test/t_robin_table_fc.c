@@ -0,0 +1,160 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "rtest.h"
+#include "rtest_keys.h"
+#include "robin_table.h"
+
+#define TEST_NUM_ENTRIES    1000000UL  /* 1M */
+#define TEST_NUM_THREADS    8U
+
+#define KEY_INT(k)          (k), sizeof(*(k))
+
+static char* temp_val = "lorem";  /* Placeholder value */
+
+TEST_ADD(test_fc_put_get_del, uint64_t* keys)
+{
+    robin_table_fc_t* fc;
+    void* res;
+
+    fc = robin_table_fc_create(0, robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(fc != NULL);
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_fc_put(fc, KEY_INT(&keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_fc_get(fc, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    ASSERT(robin_table_fc_count(fc) == TEST_NUM_ENTRIES);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_fc_del(fc, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 2);
+    }
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_fc_get(fc, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == NULL, 2);
+    }
+    TEST_LOOP_END(2);
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_fc_count(fc) == 0);
+    robin_table_fc_destroy(fc);
+}
+
+/*
+ * Every thread inserts its own range of keys, reads them back and deletes
+ * every other one, while the other threads grow the same table.
+ */
+static void* test_fc_worker(void* arg)
+{
+    test_worker_t* worker = arg;
+
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        if (robin_table_fc_put(worker->table, KEY_INT(&worker->keys[i]), temp_val) !=
+            temp_val) {
+            ++worker->failed;
+        }
+    }
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        if (robin_table_fc_get(worker->table, KEY_INT(&worker->keys[i])) != temp_val) {
+            ++worker->failed;
+        }
+    }
+    for (size_t i = worker->begin; i < worker->end; i += 2) {
+        if (robin_table_fc_del(worker->table, KEY_INT(&worker->keys[i])) != temp_val) {
+            ++worker->failed;
+        }
+    }
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        void* expected = (i - worker->begin) % 2 ? temp_val : NULL;
+
+        if (robin_table_fc_get(worker->table, KEY_INT(&worker->keys[i])) != expected) {
+            ++worker->failed;
+        }
+    }
+    return NULL;
+}
+
+TEST_ADD(test_fc_threads, uint64_t* keys)
+{
+    test_worker_t workers[TEST_NUM_THREADS];
+    pthread_t threads[TEST_NUM_THREADS];
+    robin_table_fc_t* fc;
+    const size_t per_thread = TEST_NUM_ENTRIES / TEST_NUM_THREADS;
+
+    fc = robin_table_fc_create(0, robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(fc != NULL);
+
+    TEST_TIMER_START();
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        workers[t].table = fc;
+        workers[t].keys = keys;
+        workers[t].begin = t * per_thread;
+        workers[t].end = (t + 1) * per_thread;
+        workers[t].failed = 0;
+        ASSERT(pthread_create(&threads[t], NULL, test_fc_worker, &workers[t]) == 0);
+    }
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        ASSERT(workers[t].failed == 0);
+    }
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_fc_count(fc) == TEST_NUM_THREADS * (per_thread / 2));
+
+    /* The table is still usable from the main thread */
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_THREADS * per_thread; ++i) {
+        void* expected = (i % per_thread) % 2 ? temp_val : NULL;
+        ASSERT_LOOP(robin_table_fc_get(fc, KEY_INT(&keys[i])) == expected, 1);
+    }
+    TEST_LOOP_END(1);
+
+    robin_table_fc_destroy(fc);
+}
+
+TEST_MAIN(
+    uint64_t* keys;
+
+    srandom(42);
+    keys = test_alloc_keys(TEST_NUM_ENTRIES);
+
+    TEST_RUN(test_fc_put_get_del, keys);
+    TEST_RUN(test_fc_threads, keys);
+
+    free(keys);
+)
@@ -0,0 +1,558 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rtest.h"
+#include "robin_table.h"
+
+#define TEST_NUM_SAMPLES    4000
+#define TEST_NUM_BUCKETS    4096
+#define TEST_NUM_KEYS       (TEST_NUM_BUCKETS * 16)
+#define TEST_MAX_BIAS       0.05
+#define TEST_MAX_CHI        1.15
+#define TEST_SEED           0x9e3779b97f4a7c15ULL
+#define TEST_BATCH_SIZE     512
+#define TEST_MAX_FRAGS      64
+#define TEST_MAX_FRAG_KEY   5000
+
+typedef uint64_t (*test_hash_fn_t)(const void*, size_t, uint64_t);
+
+/* Portable implementations of the accelerated hash functions, internal to the library */
+uint64_t robin_hash_crc32c_portable(const void* key, size_t klen, uint64_t seed);
+uint64_t robin_hash_aes_portable(const void* key, size_t klen, uint64_t seed);
+
+typedef struct {
+    const char* name;
+    test_hash_fn_t fn;
+    size_t klen;    /* Only keys of this length, or 0 for any */
+} test_hash_t;
+
+static const test_hash_t test_hashes[] = {
+    {"rapidhash", robin_table_rapidhash, 0},
+    {"siphash", robin_table_siphash, 0},
+    {"siphash13", robin_table_siphash13, 0},
+    {"xxh64", robin_table_xxh64, 0},
+    {"xxh3", robin_table_xxh3, 0},
+    {"crc32c", robin_table_hash_crc32c, 0},
+    {"aes", robin_table_hash_aes, 0},
+    {"auto", robin_table_hash_auto, 0},
+    {"u64", robin_table_hash_u64, 8}
+};
+
+#define TEST_NUM_HASHES (sizeof(test_hashes) / sizeof(test_hashes[0]))
+
+static int test_cmp_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Count the duplicates in hashes, comparing only the bits in mask.
+ */
+static size_t test_collisions(uint64_t* hashes, size_t n, uint64_t mask)
+{
+    size_t dups = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        hashes[i] &= mask;
+    }
+    qsort(hashes, n, sizeof(*hashes), test_cmp_u64);
+    for (size_t i = 1; i < n; ++i) {
+        dups += hashes[i] == hashes[i - 1];
+    }
+    return dups;
+}
+
+/*
+ * Flip every bit of random keys of length klen and return the largest
+ * deviation from 0.5 of the probability that an output bit flips with it.
+ */
+static double test_avalanche(test_hash_fn_t fn, size_t klen, uint64_t seed)
+{
+    static uint32_t flips[64 * 8][64];
+    uint8_t key[64];
+    double bias = 0.0;
+
+    memset(flips, 0, sizeof(flips));
+    for (size_t s = 0; s < TEST_NUM_SAMPLES; ++s) {
+        uint64_t h;
+
+        for (size_t i = 0; i < klen; ++i) {
+            key[i] = (uint8_t)random();
+        }
+        h = fn(key, klen, seed);
+        for (size_t bit = 0; bit < klen * 8; ++bit) {
+            uint64_t d;
+
+            key[bit / 8] ^= (uint8_t)(1U << (bit % 8));
+            d = h ^ fn(key, klen, seed);
+            key[bit / 8] ^= (uint8_t)(1U << (bit % 8));
+            for (size_t out = 0; out < 64; ++out) {
+                flips[bit][out] += (d >> out) & 1;
+            }
+        }
+    }
+
+    for (size_t bit = 0; bit < klen * 8; ++bit) {
+        for (size_t out = 0; out < 64; ++out) {
+            double p = (double)flips[bit][out] / TEST_NUM_SAMPLES;
+            double d = p > 0.5 ? p - 0.5 : 0.5 - p;
+
+            bias = d > bias ? d : bias;
+        }
+    }
+    return bias;
+}
+
+/*
+ * Hash the 8-byte keys with at most two bits set and the 64-byte keys with
+ * exactly two bits set, and return the number of 64-bit collisions (or of
+ * collisions in the low 32 bits when low is set).
+ */
+static size_t test_sparse(test_hash_fn_t fn, size_t klen, uint64_t seed, bool low)
+{
+    size_t nbits = klen * 8;
+    size_t n = 0;
+    uint64_t* hashes;
+    uint8_t key[64];
+    size_t dups;
+
+    hashes = malloc((1 + nbits + nbits * (nbits - 1) / 2) * sizeof(*hashes));
+    if (!hashes) {
+        exit(EXIT_FAILURE);
+    }
+
+    memset(key, 0, sizeof(key));
+    if (klen == 8) {
+        hashes[n++] = fn(key, klen, seed);
+    }
+    for (size_t i = 0; i < nbits; ++i) {
+        key[i / 8] ^= (uint8_t)(1U << (i % 8));
+        if (klen == 8) {
+            hashes[n++] = fn(key, klen, seed);
+        }
+        for (size_t j = i + 1; j < nbits; ++j) {
+            key[j / 8] ^= (uint8_t)(1U << (j % 8));
+            hashes[n++] = fn(key, klen, seed);
+            key[j / 8] ^= (uint8_t)(1U << (j % 8));
+        }
+        key[i / 8] ^= (uint8_t)(1U << (i % 8));
+    }
+
+    dups = test_collisions(hashes, n, low ? UINT32_MAX : UINT64_MAX);
+    free(hashes);
+    return dups;
+}
+
+/*
+ * Place sequential integer keys of length klen into buckets by the low bits
+ * of their hash and return the chi-square statistic over its expected value.
+ */
+static double test_chi_square(test_hash_fn_t fn, size_t klen, uint64_t seed)
+{
+    static uint32_t buckets[TEST_NUM_BUCKETS];
+    double expected = (double)TEST_NUM_KEYS / TEST_NUM_BUCKETS;
+    double chi = 0.0;
+    uint8_t key[64] = {0};
+
+    memset(buckets, 0, sizeof(buckets));
+    for (uint64_t i = 0; i < TEST_NUM_KEYS; ++i) {
+        memcpy(key, &i, sizeof(i));
+        buckets[fn(key, klen, seed) & (TEST_NUM_BUCKETS - 1)]++;
+    }
+    for (size_t i = 0; i < TEST_NUM_BUCKETS; ++i) {
+        double d = buckets[i] - expected;
+
+        chi += d * d / expected;
+    }
+    return chi / (TEST_NUM_BUCKETS - 1);
+}
+
+TEST_ADD(test_hash_known_answers, uint64_t seed)
+{
+    uint8_t buf[300];
+
+    /* Whichever implementation the dispatch picked */
+    ASSERT(robin_table_hash_crc32c("hello", 5, 0) == 0x3b5f16b32300bfd2ULL);
+    ASSERT(robin_table_hash_aes("hello", 5, 0) == 0xe592a2db40261cbcULL);
+    ASSERT(robin_hash_crc32c_portable("hello", 5, 0) == 0x3b5f16b32300bfd2ULL);
+    ASSERT(robin_hash_aes_portable("hello", 5, 0) == 0xe592a2db40261cbcULL);
+    ASSERT(robin_table_hash_crc32c("hello", 5, seed) != robin_table_hash_crc32c("hello", 5, 0));
+    ASSERT(robin_table_hash_aes("hello", 5, seed) != robin_table_hash_aes("hello", 5, 0));
+
+    /* The seed and every byte of the key, including the tail, matter */
+    TEST_LOOP_START(0);
+    for (size_t i = 0; i < 2; ++i) {
+        test_hash_fn_t fn = i ? robin_table_hash_aes : robin_table_hash_crc32c;
+        uint8_t key[100];
+
+        memset(key, 'a', sizeof(key));
+        for (size_t klen = 1; klen <= sizeof(key); ++klen) {
+            uint64_t h = fn(key, klen, seed);
+
+            ASSERT_LOOP(h != fn(key, klen, seed + 1), 0);
+            ASSERT_LOOP(h != fn(key, klen - 1, seed), 0);
+            key[klen - 1] = 'b';
+            ASSERT_LOOP(h != fn(key, klen, seed), 0);
+            key[klen - 1] = 'a';
+        }
+    }
+    TEST_LOOP_END(0);
+
+    /* The accelerated implementations match the portable ones on every length */
+    for (size_t i = 0; i < sizeof(buf); ++i) {
+        buf[i] = (uint8_t)random();
+    }
+    TEST_LOOP_START(1);
+    for (size_t klen = 0; klen <= sizeof(buf); ++klen) {
+        for (uint64_t s = 0; s < 4; ++s) {
+            const uint64_t sd = seed * s;
+
+            ASSERT_LOOP(robin_table_hash_crc32c(buf, klen, sd) ==
+                            robin_hash_crc32c_portable(buf, klen, sd), 1);
+            ASSERT_LOOP(robin_table_hash_aes(buf, klen, sd) ==
+                            robin_hash_aes_portable(buf, klen, sd), 1);
+        }
+    }
+    TEST_LOOP_END(1);
+}
+
+TEST_ADD(test_hash_siphash, uint64_t seed)
+{
+    /* Reference vectors: key 00..0f, messages 00..(len - 1) */
+    static const uint64_t sip24[16] = {
+        0x726fdb47dd0e0e31ULL, 0x74f839c593dc67fdULL, 0x0d6c8009d9a94f5aULL,
+        0x85676696d7fb7e2dULL, 0xcf2794e0277187b7ULL, 0x18765564cd99a68dULL,
+        0xcbc9466e58fee3ceULL, 0xab0200f58b01d137ULL, 0x93f5f5799a932462ULL,
+        0x9e0082df0ba9e4b0ULL, 0x7a5dbbc594ddb9f3ULL, 0xf4b32f46226bada7ULL,
+        0x751e8fbc860ee5fbULL, 0x14ea5627c0843d90ULL, 0xf723ca908e7af2eeULL,
+        0xa129ca6149be45e5ULL
+    };
+    static const uint64_t sip13[16] = {
+        0xabac0158050fc4dcULL, 0xc9f49bf37d57ca93ULL, 0x82cb9b024dc7d44dULL,
+        0x8bf80ab8e7ddf7fbULL, 0xcf75576088d38328ULL, 0xdef9d52f49533b67ULL,
+        0xc50d2b50c59f22a7ULL, 0xd3927d989bb11140ULL, 0x369095118d299a8eULL,
+        0x25a48eb36c063de4ULL, 0x79de85ee92ff097fULL, 0x70c118c1f94dc352ULL,
+        0x78a384b157b4d9a2ULL, 0x306f760c1229ffa7ULL, 0x605aa111c0f95d34ULL,
+        0xd320d86d2a519956ULL
+    };
+    /*
+     * SipHash-2-4 of the seeded function, from an independent implementation
+     * of the reference algorithm: seed 0x0706050403020100, messages
+     * 00..(len - 1). Saved tables and images depend on these values.
+     */
+    static const struct {
+        size_t len;
+        uint64_t hash;
+    } seeded24[] = {
+        {0, 0xce6cefb959750503ULL},  {1, 0xde51774ddeb8e1ccULL},
+        {7, 0x1f7723beab9b2fc5ULL},  {8, 0x1daa2cd3b0524fcbULL},
+        {15, 0xbdc5c39703a7f905ULL}, {16, 0xb92f029bb108458aULL},
+        {63, 0xda706df7e14da552ULL}
+    };
+    uint8_t k[16], msg[64];
+
+    for (size_t i = 0; i < sizeof(msg); ++i) {
+        msg[i] = (uint8_t)i;
+    }
+    for (size_t i = 0; i < sizeof(k); ++i) {
+        k[i] = (uint8_t)i;
+    }
+
+    TEST_LOOP_START(0);
+    for (size_t len = 0; len < 16; ++len) {
+        ASSERT_LOOP(robin_table_siphash_key128(msg, len, k) == sip24[len], 0);
+        ASSERT_LOOP(robin_table_siphash13_key128(msg, len, k) == sip13[len], 0);
+    }
+    TEST_LOOP_END(0);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < sizeof(seeded24) / sizeof(seeded24[0]); ++i) {
+        ASSERT_LOOP(robin_table_siphash(msg, seeded24[i].len, 0x0706050403020100ULL) ==
+                        seeded24[i].hash, 2);
+    }
+    TEST_LOOP_END(2);
+
+    /* The 64-bit seed is the key (seed, seed >> 32) */
+    for (size_t i = 0; i < 8; ++i) {
+        k[i] = (uint8_t)(seed >> (8 * i));
+        k[i + 8] = i < 4 ? (uint8_t)(seed >> (32 + 8 * i)) : 0;
+    }
+    TEST_LOOP_START(1);
+    for (size_t len = 0; len <= sizeof(msg); ++len) {
+        ASSERT_LOOP(robin_table_siphash(msg, len, seed) ==
+                        robin_table_siphash_key128(msg, len, k), 1);
+        ASSERT_LOOP(robin_table_siphash13(msg, len, seed) ==
+                        robin_table_siphash13_key128(msg, len, k), 1);
+    }
+    TEST_LOOP_END(1);
+}
+
+TEST_ADD(test_hash_xxh3, uint64_t seed)
+{
+    /* XXH3_64bits_withSeed of the reference implementation */
+    static const struct {
+        size_t len;
+        uint64_t hash;
+        uint64_t hash_seed;
+    } answers[] = {
+        {0, 0x2d06800538d394c2ULL, 0x602b0e2cd6662c8bULL},
+        {3, 0x15f7093b173d005cULL, 0x079dd5d54d89480aULL},
+        {8, 0xdec6a9a43575982eULL, 0x19ef7d3919108affULL},
+        {16, 0x7e484c18d74895d0ULL, 0xa106510078b0a252ULL},
+        {100, 0x8c97158042fbf926ULL, 0xa0f79a4ca977f3f1ULL},
+        {200, 0x12fdb864685f344dULL, 0x49dff623641b01b4ULL},
+        {2048, 0x19f6f9c987331373ULL, 0x060600a6317839f9ULL}
+    };
+    uint8_t key[2048];
+
+    for (size_t i = 0; i < sizeof(key); ++i) {
+        key[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    TEST_LOOP_START(0);
+    for (size_t i = 0; i < sizeof(answers) / sizeof(answers[0]); ++i) {
+        ASSERT_LOOP(robin_table_xxh3(key, answers[i].len, 0) == answers[i].hash, 0);
+        ASSERT_LOOP(robin_table_xxh3(key, answers[i].len, seed) == answers[i].hash_seed, 0);
+    }
+    TEST_LOOP_END(0);
+
+    /* Every byte of a long key matters, whichever stripe or block it is in */
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < sizeof(key); i += 7) {
+        uint64_t h = robin_table_xxh3(key, sizeof(key), seed);
+
+        key[i] ^= 1;
+        ASSERT_LOOP(h != robin_table_xxh3(key, sizeof(key), seed), 1);
+        key[i] ^= 1;
+    }
+    TEST_LOOP_END(1);
+}
+
+static uint64_t test_custom_hash(const void* key, size_t klen, uint64_t seed)
+{
+    return robin_table_xxh64(key, klen, seed) + 1;
+}
+
+TEST_ADD(test_hash_batch, uint64_t seed)
+{
+    /* Runs of equal lengths, of odd sizes, between keys of other lengths */
+    static const size_t run_lens[] = {8, 8, 16, 4, 8, 3, 16, 12, 8, 4, 40};
+    static const size_t run_sizes[] = {1, 37, 9, 4, 3, 11, 64, 5, 128, 17, 6};
+    const void* keys[TEST_BATCH_SIZE];
+    size_t klens[TEST_BATCH_SIZE];
+    uint64_t out[TEST_BATCH_SIZE];
+    uint8_t* data;
+    size_t n = 0;
+
+    data = malloc(TEST_BATCH_SIZE * 64);
+    if (!data) {
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < TEST_BATCH_SIZE * 64; ++i) {
+        data[i] = (uint8_t)random();
+    }
+    for (size_t r = 0; r < sizeof(run_lens) / sizeof(run_lens[0]); ++r) {
+        for (size_t i = 0; i < run_sizes[r]; ++i, ++n) {
+            keys[n] = data + n * 64 + n % 7;
+            klens[n] = run_lens[r];
+        }
+    }
+
+    TEST_LOOP_START(0);
+    for (int id = RT_HASH_RAPIDHASH; robin_table_hash_func((robin_table_hash_id_t)id); ++id) {
+        uint64_t (*hash_func)(const void*, size_t, uint64_t);
+
+        hash_func = robin_table_hash_func((robin_table_hash_id_t)id);
+        ASSERT_LOOP(robin_table_hash_batch((robin_table_hash_id_t)id, keys, klens, n, seed, out), 0);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_LOOP(out[i] == hash_func(keys[i], klens[i], seed), 0);
+        }
+
+        memset(out, 0, sizeof(out));
+        robin_table_hash_keys(hash_func, keys, klens, n, seed, out);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_LOOP(out[i] == hash_func(keys[i], klens[i], seed), 0);
+        }
+    }
+    TEST_LOOP_END(0);
+
+    /* Functions that are not built in are called for every key */
+    robin_table_hash_keys(test_custom_hash, keys, klens, n, seed, out);
+    ASSERT(out[1] == test_custom_hash(keys[1], klens[1], seed));
+    ASSERT(out[n - 1] == test_custom_hash(keys[n - 1], klens[n - 1], seed));
+    ASSERT(!robin_table_hash_batch((robin_table_hash_id_t)-1, keys, klens, n, seed, out));
+
+    free(data);
+}
+
+/*
+ * Split len bytes at data into up to TEST_MAX_FRAGS fragments at random
+ * points, some of them empty, and return their number.
+ */
+static size_t test_split(const uint8_t* data, size_t len, robin_table_frag_t* frags)
+{
+    size_t nfrags = 1 + (size_t)random() % TEST_MAX_FRAGS;
+    size_t off = 0;
+
+    for (size_t i = 0; i < nfrags; ++i) {
+        size_t n = len - off;
+
+        /* Often short fragments, as in a composite key */
+        if (i + 1 < nfrags) {
+            n = (size_t)random() % (random() % 2 ? n + 1 : (n < 9 ? n + 1 : 9));
+        }
+        frags[i] = (robin_table_frag_t){data + off, n};
+        off += n;
+    }
+    return nfrags;
+}
+
+/*
+ * Key lengths to hash in fragments: every length around the sizes at which
+ * keys are no longer gathered (2048 bytes) and sparser ones elsewhere.
+ */
+static size_t test_next_frag_len(size_t len)
+{
+    return len < 300 || (len >= 1900 && len < 2300) ? len + 1 : len + 97;
+}
+
+TEST_ADD(test_hash_frags, uint64_t seed)
+{
+    static const test_hash_fn_t hash_funcs[] = {
+        robin_table_rapidhash, robin_table_siphash, robin_table_siphash13,
+        robin_table_xxh64, robin_table_xxh3, robin_table_hash_u64, robin_table_hash_u32,
+        robin_table_hash_crc32c, robin_table_hash_aes, robin_table_hash_auto,
+        test_custom_hash
+    };
+    static const uint64_t seeds[] = {0, TEST_SEED};
+    static robin_table_frag_t bytes[TEST_MAX_FRAG_KEY];
+    robin_table_frag_t frags[TEST_MAX_FRAGS];
+    uint8_t* data;
+    uint64_t h;
+
+    data = malloc(TEST_MAX_FRAG_KEY);
+    if (!data) {
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < TEST_MAX_FRAG_KEY; ++i) {
+        data[i] = (uint8_t)random();
+        bytes[i] = (robin_table_frag_t){data + i, 1};
+    }
+
+    TEST_LOOP_START(0);
+    for (size_t f = 0; f < sizeof(hash_funcs) / sizeof(hash_funcs[0]); ++f) {
+        for (size_t len = 0; len <= TEST_MAX_FRAG_KEY; len = test_next_frag_len(len)) {
+            for (size_t s = 0; s < 2; ++s) {
+                const uint64_t expected = hash_funcs[f](data, len, seeds[s] ^ seed);
+
+                for (int r = 0; r < 4; ++r) {
+                    size_t nfrags = test_split(data, len, frags);
+
+                    ASSERT_LOOP(robin_table_hash_frags(hash_funcs[f], frags, nfrags,
+                                                       seeds[s] ^ seed, &h), 0);
+                    ASSERT_LOOP(h == expected, 0);
+                }
+
+                /* One byte per fragment */
+                ASSERT_LOOP(robin_table_hash_frags(hash_funcs[f], bytes, len, seeds[s] ^ seed,
+                                                   &h), 0);
+                ASSERT_LOOP(h == expected, 0);
+            }
+        }
+    }
+    TEST_LOOP_END(0);
+
+    free(data);
+}
+
+TEST_ADD(test_hash_avalanche, uint64_t seed)
+{
+    static const size_t klens[] = {8, 16, 32, 64};
+
+    TEST_LOOP_START(0);
+    for (size_t i = 0; i < TEST_NUM_HASHES; ++i) {
+        for (size_t j = 0; j < sizeof(klens) / sizeof(klens[0]); ++j) {
+            if (test_hashes[i].klen && test_hashes[i].klen != klens[j]) {
+                continue;
+            }
+            ASSERT_LOOP(test_avalanche(test_hashes[i].fn, klens[j], seed) < TEST_MAX_BIAS, 0);
+        }
+    }
+    TEST_LOOP_END(0);
+}
+
+TEST_ADD(test_hash_sparse_keys, uint64_t seed)
+{
+    static const size_t klens[] = {8, 64};
+
+    TEST_LOOP_START(0);
+    for (size_t i = 0; i < TEST_NUM_HASHES; ++i) {
+        for (size_t j = 0; j < sizeof(klens) / sizeof(klens[0]); ++j) {
+            if (test_hashes[i].klen && test_hashes[i].klen != klens[j]) {
+                continue;
+            }
+            /* About 2 expected collisions in 32 bits out of 130K keys */
+            ASSERT_LOOP(test_sparse(test_hashes[i].fn, klens[j], seed, false) == 0, 0);
+            ASSERT_LOOP(test_sparse(test_hashes[i].fn, klens[j], seed, true) < 10, 0);
+        }
+    }
+    TEST_LOOP_END(0);
+}
+
+TEST_ADD(test_hash_distribution, uint64_t seed)
+{
+    static const size_t klens[] = {4, 8, 24};
+
+    TEST_LOOP_START(0);
+    for (size_t i = 0; i < TEST_NUM_HASHES; ++i) {
+        for (size_t j = 0; j < sizeof(klens) / sizeof(klens[0]); ++j) {
+            if (test_hashes[i].klen && test_hashes[i].klen != klens[j]) {
+                continue;
+            }
+            ASSERT_LOOP(test_chi_square(test_hashes[i].fn, klens[j], seed) < TEST_MAX_CHI, 0);
+        }
+    }
+    TEST_LOOP_END(0);
+}
+
+TEST_MAIN(
+    srandom(42);
+
+    TEST_RUN(test_hash_known_answers, TEST_SEED);
+    TEST_RUN(test_hash_siphash, TEST_SEED);
+    TEST_RUN(test_hash_xxh3, TEST_SEED);
+    TEST_RUN(test_hash_batch, TEST_SEED);
+    TEST_RUN(test_hash_frags, TEST_SEED);
+    TEST_RUN(test_hash_avalanche, TEST_SEED);
+    TEST_RUN(test_hash_sparse_keys, TEST_SEED);
+    TEST_RUN(test_hash_distribution, TEST_SEED);
+)
@@ -0,0 +1,218 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "rtest.h"
+#include "robin_table.h"
+
+#define TEST_NUM_ENTRIES    100000UL   /* 100K */
+#define TEST_SEGMENT_SIZE   (256U << 10)
+
+#define KEY_INT(k)          (k), sizeof(*(k))
+
+static uint64_t* test_alloc_keys(void)
+{
+    uint64_t* keys;
+
+    keys = malloc(TEST_NUM_ENTRIES * sizeof(*keys));
+    if (!keys) {
+        exit(EXIT_FAILURE);
+    }
+
+    /* Distinct keys */
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        keys[i] = ((uint64_t)(random() & 0xFFFF) << 32) | i;
+    }
+    return keys;
+}
+
+static void test_remove_dir(const char* dir)
+{
+    struct dirent* de;
+    char path[512];
+    DIR* dp;
+
+    dp = opendir(dir);
+    if (!dp) {
+        return;
+    }
+    while ((de = readdir(dp)) != NULL) {
+        if (de->d_name[0] != '.') {
+            snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+            remove(path);
+        }
+    }
+    closedir(dp);
+    rmdir(dir);
+}
+
+/*
+ * Check that every key i maps to the value i + gen, or is absent if deleted.
+ */
+static size_t test_kv_check(robin_table_kv_t* kv, uint64_t* keys, uint64_t gen)
+{
+    size_t errors = 0;
+    uint64_t val;
+    size_t vlen;
+    bool found;
+
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        found = robin_table_kv_get(kv, KEY_INT(&keys[i]), &val, sizeof(val), &vlen);
+        if (i % 4 == 0) {
+            errors += found;
+        } else {
+            errors += !found || vlen != sizeof(val) || val != i + (i % 2 ? gen : 0);
+        }
+    }
+    return errors;
+}
+
+TEST_ADD(test_kv_put_get_del, uint64_t* keys)
+{
+    char dir[] = "/tmp/t_robin_table_kv.XXXXXX";
+    robin_table_kv_t* kv;
+    uint64_t val;
+    size_t vlen;
+
+    ASSERT(mkdtemp(dir) != NULL);
+    kv = robin_table_kv_open(dir, TEST_SEGMENT_SIZE);
+    ASSERT(kv != NULL);
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        val = i;
+        ASSERT_LOOP(robin_table_kv_put(kv, KEY_INT(&keys[i]), &val, sizeof(val)), 1);
+    }
+
+    /* Overwrite the odd keys and delete every fourth one */
+    for (size_t i = 1; i < TEST_NUM_ENTRIES; i += 2) {
+        val = i + 1;
+        ASSERT_LOOP(robin_table_kv_put(kv, KEY_INT(&keys[i]), &val, sizeof(val)), 1);
+    }
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; i += 4) {
+        ASSERT_LOOP(robin_table_kv_del(kv, KEY_INT(&keys[i])), 1);
+    }
+    TEST_LOOP_END(1);
+    TEST_TIMER_END();
+
+    ASSERT(!robin_table_kv_del(kv, KEY_INT(&keys[0])));
+    ASSERT(robin_table_kv_count(kv) == TEST_NUM_ENTRIES - TEST_NUM_ENTRIES / 4);
+    ASSERT(test_kv_check(kv, keys, 1) == 0);
+
+    /* Truncated read */
+    ASSERT(robin_table_kv_get(kv, KEY_INT(&keys[1]), &val, 0, &vlen) && vlen == sizeof(val));
+
+    ASSERT(robin_table_kv_compact(kv));
+    ASSERT(test_kv_check(kv, keys, 1) == 0);
+
+    /* Writes after the compaction land in a newer segment */
+    val = 0;
+    ASSERT(robin_table_kv_put(kv, KEY_INT(&keys[3]), &val, sizeof(val)));
+    ASSERT(robin_table_kv_sync(kv));
+    val = 3 + 1;
+    ASSERT(robin_table_kv_put(kv, KEY_INT(&keys[3]), &val, sizeof(val)));
+
+    robin_table_kv_close(kv);
+    test_remove_dir(dir);
+}
+
+TEST_ADD(test_kv_recover, uint64_t* keys)
+{
+    char dir[] = "/tmp/t_robin_table_kv.XXXXXX";
+    robin_table_kv_t* kv;
+    struct dirent* de;
+    char path[512];
+    uint64_t val;
+    FILE* fp;
+    DIR* dp;
+
+    ASSERT(mkdtemp(dir) != NULL);
+    kv = robin_table_kv_open(dir, TEST_SEGMENT_SIZE);
+    ASSERT(kv != NULL);
+
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        val = i;
+        robin_table_kv_put(kv, KEY_INT(&keys[i]), &val, sizeof(val));
+    }
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; i += 4) {
+        robin_table_kv_del(kv, KEY_INT(&keys[i]));
+    }
+    ASSERT(robin_table_kv_compact(kv));
+
+    /* Records after the compaction are replayed from the data files */
+    for (size_t i = 1; i < TEST_NUM_ENTRIES; i += 2) {
+        val = i + 2;
+        robin_table_kv_put(kv, KEY_INT(&keys[i]), &val, sizeof(val));
+    }
+    robin_table_kv_close(kv);
+
+    /* Simulate a torn write at the end of every segment */
+    dp = opendir(dir);
+    ASSERT(dp != NULL);
+    while ((de = readdir(dp)) != NULL) {
+        if (strstr(de->d_name, ".data")) {
+            snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+            fp = fopen(path, "ab");
+            ASSERT(fp != NULL);
+            fwrite("torn", 1, 4, fp);
+            fclose(fp);
+        }
+    }
+    closedir(dp);
+
+    TEST_TIMER_START();
+    kv = robin_table_kv_open(dir, TEST_SEGMENT_SIZE);
+    TEST_TIMER_END();
+
+    ASSERT(kv != NULL);
+    ASSERT(robin_table_kv_count(kv) == TEST_NUM_ENTRIES - TEST_NUM_ENTRIES / 4);
+    ASSERT(test_kv_check(kv, keys, 2) == 0);
+
+    /* The recovered store keeps working */
+    ASSERT(robin_table_kv_del(kv, KEY_INT(&keys[1])));
+    ASSERT(!robin_table_kv_get(kv, KEY_INT(&keys[1]), &val, sizeof(val), NULL));
+
+    robin_table_kv_close(kv);
+    test_remove_dir(dir);
+}
+
+TEST_MAIN(
+    uint64_t* keys;
+
+    srandom(42);
+    keys = test_alloc_keys();
+
+    TEST_RUN(test_kv_put_get_del, keys);
+    TEST_RUN(test_kv_recover, keys);
+
+    free(keys);
+)
@@ -0,0 +1,219 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "rtest.h"
+#include "rtest_keys.h"
+#include "robin_table.h"
+
+#define TEST_NUM_ENTRIES    1000000UL  /* 1M */
+#define TEST_NUM_SHARDS     16U
+#define TEST_NUM_THREADS    4U
+
+#define KEY_INT(k)          (k), sizeof(*(k))
+
+typedef struct {
+    const void** keys;
+    size_t* klens;
+    void** vals;
+    void** vals_out;
+} test_batch_t;
+
+static char* temp_val = "lorem";  /* Placeholder value */
+
+static void test_alloc_batch(test_batch_t* batch, uint64_t* keys)
+{
+    batch->keys = malloc(TEST_NUM_ENTRIES * sizeof(*batch->keys));
+    batch->klens = malloc(TEST_NUM_ENTRIES * sizeof(*batch->klens));
+    batch->vals = malloc(TEST_NUM_ENTRIES * sizeof(*batch->vals));
+    batch->vals_out = malloc(TEST_NUM_ENTRIES * sizeof(*batch->vals_out));
+    if (!batch->keys || !batch->klens || !batch->vals || !batch->vals_out) {
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        batch->keys[i] = &keys[i];
+        batch->klens[i] = sizeof(keys[i]);
+        batch->vals[i] = temp_val;
+    }
+}
+
+static void test_free_batch(test_batch_t* batch)
+{
+    free(batch->keys);
+    free(batch->klens);
+    free(batch->vals);
+    free(batch->vals_out);
+}
+
+TEST_ADD(test_pool_get_batch, uint64_t* keys)
+{
+    robin_table_pool_t* pool;
+    robin_table_t* rt;
+    test_batch_t batch;
+
+    pool = robin_table_pool_create(TEST_NUM_THREADS);
+    ASSERT(pool != NULL);
+
+    rt = robin_table_create(TEST_NUM_ENTRIES, robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(rt != NULL);
+
+    test_alloc_batch(&batch, keys);
+
+    /* Only the even keys are present */
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; i += 2) {
+        robin_table_put(rt, KEY_INT(&keys[i]), temp_val);
+    }
+
+    TEST_TIMER_START();
+    robin_table_get_batch_parallel(pool, rt, batch.keys, batch.klens, TEST_NUM_ENTRIES,
+                                   batch.vals_out);
+    TEST_TIMER_END();
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        ASSERT_LOOP(batch.vals_out[i] == (i % 2 ? NULL : temp_val), 1);
+    }
+    TEST_LOOP_END(1);
+
+    /* Batches smaller than a chunk run on the calling thread */
+    robin_table_get_batch_parallel(pool, rt, batch.keys, batch.klens, 10, batch.vals_out);
+    ASSERT(batch.vals_out[0] == temp_val && batch.vals_out[1] == NULL);
+
+    test_free_batch(&batch);
+    robin_table_destroy(rt);
+    robin_table_pool_destroy(pool);
+}
+
+TEST_ADD(test_pool_sharded_put_batch, uint64_t* keys)
+{
+    robin_table_pool_t* pool;
+    robin_table_sharded_t* st;
+    test_batch_t batch;
+
+    pool = robin_table_pool_create(TEST_NUM_THREADS);
+    ASSERT(pool != NULL);
+
+    st = robin_table_sharded_create(TEST_NUM_SHARDS, 0, robin_table_rapidhash,
+                                    RT_RAPID_SEED);
+    ASSERT(st != NULL);
+
+    test_alloc_batch(&batch, keys);
+
+    TEST_TIMER_START();
+    ASSERT(robin_table_sharded_put_batch_parallel(pool, st, batch.keys, batch.klens,
+                                                  batch.vals, TEST_NUM_ENTRIES,
+                                                  batch.vals_out) == true);
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_sharded_count(st) == TEST_NUM_ENTRIES);
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        ASSERT_LOOP(batch.vals_out[i] == temp_val, 1);
+        ASSERT_LOOP(robin_table_sharded_get(st, KEY_INT(&keys[i])) == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    test_free_batch(&batch);
+    robin_table_sharded_destroy(st);
+    robin_table_pool_destroy(pool);
+}
+
+static int test_cmp_u64(const void* key1, size_t klen1, const void* key2, size_t klen2)
+{
+    uint64_t a = *(const uint64_t*)key1;
+    uint64_t b = *(const uint64_t*)key2;
+
+    (void)klen1;
+    (void)klen2;
+    return (a > b) - (a < b);
+}
+
+TEST_ADD(test_pool_export_sorted, uint64_t* keys)
+{
+    robin_table_pool_t* pool;
+    robin_table_t* rt;
+    test_batch_t batch;
+    size_t n;
+
+    pool = robin_table_pool_create(TEST_NUM_THREADS);
+    ASSERT(pool != NULL);
+
+    rt = robin_table_create(TEST_NUM_ENTRIES, robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(rt != NULL);
+
+    test_alloc_batch(&batch, keys);
+
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        robin_table_put(rt, KEY_INT(&keys[i]), &keys[i]);
+    }
+
+    TEST_TIMER_START();
+    ASSERT(robin_table_export_sorted_parallel(pool, rt, batch.keys, batch.klens,
+                                              batch.vals_out, TEST_NUM_ENTRIES, test_cmp_u64,
+                                              &n) == true);
+    TEST_TIMER_END();
+
+    ASSERT(n == robin_table_count(rt));
+
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT_LOOP(batch.vals_out[i] == batch.keys[i], 1);
+        ASSERT_LOOP(batch.klens[i] == sizeof(uint64_t), 1);
+        ASSERT_LOOP(i == 0 || *(const uint64_t*)batch.keys[i - 1] <
+                              *(const uint64_t*)batch.keys[i], 1);
+    }
+    TEST_LOOP_END(1);
+
+    /* Same order as the single-threaded sort, truncated to cap */
+    ASSERT(robin_table_export_sorted(rt, (const void**)batch.vals, NULL, NULL, 10,
+                                     test_cmp_u64, &n) == true);
+    ASSERT(n == 10);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT_LOOP(batch.vals[i] == batch.keys[i], 2);
+    }
+    TEST_LOOP_END(2);
+
+    test_free_batch(&batch);
+    robin_table_destroy(rt);
+    robin_table_pool_destroy(pool);
+}
+
+TEST_MAIN(
+    uint64_t* keys;
+
+    srandom(42);
+    keys = test_alloc_keys(TEST_NUM_ENTRIES);
+
+    TEST_RUN(test_pool_get_batch, keys);
+    TEST_RUN(test_pool_sharded_put_batch, keys);
+    TEST_RUN(test_pool_export_sorted, keys);
+
+    free(keys);
+)
@@ -0,0 +1,174 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "rtest.h"
+#include "rtest_keys.h"
+#include "robin_table.h"
+
+#define TEST_NUM_ENTRIES    100000UL   /* 100K */
+#define TEST_NUM_REPLICAS   4U
+
+#define KEY_INT(k)          (k), sizeof(*(k))
+
+typedef struct {
+    robin_table_replicated_t* rr;
+    size_t replica_id;
+    uint64_t* keys;
+    size_t count;
+    size_t misses;
+    int* stop;
+} test_reader_t;
+
+static char* temp_val = "lorem";  /* Placeholder value */
+
+TEST_ADD(test_replicated_put_get_del, uint64_t* keys)
+{
+    robin_table_replicated_t* rr;
+    void* res;
+
+    rr = robin_table_replicated_create(TEST_NUM_REPLICAS, 0, robin_table_rapidhash,
+                                       RT_RAPID_SEED);
+    ASSERT(rr != NULL);
+
+    /* Far more writes than the log holds, while replica 3 never reads */
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_replicated_put(rr, i % 3, KEY_INT(&keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_replicated_get(rr, (i + 1) % 3, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    /* Duplicate keys keep the existing value */
+    ASSERT(robin_table_replicated_put(rr, 0, KEY_INT(&keys[0]), "ipsum") == temp_val);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; i += 2) {
+        res = robin_table_replicated_del(rr, i % TEST_NUM_REPLICAS, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 2);
+    }
+    TEST_LOOP_END(2);
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_replicated_del(rr, 1, KEY_INT(&keys[0])) == NULL);
+
+    for (size_t r = 0; r < TEST_NUM_REPLICAS; ++r) {
+        ASSERT(robin_table_replicated_count(rr, r) == TEST_NUM_ENTRIES / 2);
+    }
+
+    TEST_LOOP_START(3);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_replicated_get(rr, 3, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == (i % 2 ? temp_val : NULL), 3);
+    }
+    TEST_LOOP_END(3);
+
+    robin_table_replicated_destroy(rr);
+}
+
+static void* test_replicated_reader(void* arg)
+{
+    test_reader_t* reader = arg;
+
+    while (!__atomic_load_n(reader->stop, __ATOMIC_ACQUIRE)) {
+        for (size_t i = 0; i < reader->count; ++i) {
+            if (robin_table_replicated_get(reader->rr, reader->replica_id,
+                                           KEY_INT(&reader->keys[i])) != temp_val) {
+                ++reader->misses;
+            }
+        }
+    }
+    return NULL;
+}
+
+TEST_ADD(test_replicated_threads, uint64_t* keys)
+{
+    const size_t stable_count = TEST_NUM_ENTRIES / 100;
+    test_reader_t readers[TEST_NUM_REPLICAS];
+    pthread_t threads[TEST_NUM_REPLICAS];
+    robin_table_replicated_t* rr;
+    int stop = 0;
+    void* res;
+
+    rr = robin_table_replicated_create(TEST_NUM_REPLICAS, 0, robin_table_rapidhash,
+                                       RT_RAPID_SEED);
+    ASSERT(rr != NULL);
+
+    for (size_t i = 0; i < stable_count; ++i) {
+        robin_table_replicated_put(rr, 0, KEY_INT(&keys[i]), temp_val);
+    }
+
+    for (size_t r = 0; r < TEST_NUM_REPLICAS; ++r) {
+        readers[r].rr = rr;
+        readers[r].replica_id = r;
+        readers[r].keys = keys;
+        readers[r].count = stable_count;
+        readers[r].misses = 0;
+        readers[r].stop = &stop;
+        ASSERT(pthread_create(&threads[r], NULL, test_replicated_reader, &readers[r]) == 0);
+    }
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = stable_count; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_replicated_put(rr, 0, KEY_INT(&keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    for (size_t i = stable_count; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_replicated_del(rr, 0, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+    TEST_TIMER_END();
+
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+
+    for (size_t r = 0; r < TEST_NUM_REPLICAS; ++r) {
+        pthread_join(threads[r], NULL);
+        ASSERT(readers[r].misses == 0);
+        ASSERT(robin_table_replicated_count(rr, r) == stable_count);
+    }
+
+    robin_table_replicated_destroy(rr);
+}
+
+TEST_MAIN(
+    uint64_t* keys;
+
+    srandom(42);
+    keys = test_alloc_keys(TEST_NUM_ENTRIES);
+
+    TEST_RUN(test_replicated_put_get_del, keys);
+    TEST_RUN(test_replicated_threads, keys);
+
+    free(keys);
+)
@@ -0,0 +1,197 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "rtest.h"
+#include "rtest_keys.h"
+#include "robin_table.h"
+
+#define TEST_NUM_ENTRIES    1000000UL  /* 1M */
+#define TEST_NUM_SHARDS     16U
+#define TEST_NUM_THREADS    4U
+
+#define KEY_INT(k)          (k), sizeof(*(k))
+
+static char* temp_val = "lorem";  /* Placeholder value */
+
+TEST_ADD(test_sharded_put_get_del, uint64_t* keys)
+{
+    robin_table_sharded_t* st;
+    void* res;
+
+    st = robin_table_sharded_create(TEST_NUM_SHARDS, 0, robin_table_rapidhash,
+                                    RT_RAPID_SEED);
+    ASSERT(st != NULL);
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_sharded_put(st, KEY_INT(&keys[i]), temp_val);
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_sharded_get(st, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    ASSERT(robin_table_sharded_count(st) == TEST_NUM_ENTRIES);
+    ASSERT(robin_table_sharded_psl_max(st) >= robin_table_sharded_psl_mean(st));
+    ASSERT(robin_table_sharded_psl_variance(st) >= 0);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        res = robin_table_sharded_del(st, KEY_INT(&keys[i]));
+        ASSERT_LOOP(res == temp_val, 2);
+    }
+    TEST_LOOP_END(2);
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_sharded_count(st) == 0);
+    robin_table_sharded_destroy(st);
+}
+
+static void* test_sharded_worker(void* arg)
+{
+    test_worker_t* worker = arg;
+
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        if (robin_table_sharded_put(worker->table, KEY_INT(&worker->keys[i]), temp_val) !=
+            temp_val) {
+            ++worker->failed;
+        }
+    }
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        if (robin_table_sharded_get(worker->table, KEY_INT(&worker->keys[i])) != temp_val) {
+            ++worker->failed;
+        }
+    }
+    return NULL;
+}
+
+TEST_ADD(test_sharded_threads, uint64_t* keys)
+{
+    test_worker_t workers[TEST_NUM_THREADS];
+    pthread_t threads[TEST_NUM_THREADS];
+    robin_table_sharded_t* st;
+
+    st = robin_table_sharded_create(TEST_NUM_SHARDS, 0, robin_table_rapidhash,
+                                    RT_RAPID_SEED);
+    ASSERT(st != NULL);
+
+    TEST_TIMER_START();
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        workers[t].table = st;
+        workers[t].keys = keys;
+        workers[t].begin = t * (TEST_NUM_ENTRIES / TEST_NUM_THREADS);
+        workers[t].end = (t + 1) * (TEST_NUM_ENTRIES / TEST_NUM_THREADS);
+        workers[t].failed = 0;
+        ASSERT(pthread_create(&threads[t], NULL, test_sharded_worker, &workers[t]) == 0);
+    }
+    for (size_t t = 0; t < TEST_NUM_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        ASSERT(workers[t].failed == 0);
+    }
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_sharded_count(st) == TEST_NUM_ENTRIES);
+    robin_table_sharded_destroy(st);
+}
+
+TEST_ADD(test_sharded_batch, uint64_t* keys)
+{
+    robin_table_sharded_t* st;
+    const void** batch_keys;
+    size_t* batch_klens;
+    void** batch_vals;
+    void** vals_out;
+
+    st = robin_table_sharded_create(TEST_NUM_SHARDS, TEST_NUM_ENTRIES,
+                                    robin_table_rapidhash, RT_RAPID_SEED);
+    ASSERT(st != NULL);
+
+    batch_keys = malloc(TEST_NUM_ENTRIES * sizeof(*batch_keys));
+    batch_klens = malloc(TEST_NUM_ENTRIES * sizeof(*batch_klens));
+    batch_vals = malloc(TEST_NUM_ENTRIES * sizeof(*batch_vals));
+    vals_out = malloc(TEST_NUM_ENTRIES * sizeof(*vals_out));
+    if (!batch_keys || !batch_klens || !batch_vals || !vals_out) {
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        batch_keys[i] = &keys[i];
+        batch_klens[i] = sizeof(keys[i]);
+        batch_vals[i] = temp_val;
+    }
+
+    TEST_TIMER_START();
+    ASSERT(robin_table_sharded_put_batch(st, batch_keys, batch_klens, batch_vals,
+                                         TEST_NUM_ENTRIES, vals_out) == true);
+    ASSERT(robin_table_sharded_count(st) == TEST_NUM_ENTRIES);
+
+    ASSERT(robin_table_sharded_get_batch(st, batch_keys, batch_klens, TEST_NUM_ENTRIES,
+                                         vals_out) == true);
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        ASSERT_LOOP(vals_out[i] == temp_val, 1);
+    }
+    TEST_LOOP_END(1);
+
+    /* Remove the first half */
+    ASSERT(robin_table_sharded_del_batch(st, batch_keys, batch_klens, TEST_NUM_ENTRIES / 2,
+                                         vals_out) == true);
+    TEST_TIMER_END();
+
+    ASSERT(robin_table_sharded_count(st) == TEST_NUM_ENTRIES / 2);
+
+    ASSERT(robin_table_sharded_get_batch(st, batch_keys, batch_klens, TEST_NUM_ENTRIES,
+                                         vals_out) == true);
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        ASSERT_LOOP(vals_out[i] == (i < TEST_NUM_ENTRIES / 2 ? NULL : temp_val), 2);
+    }
+    TEST_LOOP_END(2);
+
+    free(batch_keys);
+    free(batch_klens);
+    free(batch_vals);
+    free(vals_out);
+    robin_table_sharded_destroy(st);
+}
+
+TEST_MAIN(
+    uint64_t* keys;
+
+    srandom(42);
+    keys = test_alloc_keys(TEST_NUM_ENTRIES);
+
+    TEST_RUN(test_sharded_put_get_del, keys);
+    TEST_RUN(test_sharded_threads, keys);
+    TEST_RUN(test_sharded_batch, keys);
+
+    free(keys);
+)
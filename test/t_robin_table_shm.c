@@ -0,0 +1,291 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Didarul Islam <didarulislam85@hotmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "rtest.h"
+#include "robin_table.h"
+
+#define TEST_NUM_ENTRIES    100000UL   /* 100K */
+
+#define KEY_INT(k)          (k), sizeof(*(k))
+
+/* Layout of the shared region, to damage it on purpose */
+#define TEST_SHM_HEADER_SIZE     88U
+#define TEST_SHM_BUCKET_COUNT    32U   /* Offset of the bucket count */
+#define TEST_SHM_BUCKET_SIZE     24U
+#define TEST_SHM_BUCKET_OFF      8U    /* Offset of the data offset in a bucket */
+
+typedef struct {
+    robin_table_shm_t* sh;
+    uint64_t* keys;
+    size_t count;
+    size_t misses;
+    int* stop;
+} test_reader_t;
+
+static uint64_t* test_alloc_keys(void)
+{
+    uint64_t* keys;
+
+    keys = malloc(TEST_NUM_ENTRIES * sizeof(*keys));
+    if (!keys) {
+        exit(EXIT_FAILURE);
+    }
+
+    /* Distinct keys */
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        keys[i] = ((uint64_t)(random() & 0xFFFF) << 32) | i;
+    }
+    return keys;
+}
+
+/*
+ * Count the keys whose value is not their index, or that are missing.
+ */
+static size_t test_shm_check(const robin_table_shm_t* sh, uint64_t* keys, size_t count)
+{
+    size_t errors = 0;
+    const void* res;
+    uint64_t val;
+    size_t vlen;
+
+    for (size_t i = 0; i < count; ++i) {
+        res = robin_table_shm_get(sh, KEY_INT(&keys[i]), &vlen);
+        if (!res || vlen != sizeof(val)) {
+            errors++;
+            continue;
+        }
+        memcpy(&val, res, sizeof(val));
+        errors += (val != i);
+    }
+    return errors;
+}
+
+TEST_ADD(test_shm_put_get_del, uint64_t* keys)
+{
+    robin_table_shm_t* sh;
+    robin_table_shm_t* reader;
+    char name[64];
+    uint64_t val;
+    pid_t pid;
+    int status;
+
+    snprintf(name, sizeof(name), "/t_robin_table_shm.%ld", (long)getpid());
+    sh = robin_table_shm_create(name, TEST_NUM_ENTRIES, TEST_NUM_ENTRIES * 16,
+                                RT_HASH_RAPIDHASH, RT_RAPID_SEED);
+    ASSERT(sh != NULL);
+
+    /* The name is taken */
+    ASSERT(robin_table_shm_create(name, 1, 16, RT_HASH_RAPIDHASH, RT_RAPID_SEED) == NULL);
+
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        val = i;
+        ASSERT_LOOP(robin_table_shm_put(sh, KEY_INT(&keys[i]), &val, sizeof(val)) != NULL, 1);
+    }
+    TEST_LOOP_END(1);
+    TEST_TIMER_END();
+
+    /* The data area is full */
+    val = 0;
+    ASSERT(robin_table_shm_put(sh, KEY_INT(&val), &val, sizeof(val)) == NULL);
+    ASSERT(robin_table_shm_count(sh) == TEST_NUM_ENTRIES);
+    ASSERT(test_shm_check(sh, keys, TEST_NUM_ENTRIES) == 0);
+
+    /* Another process reads the same memory */
+    pid = fork();
+    ASSERT(pid >= 0);
+    if (pid == 0) {
+        reader = robin_table_shm_attach(name);
+        _exit(reader && robin_table_shm_count(reader) == TEST_NUM_ENTRIES &&
+                      test_shm_check(reader, keys, TEST_NUM_ENTRIES) == 0 ? 0 : 1);
+    }
+    ASSERT(waitpid(pid, &status, 0) == pid);
+    ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    reader = robin_table_shm_attach(name);
+    ASSERT(reader != NULL);
+
+    TEST_LOOP_START(2);
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; i += 2) {
+        ASSERT_LOOP(robin_table_shm_del(sh, KEY_INT(&keys[i])), 2);
+    }
+    for (size_t i = 0; i < TEST_NUM_ENTRIES; ++i) {
+        ASSERT_LOOP((robin_table_shm_get(reader, KEY_INT(&keys[i]), NULL) != NULL) == (i % 2),
+                    2);
+    }
+    TEST_LOOP_END(2);
+
+    ASSERT(!robin_table_shm_del(sh, KEY_INT(&keys[0])));
+    ASSERT(robin_table_shm_count(reader) == TEST_NUM_ENTRIES / 2);
+
+    robin_table_shm_detach(reader);
+    robin_table_shm_detach(sh);
+    ASSERT(robin_table_shm_unlink(name));
+    ASSERT(robin_table_shm_attach(name) == NULL);
+}
+
+static void* test_shm_reader(void* arg)
+{
+    test_reader_t* reader = arg;
+
+    while (!__atomic_load_n(reader->stop, __ATOMIC_ACQUIRE)) {
+        reader->misses += test_shm_check(reader->sh, reader->keys, reader->count);
+    }
+    return NULL;
+}
+
+TEST_ADD(test_shm_threads, uint64_t* keys)
+{
+    const size_t stable_count = TEST_NUM_ENTRIES / 100;
+    robin_table_shm_t* sh;
+    test_reader_t reader;
+    pthread_t thread;
+    char name[64];
+    uint64_t val;
+    int stop = 0;
+
+    snprintf(name, sizeof(name), "/t_robin_table_shm.%ld", (long)getpid());
+    sh = robin_table_shm_create(name, TEST_NUM_ENTRIES, TEST_NUM_ENTRIES * 16,
+                                RT_HASH_XXH64, 0);
+    ASSERT(sh != NULL);
+
+    for (size_t i = 0; i < stable_count; ++i) {
+        val = i;
+        robin_table_shm_put(sh, KEY_INT(&keys[i]), &val, sizeof(val));
+    }
+
+    reader.sh = robin_table_shm_attach(name);
+    reader.keys = keys;
+    reader.count = stable_count;
+    reader.misses = 0;
+    reader.stop = &stop;
+    ASSERT(reader.sh != NULL);
+    ASSERT(pthread_create(&thread, NULL, test_shm_reader, &reader) == 0);
+
+    /* Entries come and go around the ones the reader looks up */
+    TEST_TIMER_START();
+    TEST_LOOP_START(1);
+    for (size_t i = stable_count; i < TEST_NUM_ENTRIES; ++i) {
+        val = i;
+        ASSERT_LOOP(robin_table_shm_put(sh, KEY_INT(&keys[i]), &val, sizeof(val)) != NULL, 1);
+    }
+    for (size_t i = stable_count; i < TEST_NUM_ENTRIES; ++i) {
+        ASSERT_LOOP(robin_table_shm_del(sh, KEY_INT(&keys[i])), 1);
+    }
+    TEST_LOOP_END(1);
+    TEST_TIMER_END();
+
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+    ASSERT(reader.misses == 0);
+    ASSERT(robin_table_shm_count(sh) == stable_count);
+
+    robin_table_shm_detach(reader.sh);
+    robin_table_shm_detach(sh);
+    ASSERT(robin_table_shm_unlink(name));
+}
+
+TEST_ADD(test_shm_corrupt, uint64_t* keys)
+{
+    robin_table_shm_t* sh;
+    robin_table_shm_t* reader;
+    char name[64];
+    uint64_t val = 1;
+    uint64_t saved, bucket_count;
+    uint8_t* base;
+    uint8_t* bucket = NULL;
+    struct stat st;
+    int fd;
+
+    snprintf(name, sizeof(name), "/t_robin_table_shm.%ld", (long)getpid());
+    sh = robin_table_shm_create(name, 1, 16, RT_HASH_RAPIDHASH, RT_RAPID_SEED);
+    ASSERT(sh != NULL);
+    ASSERT(robin_table_shm_put(sh, KEY_INT(&keys[0]), &val, sizeof(val)) != NULL);
+
+    fd = shm_open(name, O_RDWR, 0);
+    ASSERT(fd >= 0);
+    ASSERT(fstat(fd, &st) == 0);
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT(base != MAP_FAILED);
+
+    /* A bucket array that is not a power of two or overlaps the data area */
+    memcpy(&saved, base + TEST_SHM_BUCKET_COUNT, sizeof(saved));
+    bucket_count = saved + 1;
+    memcpy(base + TEST_SHM_BUCKET_COUNT, &bucket_count, sizeof(bucket_count));
+    ASSERT(robin_table_shm_attach(name) == NULL);
+    bucket_count = saved << 8;
+    memcpy(base + TEST_SHM_BUCKET_COUNT, &bucket_count, sizeof(bucket_count));
+    ASSERT(robin_table_shm_attach(name) == NULL);
+    memcpy(base + TEST_SHM_BUCKET_COUNT, &saved, sizeof(saved));
+
+    reader = robin_table_shm_attach(name);
+    ASSERT(reader != NULL);
+    ASSERT(robin_table_shm_get(reader, KEY_INT(&keys[0]), NULL) != NULL);
+
+    /* A bucket pointing past the region is never dereferenced */
+    for (size_t i = 0; i < saved; ++i) {
+        uint8_t* b = base + TEST_SHM_HEADER_SIZE + i * TEST_SHM_BUCKET_SIZE;
+
+        memcpy(&val, b + TEST_SHM_BUCKET_OFF, sizeof(val));
+        if (val) {
+            bucket = b;
+        }
+    }
+    ASSERT(bucket != NULL);
+    val = (uint64_t)st.st_size - 4;
+    memcpy(bucket + TEST_SHM_BUCKET_OFF, &val, sizeof(val));
+    ASSERT(robin_table_shm_get(reader, KEY_INT(&keys[0]), NULL) == NULL);
+
+    munmap(base, (size_t)st.st_size);
+    robin_table_shm_detach(reader);
+    robin_table_shm_detach(sh);
+    ASSERT(robin_table_shm_unlink(name));
+}
+
+TEST_MAIN(
+    uint64_t* keys;
+
+    srandom(42);
+    keys = test_alloc_keys();
+
+    TEST_RUN(test_shm_put_get_del, keys);
+    TEST_RUN(test_shm_threads, keys);
+    TEST_RUN(test_shm_corrupt, keys);
+
+    free(keys);
+)